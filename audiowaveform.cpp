@@ -1,4 +1,9 @@
 #include "audiowaveform.h"
+#include "profiling/profiler.h"
+#include "mediaplayer/utilities/boundaryplottable.h"
+#include "mediaplayer/utilities/peakcache.h"
+#include "mediaplayer/utilities/spectrogramplottable.h"
+#include "mediaplayer/utilities/waveformplottable.h"
 #include "libavformat/avformat.h"
 #include "ui_audiowaveform.h"
 #include <QBoxLayout>
@@ -7,14 +12,19 @@
 #include <QToolButton>
 #include <QComboBox>
 #include <QAudio>
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
 
 
 //---------------------------- ---
-#define AUDIBLE_RANGE_START 20
-#define AUDIBLE_RANGE_END   20000
 constexpr int BUFFER_SIZE = 1024;
 constexpr qint64 MS_PER_SECOND = 1000;
+constexpr int peakDrainRate = 30;           // replots per second while decoding
+constexpr size_t peakQueueCapacity = 256;   // decoded chunks in flight
+constexpr int boundaryUpdateRate = 60;      // editor updates per second while dragging a boundary
 //----------------------------
 
 AudioWaveForm::AudioWaveForm(QWidget *parent)
@@ -30,17 +40,22 @@ AudioWaveForm::AudioWaveForm(QWidget *parent)
     //horizontalScrollBar = new QScrollBar(Qt::Horizontal, this);
     //connect(horizontalScrollBar, &QScrollBar::valueChanged, this, &AudioWaveForm::onScrollBarValueChanged);
     // waveWidget->clearGraphs();
-    waveWidget->addGraph();
+    mWaveform = new WaveformPlottable(waveWidget->xAxis, waveWidget->yAxis);
+    mWaveform->setPeaks(&mPeaks);
     waveWidget->yAxis->setRange(-1.0, 1.0);
     waveWidget->xAxis->setRange(0, 8);
 
     waveWidget->yAxis->setVisible(false);
     waveWidget->xAxis->setVisible(true);
 
-    waveWidget->graph()->setPen(QPen(Qt::blue));
+    mWaveform->setPen(QPen(Qt::blue));
+    mWaveform->setRmsPen(QPen(QColor(0, 0, 128)));
+
+    mLaneMargins = new QCPMarginGroup(waveWidget);
+    waveWidget->axisRect()->setMarginGroup(QCP::msLeft | QCP::msRight, mLaneMargins);
 
     waveWidget->setVisible(false);
-    waveWidget->graph()->setVisible(true);
+    mWaveform->setVisible(true);
     waveWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     // waveWidget->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Minimum);
     waveWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -54,6 +69,36 @@ AudioWaveForm::AudioWaveForm(QWidget *parent)
 
     // setLayout(layout2);
 
+    waveWidget->addLayer("cursor", waveWidget->layer("main"), QCustomPlot::limAbove);
+    mCursorLayer = waveWidget->layer("cursor");
+    mCursorLayer->setMode(QCPLayer::lmBuffered);
+
+    mHoverLine = new QCPItemLine(waveWidget);
+    mHoverLine->setLayer(mCursorLayer);
+    mHoverLine->setPen(QPen(Qt::gray, 1, Qt::DashLine));
+    mHoverLine->setSelectable(false);
+    mHoverLine->setVisible(false);
+    waveWidget->installEventFilter(this);
+
+    QFont labelFont;
+    labelFont.setFamily(font().family());
+    labelFont.setPointSize(13);
+    labelFont.setBold(true);
+    labelFont.setWeight(QFont::Black);
+
+    mBoundaries = new BoundaryPlottable(waveWidget->xAxis, waveWidget->yAxis);
+    mBoundaries->setPen(QPen(Qt::red));
+    mBoundaries->setAddedPen(QPen(QColor(255, 255, 0)));
+    mBoundaries->setLabelFont(labelFont);
+    mBoundaries->setLabelColor(Qt::red);
+
+    mBoundaryPreview = new BoundaryPlottable(waveWidget->xAxis, waveWidget->yAxis);
+    mBoundaryPreview->setPreviewOf(mBoundaries);
+    mBoundaryPreview->setLayer(mCursorLayer);
+    mBoundaryPreview->setDraggedPen(QPen(Qt::blue, 2));
+    mBoundaryPreview->setLabelFont(labelFont);
+    mBoundaryPreview->setLabelColor(Qt::red);
+
     waveWidget->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom |/* QCP::iSelectPlottables |*/ QCP::iSelectItems | QCP::iRangeZoom);
     connect(waveWidget, SIGNAL(mousePress(QMouseEvent*)), this, SLOT(onMousePress(QMouseEvent*)));
 
@@ -62,9 +107,22 @@ AudioWaveForm::AudioWaveForm(QWidget *parent)
 
     waveWidget->setVisible(true);
     ui->textEdit->setText("");
+
+    // Replots while decoding are throttled to the drain rate
+    mDrainTimer = new QTimer(this);
+    mDrainTimer->setInterval(1000 / peakDrainRate);
+    connect(mDrainTimer, &QTimer::timeout, this, [this]() {
+        if (drainPeaks())
+            waveWidget->replot();
+    });
+
+    // A dragged boundary reaches the editor at most once a frame, see moveBoundary()
+    mBoundaryTimer = new QTimer(this);
+    mBoundaryTimer->setSingleShot(true);
+    mBoundaryTimer->setInterval(1000 / boundaryUpdateRate);
+    connect(mBoundaryTimer, &QTimer::timeout, this, &AudioWaveForm::flushBoundaryUpdate);
     // ui->addBtn->setDisabled(true);
 
-    mPlayer = new QMediaPlayer(this);
     connect(waveWidget, &QCustomPlot::mousePress, this, [this](QMouseEvent *event) {
         if (event->modifiers() == Qt::ControlModifier) {
             // Ctrl key is pressed
@@ -73,167 +131,182 @@ AudioWaveForm::AudioWaveForm(QWidget *parent)
             emit positionChanged(currentMouseX);
         }
     });
-    connect(mPlayer, &QMediaPlayer::durationChanged, [this]() {
-        emit samplingStatus(false);
-        qint64 tot_duration = mPlayer->duration();
-        // qInfo()<<"size of buffer is: "<< mAudioBuffer.size(); // Disabled debug
-        AVFormatContext* formatCtx = avformat_alloc_context();
-        sample_rate = 0;
-        total_duration = 0;
-        waveWidget->graph(0)->data()->clear();
-        waveWidget->replot();
-        if ( avformat_open_input(&formatCtx,
-                                strdup(mMediaFileName.toStdString().c_str()),
-                                nullptr, nullptr) == 0)
-        {
-            if (avformat_find_stream_info(formatCtx, nullptr) >= 0) {
-                int audioStreamIndex = -1;
-                for (unsigned int i = 0; i < formatCtx->nb_streams; ++i) {
-                    if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-                        audioStreamIndex = i;
-                        break;
-                    }
-                }
-                if (audioStreamIndex != -1) {
-                    sample_rate = formatCtx->streams[audioStreamIndex]->codecpar->sample_rate;
-                } else {
-                    qWarning() << "No audio stream found.";
-                    avformat_close_input(&formatCtx);
-                    return;
-                }
-            } else {
-                qWarning() << "Failed to find stream information.";
-                avformat_close_input(&formatCtx);
-                return;
-            }
-
-            avformat_close_input(&formatCtx);
-        }
-        total_duration = mPlayer->duration();
-        if(sample_rate) {
-            processSampleRate();
-        }
-    });
 }
 
 AudioWaveForm::~AudioWaveForm()
 {
+    // The decoder posts its chunks to this widget
+    cancelDecode();
     delete ui;
-    fftw_free(mFftIn);
-    fftw_free(mFftOut);
-    fftw_destroy_plan(mFftPlan);
 }
 
 void AudioWaveForm::showWaveForm() {
+    PROFILE_SCOPE("AudioWaveForm::showWaveForm");
 
-    QFile MediaFile(mUrl.toLocalFile());
-    QByteArray audioData;
-    QString filePath = mUrl.toLocalFile();
-    QFileInfo filedir(MediaFile);
-    QString dirInString=filedir.dir().path();
-    QString slash = "/";
-    mMediaFileName = dirInString + slash + mUrl.fileName();
-
-    if(!MediaFile.open(QIODevice::ReadOnly))
-    {
-        // qInfo()<<"Not open for readonly\n";
+    mMediaFileName = mUrl.toLocalFile();
+    if (mMediaFileName.isEmpty())
         return;
-    }
-    if(isAudioFile(filePath)){
-        // qInfo()<<"File id audio file\n";
-        audioData = MediaFile.readAll();
-    } else {
-        // qInfo()<<"File is video file\n";
-        QString ffmpegPath = "ffmpeg";
-        QProcess ffmpegProcess;
-        QStringList ffmpegArgs = {"-i", filePath, "-vn", "-f", "wav", "-"};
-        ffmpegProcess.start(ffmpegPath, ffmpegArgs);
-        if (ffmpegProcess.waitForStarted() && ffmpegProcess.waitForFinished()) {
-            audioData += ffmpegProcess.readAllStandardOutput();
-        } else {
-            qWarning() << "FFmpeg process failed:" << ffmpegProcess.errorString();
 
+    cancelDecode();
+    emit samplingStatus(false);
+    mPeaks.reset(0);
+    updateSpectrogramSource();
+    waveWidget->replot();
+
+    // Files seen before come straight from the peak cache. Anything else libav knows,
+    // audio or video, is decoded in process on the thread pool, summarised into peak
+    // bins there and handed over through mPeakQueue, see drainPeaks()
+    int generation = ++mDecodeGeneration;
+    auto queue = std::make_shared<PeakQueue>(peakQueueCapacity);
+    mPeakQueue = queue;
+    mDecode = QtConcurrent::run([this, generation, queue, fileName = mMediaFileName](QPromise<void>& promise) {
+        PROFILE_SCOPE("AudioWaveForm decode");
+
+        auto cacheKey = PeakCache::fingerprint(fileName);
+        PeakPyramid cached;
+        AudioDecoder::Info cachedInfo;
+        if (PeakCache::load(cacheKey, cached, cachedInfo)) {
+            QMetaObject::invokeMethod(this, [this, generation, cached, cachedInfo]() {
+                peaksLoaded(generation, cached, cachedInfo);
+            }, Qt::QueuedConnection);
             return;
         }
-    }
-
-    // mAudioBuffer.open(QIODevice::ReadWrite | QIODevice::Truncate);
-    // mAudioBuffer.buffer().clear();
-    // mAudioBuffer.seek(0);
-    // mAudioBuffer.write(audioData);
-    // mAudioBuffer.close();
 
-    mInputBuffer.open(QIODevice::ReadWrite | QIODevice::Truncate);
-    mInputBuffer.buffer().clear();
-    mInputBuffer.seek(0);
-    mInputBuffer.write(audioData);
-    mInputBuffer.close();
+        AudioDecoder decoder(fileName);
+        bool ok = decoder.open();
+        if (ok) {
+            QMetaObject::invokeMethod(this, [this, generation, info = decoder.info(), cacheKey]() {
+                decodeStarted(generation, info, cacheKey);
+            }, Qt::QueuedConnection);
+
+            static_assert(AudioDecoder::defaultChunkSamples % PeakPyramid::binSamples == 0,
+                          "decoded chunks have to split into whole peak bins");
+            ok = decoder.decode([&](const float* samples, int count) {
+                PeakChunk chunk;
+                chunk.bins.resize(PeakPyramid::binsFor(count));
+                PeakPyramid::summarize(samples, count, chunk.bins.data());
+                chunk.samples = count;
+
+                // The GUI drains at the replot rate, wait for room rather than buffer without bound
+                while (!queue->tryPush(std::move(chunk))) {
+                    if (promise.isCanceled())
+                        return false;
+                    QThread::msleep(2);
+                }
+                return !promise.isCanceled();
+            });
+        }
+        if (promise.isCanceled())
+            return;
 
-    mPlayer->setSource(mUrl);
+        QMetaObject::invokeMethod(this, [this, generation, ok, error = decoder.errorString()]() {
+            decodeFinished(generation, ok, error);
+        }, Qt::QueuedConnection);
+    });
 }
 
-void AudioWaveForm::processSampleRate()
+void AudioWaveForm::cancelDecode()
 {
+    mDecodeGeneration++;
+    mDrainTimer->stop();
+    mDecode.cancel();
+    mDecode.waitForFinished();
+    mPeakQueue.reset();
+}
 
-    if (mInputBuffer.size() <= 0)
+void AudioWaveForm::decodeStarted(int generation, const AudioDecoder::Info& info, const QString& cacheKey)
+{
+    if (generation != mDecodeGeneration)
         return;
 
-    waveWidget->graph(0)->data()->clear();
+    sample_rate = info.sampleRate;
+    mDecodeInfo = info;
+    mPeakCacheKey = cacheKey;
+    mPeaks.reset(info.sampleRate);
+    updateSpectrogramSource();
+
+    // The waveform fills in from the left as bins arrive, the player can be used right away
+    waveWidget->xAxis->setRange(0, info.durationMs > 0 ? info.durationMs / double(MS_PER_SECOND) : 8);
+    waveWidget->setVisible(true);
+    setPlayerPosition(0);
     waveWidget->replot();
-    mSamples.clear();
-    mIndices.clear();
-
-    // this->sample_rate = sampleRate;
-    // this->total_duration = totalDuration;
-    this->num_sam = sample_rate * (total_duration/1000);
-    // factor = num_sam / NUM_SAMPLES;
-    // qInfo()<<"sample_rate is: :"<<this->sample_rate<<"\n";
-    //qInfo()<<"total duration is: "<<total_dur<<"\n";
-    //qInfo()<<"num samples is: "<<num_sam<<"\n";
-
-
-    // mInputBuffer.
-    // mInputBuffer.open(QIODevice::ReadWrite);
-    // -- temp --
-    // mInputBuffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
-    // mInputBuffer.buffer().clear();
-    // mInputBuffer.seek(0);
-    // mAudioBuffer.open(QIODevice::ReadOnly);
-
-    // while (!mAudioBuffer.atEnd()) {
-    //     QByteArray chunk = mAudioBuffer.read(1024); // Read 1024 bytes at a time
-    //     mInputBuffer.write(chunk);
-    // }
-    // mInputBuffer.close();
-    // mAudioBuffer.close();
-
-    processBuffer();
+    emit samplingStatus(true);
+    mDrainTimer->start();
 }
-void AudioWaveForm::processBuffer()
+
+void AudioWaveForm::peaksLoaded(int generation, const PeakPyramid& peaks, const AudioDecoder::Info& info)
 {
-    mIndices.reserve(num_sam);
-    mSamples.reserve(num_sam);
-    mFftIndices.reserve(AUDIBLE_RANGE_END - AUDIBLE_RANGE_START);
+    if (generation != mDecodeGeneration)
+        return;
 
-    for (qint64 i = 0; i < num_sam; i++) {
-        mIndices.append(static_cast<double>(i));
-        mSamples.append(0.0);
-    }
+    mPeaks = peaks;
+    mDecodeInfo = info;
+    sample_rate = info.sampleRate;
+    num_sam = mPeaks.sampleCount();
+    total_duration = num_sam * MS_PER_SECOND / sample_rate;
+    updateSpectrogramSource();
+
+    samplesUpdated();
+}
 
-    double freqStep = static_cast<double>(sample_rate) / num_sam;
-    double f = AUDIBLE_RANGE_START;
-    for (double f = AUDIBLE_RANGE_START; f < AUDIBLE_RANGE_END; f += freqStep) {
-        mFftIndices.append(f);
+void AudioWaveForm::setSpectrogramVisible(bool visible)
+{
+    if (visible == (mSpectrogram != nullptr))
+        return;
+
+    auto layout = waveWidget->plotLayout();
+    if (visible) {
+        // A second axis rect under the waveform that follows its time axis
+        mSpectrogramRect = new QCPAxisRect(waveWidget);
+        mSpectrogramRect->setRangeDrag(Qt::Orientations());
+        mSpectrogramRect->setRangeZoom(Qt::Orientations());
+        mSpectrogramRect->setMarginGroup(QCP::msLeft | QCP::msRight, mLaneMargins);
+        auto keyAxis = mSpectrogramRect->axis(QCPAxis::atBottom);
+        auto valueAxis = mSpectrogramRect->axis(QCPAxis::atLeft);
+        keyAxis->setTickLabels(false);
+        keyAxis->setRange(waveWidget->xAxis->range());
+        valueAxis->setVisible(false);
+        valueAxis->setRange(0, 1);
+        connect(waveWidget->xAxis, qOverload<const QCPRange&>(&QCPAxis::rangeChanged),
+                keyAxis, qOverload<const QCPRange&>(&QCPAxis::setRange));
+
+        layout->addElement(1, 0, mSpectrogramRect);
+        layout->setRowStretchFactor(1, 0.6);
+
+        mSpectrogram = new SpectrogramPlottable(keyAxis, valueAxis);
+        mSpectrogram->setFrameSize(mSpectrogramFrameSize);
+        updateSpectrogramSource();
+    }
+    else {
+        waveWidget->removePlottable(mSpectrogram);
+        layout->remove(mSpectrogramRect);
+        layout->simplify();
+        mSpectrogram = nullptr;
+        mSpectrogramRect = nullptr;
     }
+    waveWidget->replot();
+}
 
-    // Set up FFT plan *
-    mFftIn  = fftw_alloc_real(num_sam);
-    mFftOut = fftw_alloc_real(num_sam);
-    mFftPlan = fftw_plan_r2r_1d(num_sam, mFftIn, mFftOut, FFTW_R2HC,FFTW_ESTIMATE);
+void AudioWaveForm::setSpectrogramFrameSize(int frameSize)
+{
+    mSpectrogramFrameSize = frameSize;
+    if (!mSpectrogram)
+        return;
+    mSpectrogram->setFrameSize(frameSize);
+    waveWidget->replot();
+}
 
-    waveWidget->setVisible(true);
+void AudioWaveForm::updateSpectrogramSource()
+{
+    if (!mSpectrogram)
+        return;
 
-    processAudioIn();
+    // The duration grows with the decode until the pyramid is complete
+    const int rate = mPeaks.sampleRate();
+    double duration = 0;
+    if (rate > 0)
+        duration = qMax(mPeaks.duration(), mDecodeInfo.durationMs / double(MS_PER_SECOND));
+    mSpectrogram->setSource(rate > 0 ? mMediaFileName : QString(), rate, duration);
 }
 
 void AudioWaveForm::setPlayerPosition(qint64 position)
@@ -242,195 +315,124 @@ void AudioWaveForm::setPlayerPosition(qint64 position)
     double currentTimeSec = position / 1000.0;
     if (playLine)
     {
+        // The player reports far more often than the playhead moves a pixel
+        auto pixel = [this](double seconds) { return qRound(waveWidget->xAxis->coordToPixel(seconds)); };
+        if (pixel(playLine->start->coords().x()) == pixel(currentTimeSec))
+            return;
         playLine->start->setCoords(currentTimeSec, -1);
         playLine->end->setCoords(currentTimeSec, 1);
     }
     else
     {
         playLine = std::make_unique<QCPItemLine>(waveWidget);
+        playLine->setLayer(mCursorLayer);
         playLine->start->setCoords(currentTimeSec, -1);
         playLine->end->setCoords(currentTimeSec, 1);
         playLine->setPen(QPen(Qt::black));
     }
-    waveWidget->replot();
+    mCursorLayer->replot();
 }
 
-void AudioWaveForm::processAudioIn()
+void AudioWaveForm::setHoverPosition(double seconds)
 {
-    //qInfo()<<"processing audio\n";
-    mInputBuffer.open(QIODevice::ReadWrite);
-    mInputBuffer.seek(0);
-    QByteArray audioData = mInputBuffer.readAll();
-    mInputBuffer.buffer().clear();
-    mInputBuffer.seek(0);
-    mInputBuffer.close();
-
-    int16_t maxSample = 0;
-    const int16_t* samples = reinterpret_cast<const int16_t*>(audioData.constData());
-    const int sampleCount = audioData.size() / sizeof(int16_t);
-
-    for (int i = 0; i < sampleCount; ++i) {
-        maxSample = qMax(maxSample, qAbs(samples[i]));
-    }
-
-    int b_pos = 0;
-    for (int i = 0; i < sampleCount; ++i) {
-        maxSample = qMax(maxSample, qAbs(samples[i]));
+    if (seconds < 0) {
+        if (!mHoverLine->visible())
+            return;
+        mHoverLine->setVisible(false);
     }
-
-    const double normFactor = maxSample != 0 ? 1.0 / maxSample : 1.0;
-    mSamples.clear();
-    mSamples.reserve(sampleCount);
-
-    for (int i = 0; i < sampleCount; ++i) {
-        mSamples.append(samples[i] * normFactor);
+    else {
+        mHoverLine->start->setCoords(seconds, -1);
+        mHoverLine->end->setCoords(seconds, 1);
+        mHoverLine->setVisible(true);
     }
-
-    // mInputBuffer.buffer().clear();
-    // mInputBuffer.seek(0);
-    // mInputBuffer.close();
-    samplesUpdated();
+    mCursorLayer->replot();
 }
 
-void AudioWaveForm::getTimeArray(QVector<QTime> timeArray)
+bool AudioWaveForm::eventFilter(QObject *watched, QEvent *event)
 {
-
-    //qInfo()<<"getting time array\n";
-    endTime = timeArray;
-    int totalSeconds;
-    blocktime.clear();
-    for(int i = 0; i < endTime.size(); ++i)
-    {
-        totalSeconds = endTime[i].second() + endTime[i].minute() * 60 + endTime[i].hour() * 3600;
-        blocktime.append(totalSeconds);
-    }
-    num_of_blocks = endTime.size();
-    plotLines(1);
-
-
+    if (watched == waveWidget && event->type() == QEvent::Leave)
+        setHoverPosition(-1);
+    return QWidget::eventFilter(watched, event);
 }
-void AudioWaveForm::plotLines(int n)
-{
 
-    if(!endLine.isEmpty())
-    {
-        for(int i = 0; i < endLine.size(); ++i)
-        {
-            waveWidget->removeItem(endLine[i]);
-        }
-        endLine.clear();
-        waveWidget->replot();
-    }
+bool AudioWaveForm::drainPeaks()
+{
+    PROFILE_SCOPE("AudioWaveForm::drainPeaks");
 
+    // Bins that arrive before decodeStarted() belong to a pyramid without a sample rate yet
+    if (!mPeakQueue || mPeaks.sampleRate() == 0)
+        return false;
 
-    //qInfo()<<"plotting lines\n";
+    bool drained = false;
+    PeakChunk chunk;
+    while (mPeakQueue->tryPop(chunk)) {
+        mPeaks.appendBins(chunk.bins.constData(), chunk.bins.size(), chunk.samples);
+        drained = true;
+    }
+    return drained;
+}
 
-    endLine.clear();
-    waveWidget->replot();
-    waveWidget->update();
-    endCoords.clear();
-    for(int i = 0; i < num_of_blocks; ++i)
-    {
+void AudioWaveForm::decodeFinished(int generation, bool ok, const QString& error)
+{
+    if (generation != mDecodeGeneration)
+        return;
 
-        QCPItemLine* newendline = new QCPItemLine(waveWidget);
+    if (!ok)
+        qWarning() << "Couldn't decode" << mMediaFileName << error;
 
-        endLine.append(newendline);
+    mDrainTimer->stop();
+    drainPeaks();
+    mPeakQueue.reset();
+    mPeaks.finish();
+    if (mPeaks.sampleCount() == 0 || sample_rate <= 0) {
+        emit samplingStatus(false);
+        return;
+    }
 
-        // start line selectable
-        // if(i == 0){
-        //     startLine[0]->setSelectable(false);
-        // }
-        double x = blocktime[i];
-        endLine[i]->start->setCoords(x, -1);
-        endLine[i]->end->setCoords(x, 1);
-        endLine[i]->setPen(QPen(Qt::red));
-        endCoords.append(x);
+    num_sam = mPeaks.sampleCount();
+    total_duration = num_sam * MS_PER_SECOND / sample_rate;
+    updateSpectrogramSource();
 
+    // Only complete pyramids are worth keeping
+    if (ok) {
+        QtConcurrent::run([key = mPeakCacheKey, peaks = mPeaks, info = mDecodeInfo]() {
+            PeakCache::save(key, peaks, info);
+        });
     }
 
-
-    //if(itemsAvailable != 1){
-    // startCoords.clear();
-    // endCoords.clear();
-    //}
-    // int sc = 0;
-    // for(int i = 0; i < num_of_blocks; ++i)
-    // {
-    //     // double startCoordinate = sc;
-    //     double endCoordinate = endLine[i]->start->coords().x();
-    //     // startCoords.append(startCoordinate);
-    //     endCoords.append(endCoordinate);
-    //     // sc = endLine[i]->start->coords().x();
-    // }
+    if (mDecodeInfo.durationMs <= 0)
+        waveWidget->xAxis->rescale();
     waveWidget->replot();
-    if(n == 1)
-        setUtteranceNumber(1);
-    else
-        setUtteranceNumber(2);
-    //samplesUpdated();
-
 }
 
-void AudioWaveForm::setUtteranceNumber(int n)
+void AudioWaveForm::getTimeArray(QVector<QTime> timeArray)
 {
-    if(!utteranceNumbers.isEmpty())
-    {
-        for(int i = 0; i < utteranceNumbers.size(); ++i)
-        {
-            waveWidget->removeItem(utteranceNumbers[i]);
-        }
-        utteranceNumbers.clear();
-        waveWidget->replot();
-    }
-
-    const QColor color = QColor("red");
-    //qInfo()<<"setting utterance number\n";
+    endTime = timeArray;
+    blocktime.clear();
+    blocktime.reserve(endTime.size());
+    // Untimed lines get no boundary rather than one at 0 s
+    for (const auto& time: std::as_const(endTime))
+        blocktime.append(time.isValid() ? QTime(0, 0).msecsTo(time) : -1);
+    num_of_blocks = endTime.size();
+    plotLines(1);
+}
 
-    int coordinate = 0;
-    for(uint64_t i = 0; i < endLine.size()/* + numOfAddedLines*/; ++i)
-    {
-        QCPItemText* utteranceNumberText = new QCPItemText(waveWidget);
-        utteranceNumberText->setPositionAlignment(Qt::AlignTop | Qt::AlignHCenter);
-        utteranceNumberText->position->setType(QCPItemPosition::ptPlotCoords);
-        utteranceNumberText->position->setCoords(coordinate + (blocktime[i] - coordinate) / 2.0, 0); // Adjust the vertical position
-        utteranceNumberText->setColor(color);
-        utteranceNumberText->setText(QString::number(i + 1)); // Display utterance number
-        // utteranceNumberText->setFont(QFont(font().family(), 15)); // Adjust font size if needed
-
-        QFont font;
-        font.setFamily(this->font().family()); // Use the same font family
-        font.setPointSize(13); // Adjust font size if needed
-        font.setBold(true);
-        font.setWeight(QFont::Black);
-        utteranceNumberText->setFont(font);
-
-        // Add text item to the vector
-        utteranceNumbers.append(utteranceNumberText);
-
-        coordinate = blocktime[i]+1;
+void AudioWaveForm::plotLines(int n)
+{
+    // One plottable for all boundaries, it draws only what is in view
+    QVector<double> ends;
+    ends.reserve(num_of_blocks);
+    for (int i = 0; i < num_of_blocks; ++i)
+        ends.append(blocktime[i] < 0 ? qQNaN() : blocktime[i] / double(MS_PER_SECOND));
+    mBoundaries->setBoundaries(ends);
+    if (selectedLineIndex >= 0) {
+        selectedLineIndex = -1;
+        waveWidget->axisRect()->setRangeDrag(Qt::Horizontal | Qt::Vertical);
     }
-
     waveWidget->replot();
-    linesAvailable = 1;
 
     if(n == 1)
         samplesUpdated();
-
-}
-
-void AudioWaveForm::updateUtterances(int index)
-{
-    // utteranceNumbers[index]->position->setCoords((startCoords[index] + endCoords[index])/2.0, 0);
-    int startIndex = (index <= 0) ? 0: index - 1;
-    if (index + 1 == endCoords.size()) {
-        utteranceNumbers[index]->position->setCoords((endCoords[startIndex] + endCoords[index])/2.0, 0);
-    } else {
-        for (int i = index; i < endCoords.size(); i++) {
-            utteranceNumbers[i]->position->setCoords((endCoords[startIndex] + endCoords[i])/2.0, 0);
-            startIndex = i;
-        }
-    }
-    waveWidget->replot();
 }
 
 void AudioWaveForm::getDuration(qint64 total_time)
@@ -441,27 +443,13 @@ void AudioWaveForm::getDuration(qint64 total_time)
 }
 void AudioWaveForm::samplesUpdated()
 {
+    PROFILE_SCOPE("AudioWaveForm::samplesUpdated");
 
     //qInfo()<<"Updating samples\n";
-    if (mSamples.isEmpty())
+    if (mPeaks.sampleCount() == 0)
         return;
 
-    const double duration = total_duration / MS_PER_SECOND;
-    const double timeStep = duration / (num_sam - 1);
-    QVector<double> timeValues;
-    timeValues.reserve(num_sam);
-
-    int n = mSamples.length();
-    if (n > /*96000*/ num_sam) mSamples = mSamples.mid(n - (num_sam), -1);
-    memcpy(mFftIn, mSamples.data(), num_sam * sizeof(double));
-    fftw_execute(mFftPlan);
-
-    for (qint64 i = 0; i < num_sam; ++i) {
-        timeValues.append(i * timeStep);
-    }
-
-    // Update plot
-    waveWidget->graph(0)->setData(timeValues, mSamples);
+    // The plottable reads only the visible bins from the peak pyramid on each replot
     waveWidget->xAxis->rescale();
     waveWidget->replot();
 
@@ -475,42 +463,14 @@ void AudioWaveForm::samplesUpdated()
 // Slot to handle line movement
 
 void AudioWaveForm::onMousePress(QMouseEvent *event) {
-    // Check if a line is clicked and set it as selected
-    if(linesAvailable == 1){
-        flag1*=(-1);
-        if(flag1 == 1){
-            for(int i = 0; i < endLine.size(); ++i)
-            {
-                /*if(startLine[i]->selectTest(event->pos(), false) >= 0)
-                {
-                    //startLine[i]->setSelectable(true);
-                    //qInfo()<<"start line selected/deselected\n";
-                    startLine[i]->setSelected(!startLine[i]->selected());
-                    deselectLines(startLine, i, num_of_blocks);
-                    deselectLines(endLine, -1, num_of_blocks);
-                    //flag1*=(-1);
-                    break;
-                }
-                else */
-                if(endLine[i]->selectTest(event->pos(), false) >= 0)
-                {
-                    //endLine[i]->setSelectable(true);
-                    endLine[i]->setSelected(!endLine[i]->selected());
-                    deselectLines(endLine, i, endLine.size());
-                    //flag1*=(-1);
-                    break;
-                }
-                else
-                {
-                    deselectLines(endLine, -1, endLine.size());
-                    //flag1*=(-1);
-                }
-            }
-        }
-        else
-        {
-            waveWidget->deselectAll();
-            flag1*=(-1);
+    // A boundary under the cursor is dragged instead of the view
+    if (waveWidget->axisRect()->rect().contains(event->pos())) {
+        selectedLineIndex = mBoundaries->boundaryAt(event->pos().x(), waveWidget->selectionTolerance());
+        if (selectedLineIndex >= 0) {
+            waveWidget->axisRect()->setRangeDrag(Qt::Orientations());
+            mBoundaries->setDragged(selectedLineIndex);
+            waveWidget->replot();
+            return;
         }
     }
 
@@ -518,164 +478,105 @@ void AudioWaveForm::onMousePress(QMouseEvent *event) {
     lastMouseX = waveWidget->xAxis->pixelToCoord(event->pos().x());
 }
 
-void AudioWaveForm::deselectLines(QVector<QCPItemLine *> & lines, int index, int num_of_lines)
+qint64 AudioWaveForm::snapBoundary(double seconds, bool toPause) const
 {
-    for(int i = 0; i < num_of_lines; ++i)
-    {
-        if(i != index){
-            lines[i]->setSelected(false);
+    const int rate = mPeaks.sampleRate();
+    if (rate <= 0)
+        return qRound64(seconds * MS_PER_SECOND);
+
+    // The boundary lands on the sample under the pointer
+    qint64 sample = qRound64(seconds * rate);
+
+    // On request, and once a finest level bin is wider than a pixel, pull it to the
+    // centre of the quietest bin within grabbing distance, which is the pause between words
+    const double pixels = waveWidget->axisRect()->width();
+    const double samplesPerPixel = pixels < 1 ? 0 : waveWidget->xAxis->range().size() * rate / pixels;
+    if (toPause && mPeaks.levelCount() > 0 && samplesPerPixel > 0 && samplesPerPixel < PeakPyramid::binSamples) {
+        const qint64 reach = qRound64(waveWidget->selectionTolerance() * samplesPerPixel);
+        const qint64 first = qMax<qint64>(0, (sample - reach) / PeakPyramid::binSamples);
+        const qint64 last = qMin(mPeaks.binCount(0) - 1, (sample + reach) / PeakPyramid::binSamples);
+        const PeakPyramid::Bin* bins = mPeaks.bins(0);
+
+        qint64 quietest = -1;
+        for (qint64 bin = first; bin <= last; bin++) {
+            if (quietest < 0 || bins[bin].rms < bins[quietest].rms)
+                quietest = bin;
         }
+        if (quietest >= 0)
+            sample = quietest * PeakPyramid::binSamples + PeakPyramid::binSamples / 2;
     }
+    return qRound64(sample * double(MS_PER_SECOND) / rate);
 }
 
-void AudioWaveForm::onMouseMove(QMouseEvent *event) {
-    if(linesAvailable == 1){
-        for(int i = 0; i < endLine.size(); ++i) {
-            if (endLine[i]->selected()) {
-                double x = waveWidget->xAxis->pixelToCoord(event->pos().x());
-                /*if(startLine[i]->selected()) {
-                    // Check if there's a next endLine and a previous endLine
-                    if (i + 1 < num_of_blocks && i - 1 >= 0) {
-                        double nextEndX = endLine[i]->start->coords().x();
-                        double prevEndX = endLine[i - 1]->start->coords().x();
-
-                        // Limit the movement of startLine[i] between nextEndX and prevEndX
-                        if (x >= prevEndX && x <= nextEndX) {
-                            if (startLine[i]->selected()) {
-                                startLine[i]->start->setCoords(x, -1);
-                                startLine[i]->end->setCoords(x, 1);
-                                startCoords[i] = startLine[i]->start->coords().x();
-                                updateUtterances(i);
-                                QTime a(0,0,0);
-                                a = a.addSecs(int(x));
-                                if (updateTimestamps)
-                                    updateTime(i, a);
-                            }
-                        }
-                    }
-
-                    // Check if there's only a next endLine
-                    else if (i + 1 < num_of_blocks) {
-                        double nextEndX = endLine[i]->start->coords().x();
-
-                        // Limit the movement of startLine[i] before nextEndX
-                        if (x <= nextEndX) {
-                            if (startLine[i]->selected()) {
-                                startLine[i]->start->setCoords(x, -1);
-                                startLine[i]->end->setCoords(x, 1);
-                                startCoords[i] = startLine[i]->start->coords().x();
-                                updateUtterances(i);
-                            }
-                        }
-                    }
-
-                    // Check if there's only a previous endLine
-                    else if (i - 1 >= 0) {
-                        double prevEndX = endLine[i - 1]->start->coords().x();
-
-                        // Limit the movement of startLine[i] after prevEndX
-                        if (x >= prevEndX) {
-                            if (startLine[i]->selected()) {
-                                startLine[i]->start->setCoords(x, -1);
-                                startLine[i]->end->setCoords(x, 1);
-                                startCoords[i] = startLine[i]->start->coords().x();
-                                updateUtterances(i);
-                            }
-                        }
-                    }
-                }
-                else*/ if(endLine[i]->selected())
-                {
-                    if (i + 1 < endLine.size() && i - 1 >= 0) {
-                        double nextEndX = endLine[i+1]->start->coords().x();
-                        double prevEndX = (i == 0) ? 0: endLine[i-1]->start->coords().x();
-                        // Limit the movement of startLine[i] between nextEndX and prevEndX
-                        if (x >= prevEndX && x <= nextEndX) {
-                            if (endLine[i]->selected()) {
-                                endLine[i]->start->setCoords(x, -1);
-                                endLine[i]->end->setCoords(x, 1);
-                                endCoords[i] = endLine[i]->start->coords().x();
-                                updateUtterances(i);
-                                blocktime[i] = endCoords[i];
-
-                                if (updateTimestamps && blocktime.size() == num_of_blocks) {
-                                    QTime a(0,0,0);
-                                    a = a.addSecs(endCoords[i]);
-                                    emit updateTime(i, a);
-                                } else if (updateTimestamps) {
-                                    emit updateTimeStampsBlock(blocktime);
-                                    num_of_blocks = blocktime.size();
-                                }
-                            }
-                        }
-                    }
-
-                    // Check if there's only a next endLine
-                    else if (i + 1 < endLine.size()) {
-                        double nextEndX = endLine[i+1]->start->coords().x();
-
-                        // Limit the movement of startLine[i] before nextEndX
-                        if (x <= nextEndX) {
-                            if (endLine[i]->selected()) {
-                                endLine[i]->start->setCoords(x, -1);
-                                endLine[i]->end->setCoords(x, 1);
-                                endCoords[i] = endLine[i]->start->coords().x();
-                                updateUtterances(i);
-                                blocktime[i] = endCoords[i];
-
-                                if (updateTimestamps && blocktime.size() == num_of_blocks) {
-                                    QTime a(0,0,0);
-                                    a = a.addSecs(endCoords[i]);
-                                    emit updateTime(i, a);
-                                } else if (updateTimestamps) {
-                                    emit updateTimeStampsBlock(blocktime);
-                                    num_of_blocks = blocktime.size();
-                                }
-                            }
-                        }
-                    }
-
-                    // Check if there's only a previous endLine
-                    else if (i - 1 >= 0) {
-                        double prevEndX = (i == 0) ? 0: endLine[i-1]->start->coords().x();
-
-                        // Limit the movement of startLine[i] after prevEndX
-                        if (x >= prevEndX) {
-                            if (endLine[i]->selected()) {
-                                endLine[i]->start->setCoords(x, -1);
-                                endLine[i]->end->setCoords(x, 1);
-                                endCoords[i] = endLine[i]->start->coords().x();
-                                updateUtterances(i);
-                                blocktime[i] = endCoords[i];
-
-                                if (updateTimestamps && blocktime.size() == num_of_blocks) {
-                                    QTime a(0,0,0);
-                                    a = a.addSecs(endCoords[i]);
-                                    emit updateTime(i, a);
-                                } else if (updateTimestamps) {
-                                    emit updateTimeStampsBlock(blocktime);
-                                    num_of_blocks = blocktime.size();
-                                }
-                            }
-                        }
-                    }
-                }
-                waveWidget->replot();
-            }
-        }
+void AudioWaveForm::moveBoundary(int index, double x, bool toPause)
+{
+    qint64 ms = snapBoundary(x, toPause);
+
+    // Boundaries stay between their timed neighbours, unless a neighbour is already
+    // out of order; clamping to it would pin the boundary where it is
+    const qint64 current = blocktime[index];
+    qint64 previous = 0;
+    for (int i = index - 1; i >= 0; i--) {
+        if (blocktime[i] < 0)
+            continue;
+        if (blocktime[i] <= current)
+            previous = blocktime[i];
+        break;
     }
+    qint64 next = std::numeric_limits<qint64>::max();
+    for (int i = index + 1; i < blocktime.size(); i++) {
+        if (blocktime[i] < 0)
+            continue;
+        if (blocktime[i] >= current)
+            next = blocktime[i];
+        break;
+    }
+    ms = qBound(previous, ms, next);
+    if (ms == blocktime[index])
+        return;
 
-    // if (playLine && playLine->selected())
-    // {
-    //     double x = waveWidget->xAxis->pixelToCoord(event->pos().x());
-    //     double nextEndX = playLine->start->coords().x();
-    //     double prevEndX = playLine->start->coords().x();
+    blocktime[index] = ms;
+    mBoundaries->setBoundary(index, ms / double(MS_PER_SECOND));
 
-    //     playLine->start->setCoords(x, -1);
-    //     playLine->end->setCoords(x, 1);
-    //     waveWidget->replot();
+    if (!updateTimestamps)
+        return;
+    if (mPendingBoundary != index)
+        flushBoundaryUpdate();
+    mPendingBoundary = index;
+    if (!mBoundaryTimer->isActive())
+        mBoundaryTimer->start();
+}
 
-    // }
+void AudioWaveForm::flushBoundaryUpdate()
+{
+    mBoundaryTimer->stop();
+    if (mPendingBoundary < 0)
+        return;
+
+    int index = mPendingBoundary;
+    mPendingBoundary = -1;
+    // The boundaries may have been replaced since, e.g. by a new transcript
+    if (index >= blocktime.size())
+        return;
+    if (blocktime.size() == num_of_blocks) {
+        emit updateTime(index, QTime(0, 0).addMSecs(blocktime[index]));
+    } else {
+        emit updateTimeStampsBlock(blocktime);
+        num_of_blocks = blocktime.size();
+    }
+}
+
+void AudioWaveForm::onMouseMove(QMouseEvent *event) {
+    if (event->buttons() == Qt::NoButton)
+        setHoverPosition(waveWidget->xAxis->pixelToCoord(event->pos().x()));
+
+    if (selectedLineIndex >= 0) {
+        // Alt pulls the boundary into the nearest pause
+        moveBoundary(selectedLineIndex, waveWidget->xAxis->pixelToCoord(event->pos().x()),
+                     event->modifiers().testFlag(Qt::AltModifier));
+        mCursorLayer->replot();
+        return;
+    }
 
     if (dragging && playLine)
     {
@@ -684,7 +585,7 @@ void AudioWaveForm::onMouseMove(QMouseEvent *event) {
 
         playLine->start->setCoords(playLine->start->coords().x() + deltaX, playLine->start->coords().y());
         playLine->end->setCoords(playLine->end->coords().x() + deltaX, playLine->end->coords().y());
-        waveWidget->replot();
+        mCursorLayer->replot();
 
         lastMouseX = currentMouseX;
 
@@ -717,6 +618,14 @@ void AudioWaveForm::onMouseRelease(QMouseEvent *event)
     }
 
     waveWidget->deselectAll();
+    if (selectedLineIndex >= 0) {
+        // Back onto the main layer, which is redrawn once with the final position
+        flushBoundaryUpdate();
+        selectedLineIndex = -1;
+        mBoundaries->setDragged(-1);
+        waveWidget->axisRect()->setRangeDrag(Qt::Horizontal | Qt::Vertical);
+        waveWidget->replot();
+    }
 }
 
 // void AudioWaveForm::resizeEvent(QResizeEvent *event)
@@ -726,30 +635,11 @@ void AudioWaveForm::onMouseRelease(QMouseEvent *event)
 // }
 
 void AudioWaveForm::addPlotLine() {
-
-
-    QCPItemLine* newendline = new QCPItemLine(waveWidget);
-
-
-
-    // uint64_t index = endLine.size() - 1;
-
-    // blocktime.append(blocktime[blocktime.size() - 1] + 1);
-    QColor color(255, 255, 0);
-    double lastCoor = endCoords.empty() ? 1: endCoords.last() + 1;
-
-    newendline->start->setCoords(lastCoor, -1);
-    newendline->end->setCoords(lastCoor, 1);
-    newendline->setPen(QPen(color));
-    endLine.append(newendline);
+    const qint64 latest = blocktime.isEmpty() ? 0 : *std::max_element(blocktime.cbegin(), blocktime.cend());
+    qint64 lastCoor = qMax<qint64>(latest, 0) + MS_PER_SECOND;
+    mBoundaries->append(lastCoor / double(MS_PER_SECOND));
     waveWidget->replot();
 
-    double endCoordinate = newendline->start->coords().x();
-    endCoords.append(endCoordinate);
-
-    // numOfAddedLines++;
-
-    addUtteranceNumber();
     blocktime.append(lastCoor);
 
     if (updateTimestamps) {
@@ -759,36 +649,6 @@ void AudioWaveForm::addPlotLine() {
 
 }
 
-void AudioWaveForm::addUtteranceNumber() {
-    int startCoordinate = 0;
-    int endCoordinate = 1;
-    if (!endCoords.empty() && endCoords.size() >= 2) {
-        startCoordinate = endCoords[endCoords.size()-2];
-        endCoordinate = endCoords[endCoords.size()-1];
-    }
-    const QColor color = QColor("red");
-    QCPItemText* utteranceNumberText = new QCPItemText(waveWidget);
-    utteranceNumberText->setPositionAlignment(Qt::AlignTop | Qt::AlignHCenter);
-    utteranceNumberText->position->setType(QCPItemPosition::ptPlotCoords);
-    utteranceNumberText->position->setCoords((startCoordinate + endCoordinate) / 2.0, 0); // Adjust the vertical position
-    utteranceNumberText->setColor(color);
-    utteranceNumberText->setText(QString::number(endCoords.size())); // Display utterance number
-    // utteranceNumberText->setFont(QFont(font().family(), 15)); // Adjust font size if needed
-
-    QFont font;
-    font.setFamily(this->font().family()); // Use the same font family
-    font.setPointSize(13); // Adjust font size if needed
-    font.setBold(true);
-    font.setWeight(QFont::Black);
-    utteranceNumberText->setFont(font);
-
-    // Add text item to the vector
-    utteranceNumbers.append(utteranceNumberText);
-
-    // coordinate = blocktime[blocktime.size()]+1;
-    waveWidget->replot();
-}
-
 void AudioWaveForm::on_addBtn_clicked()
 {
     addPlotLine();
@@ -816,21 +676,12 @@ void AudioWaveForm::on_updateTimestampsBtn_clicked()
 }
 
 void AudioWaveForm::setMediaUrl(QUrl url) {
+    cancelDecode();
     emit samplingStatus(false);
-    waveWidget->graph(0)->data()->clear();
+    mPeaks.reset(0);
     if (playLine) {
         waveWidget->removeItem(playLine.release());
     }
     waveWidget->replot();
     mUrl = url;
 }
-
-bool AudioWaveForm::isAudioFile(const QString& filePath) {
-    QFileInfo fileInfo(filePath);
-    QStringList audioExtensions = {/*"mp3", */"wav" /*, "ogg", "flac", "aac"*//*, "m4a"*/}; // Add more audio extensions as needed
-
-    return audioExtensions.contains(fileInfo.suffix().toLower());
-}
-
-
-
@@ -14,8 +14,12 @@
 //---------------------------------------
 #include"mediaplayer/qcustomplot.h"
 #include<QVector>
-#include"mediaplayer/fftw3.h"
+#include"mediaplayer/utilities/audiodecoder.h"
+#include"mediaplayer/utilities/peakpyramid.h"
+#include"mediaplayer/utilities/spscqueue.h"
 #include<QAudioFormat>
+#include<QFuture>
+#include<QTimer>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -30,6 +34,10 @@ namespace Ui {
 class AudioWaveForm;
 }
 
+class BoundaryPlottable;
+class SpectrogramPlottable;
+class WaveformPlottable;
+
 class AudioWaveForm : public QWidget
 {
     Q_OBJECT
@@ -40,6 +48,10 @@ public:
     void updateTimestampsToggle();
     void updateTimeStamps();
     void showWaveForm();
+    /// Shows or hides the spectrogram lane under the waveform.
+    void setSpectrogramVisible(bool visible);
+    /// Samples per spectrogram analysis frame, 256 to 2048.
+    void setSpectrogramFrameSize(int frameSize);
 
 public slots:
     void getDuration(qint64 total_time);
@@ -50,7 +62,6 @@ public slots:
     void setMediaUrl(QUrl url);
 
 private slots:
-    void processAudioIn();
     void onMouseRelease(QMouseEvent *event);
     void onMouseMove(QMouseEvent *event);
     void onMousePress(QMouseEvent *event);
@@ -63,74 +74,88 @@ signals:
     void updateTime(int block_num, QTime endTime);
     void positionChanged(qint64 position);
     void samplingStatus(bool status);
-    void updateTimeStampsBlock(QVector<int> blocks);
+    /// Every block's end time in milliseconds, -1 for untimed blocks.
+    void updateTimeStampsBlock(QVector<qint64> blocks);
 
 protected:
     // void resizeEvent(QResizeEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
     Ui::AudioWaveForm *ui;
     //-------------------------------------------
 
     QCustomPlot *waveWidget;
-    void processSampleRate();
-    void processBuffer();
+    void cancelDecode();
+    void decodeStarted(int generation, const AudioDecoder::Info& info, const QString& cacheKey);
+    void peaksLoaded(int generation, const PeakPyramid& peaks, const AudioDecoder::Info& info);
+    bool drainPeaks();
+    void decodeFinished(int generation, bool ok, const QString& error);
 
     void samplesUpdated();
+    void updateSpectrogramSource();
     void plotLines(int n);
-    void deselectLines(QVector<QCPItemLine*> &lines, int index, int num_of_lines);
-    void setUtteranceNumber(int n);
-    void updateUtterances(int ind);
+    /// Moves boundary \a index to the sample at \a x seconds, or to a pause at deep zoom if \a toPause.
+    /// The editor is told on the next flushBoundaryUpdate().
+    void moveBoundary(int index, double x, bool toPause);
+    /// Sends the editor the last position of a moved boundary, if any is pending.
+    void flushBoundaryUpdate();
+    qint64 snapBoundary(double seconds, bool toPause) const;
     void adjustTime(double timeValue);
     void getUpdatedIndexes(int index1, int index2);
     void addPlotLine();
-    void addUtteranceNumber();
-    bool isAudioFile(const QString& filePath);
-
-    QBuffer mInputBuffer;
-    qint64 tot_duration;
+    void setHoverPosition(double seconds);
+
+    /// Finest level peak bins summarised by the decoder thread.
+    struct PeakChunk
+    {
+        QVector<PeakPyramid::Bin> bins;
+        qint64 samples = 0;
+    };
+    using PeakQueue = SpscQueue<PeakChunk>;
+
+    QFuture<void> mDecode;          ///< Decoder running on the thread pool, see showWaveForm().
+    std::shared_ptr<PeakQueue> mPeakQueue; ///< Decoder to GUI hand over, one per decode.
+    QTimer* mDrainTimer = nullptr;
+    int mDecodeGeneration = 0;      ///< Chunks queued by an older decode are dropped.
+    PeakPyramid mPeaks;             ///< All the waveform keeps of the decoded audio.
+    AudioDecoder::Info mDecodeInfo;
+    QString mPeakCacheKey;          ///< Fingerprint of the media file, see PeakCache.
+    WaveformPlottable* mWaveform = nullptr;
+    QCPMarginGroup* mLaneMargins = nullptr;     ///< Keeps the spectrogram lane aligned with the waveform.
+    QCPAxisRect* mSpectrogramRect = nullptr;    ///< Only exists while the lane is shown.
+    SpectrogramPlottable* mSpectrogram = nullptr;
+    int mSpectrogramFrameSize = 1024;
 
     //qint64 mDuration;
-    QVector<double> mFftIndices;
-
-    fftw_plan mFftPlan;
-    double *mFftIn;
-    double *mFftOut;
-
-    QVector<double> mSamples;
-    QVector<double> mIndices;
 
     qint64 total_duration = 0;
-    int flag1 = 1;
-    int linesAvailable = -1;
-    int num_of_blocks;
+    int num_of_blocks = 0;
     qint64 sample_rate = 0;
     qint64 num_sam = 0;
     int factor = 1;
-    QVector<int> blocktime;
+    QVector<qint64> blocktime;      ///< Block end times in milliseconds, -1 if untimed.
     QVector<QTime> endTime;
 
-    QVector<QCPItemLine*> startLine;
-    QVector<QCPItemLine*> endLine;
-    QVector<QCPItemText*> utteranceNumbers;
+    BoundaryPlottable* mBoundaries = nullptr;       ///< Utterance end boundaries and numbers.
+    BoundaryPlottable* mBoundaryPreview = nullptr;  ///< The dragged boundary, on mCursorLayer.
     std::unique_ptr<QCPItemLine> playLine = nullptr;
-    // QVector<double> startCoords;
-    QVector<double> endCoords;
+    /// Buffered layer above the waveform for the playhead, the hover cursor and the
+    /// boundary being dragged, so moving them repaints only this layer.
+    QCPLayer* mCursorLayer = nullptr;
+    QCPItemLine* mHoverLine = nullptr;
     bool updateTimestamps = false;
 
     bool dragging = false;
     double lastMouseX;
-    int selectedLineIndex = -1;
-    uint64_t numOfAddedLines = 0;
+    int selectedLineIndex = -1;     ///< Boundary being dragged, -1 if none.
+    QTimer* mBoundaryTimer = nullptr;   ///< Coalesces drag updates to the editor.
+    int mPendingBoundary = -1;          ///< Moved boundary the editor hasn't seen yet, -1 if none.
     QString blockText;
 
     QUrl mUrl;
-    QMediaPlayer* mPlayer = nullptr;
-    QBuffer mAudioBuffer;
     QString mMediaFileName;
 
-    QVector<double> timeValues;
-
 
 };
 
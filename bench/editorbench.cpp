@@ -0,0 +1,220 @@
+#include "editorbench.h"
+
+#include "synthetictranscript.h"
+#include "editor/editor.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+#include <QTextBlock>
+
+namespace {
+
+const QStringList benchLanguages = {"english", "hindi", "telugu"};
+const QList<int> benchSizes = {1000, 10000, 100000};
+
+constexpr quint32 seed = 0x5eed; ///< Seeks are as repeatable as the transcripts
+constexpr int seeksPerIteration = 256;
+
+}
+
+void EditorBenchmark::addTranscriptRows()
+{
+    QTest::addColumn<QString>("language");
+    QTest::addColumn<int>("blocks");
+
+    for (auto& language: benchLanguages)
+        for (int blocks: benchSizes)
+            QTest::addRow("%s/%d", qPrintable(language), blocks) << language << blocks;
+}
+
+QString EditorBenchmark::transcriptPath(const QString& language, int blocks)
+{
+    auto key = QString("%1/%2").arg(language).arg(blocks);
+    if (!m_transcripts.contains(key)) {
+        auto path = m_dir.filePath(QString("%1-%2.xml").arg(language).arg(blocks));
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return {};
+        file.write(syntheticTranscript(language, blocks));
+        m_transcripts.insert(key, path);
+    }
+    return m_transcripts.value(key);
+}
+
+bool EditorBenchmark::loadTranscript(const QString& language, int blocks)
+{
+    QFile file(transcriptPath(language, blocks));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_editor->loadTranscriptData(file);
+    m_editor->loadDictionary();
+    // Highlight state from a previous, possibly longer, transcript
+    m_editor->highlightedBlock = -1;
+    m_editor->highlightedWord = -1;
+    return m_editor->m_blocks.size() == blocks;
+}
+
+void EditorBenchmark::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    m_editor.reset(new Editor);
+    m_editor->resize(1200, 800);
+    m_editor->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_editor.data()));
+}
+
+void EditorBenchmark::cleanupTestCase()
+{
+    m_editor.reset();
+}
+
+void EditorBenchmark::loadTranscriptData_data()
+{
+    addTranscriptRows();
+}
+
+void EditorBenchmark::loadTranscriptData()
+{
+    QFETCH(QString, language);
+    QFETCH(int, blocks);
+
+    auto path = transcriptPath(language, blocks);
+    QVERIFY(!path.isEmpty());
+
+    QBENCHMARK {
+        QFile file(path);
+        file.open(QIODevice::ReadOnly);
+        m_editor->loadTranscriptData(file);
+    }
+    QCOMPARE(m_editor->m_blocks.size(), blocks);
+}
+
+void EditorBenchmark::saveXml_data()
+{
+    addTranscriptRows();
+}
+
+void EditorBenchmark::saveXml()
+{
+    QFETCH(QString, language);
+    QFETCH(int, blocks);
+    QVERIFY(loadTranscript(language, blocks));
+
+    auto path = m_dir.filePath("saved.xml");
+    QBENCHMARK {
+        // saveXml takes ownership of the file
+        auto file = new QFile(path);
+        QVERIFY(file->open(QIODevice::WriteOnly | QIODevice::Truncate));
+        m_editor->saveXml(file);
+    }
+}
+
+void EditorBenchmark::setContent_data()
+{
+    addTranscriptRows();
+}
+
+void EditorBenchmark::setContent()
+{
+    QFETCH(QString, language);
+    QFETCH(int, blocks);
+    QVERIFY(loadTranscript(language, blocks));
+
+    QBENCHMARK {
+        m_editor->setContent();
+    }
+}
+
+void EditorBenchmark::contentChanged_data()
+{
+    addTranscriptRows();
+}
+
+void EditorBenchmark::contentChanged()
+{
+    QFETCH(QString, language);
+    QFETCH(int, blocks);
+    QVERIFY(loadTranscript(language, blocks));
+    m_editor->setContent();
+
+    // Type and erase one character at the end of a line in the middle of the transcript
+    QTextCursor cursor(m_editor->textBlockAt(blocks / 2));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    m_editor->setTextCursor(cursor);
+
+    QBENCHMARK {
+        cursor.insertText("a");
+        cursor.deletePreviousChar();
+    }
+    QCOMPARE(m_editor->m_blocks.size(), blocks);
+}
+
+void EditorBenchmark::highlightTranscript_data()
+{
+    addTranscriptRows();
+}
+
+void EditorBenchmark::highlightTranscript()
+{
+    QFETCH(QString, language);
+    QFETCH(int, blocks);
+    QVERIFY(loadTranscript(language, blocks));
+    m_editor->setContent();
+
+    // Random seeks over the whole transcript, as a user scrubbing the player would
+    QRandomGenerator random(seed);
+    int duration = QTime(0, 0).msecsTo(m_editor->m_blocks.last().timeStamp);
+    QList<QTime> seeks;
+    for (int i = 0; i < seeksPerIteration; i++)
+        seeks.append(QTime(0, 0).addMSecs(random.bounded(duration)));
+
+    QBENCHMARK {
+        for (auto& seek: std::as_const(seeks))
+            m_editor->highlightTranscript(seek);
+    }
+}
+
+void EditorBenchmark::isWordValid_data()
+{
+    addTranscriptRows();
+}
+
+void EditorBenchmark::isWordValid()
+{
+    QFETCH(QString, language);
+    QFETCH(int, blocks);
+    QVERIFY(loadTranscript(language, blocks));
+
+    QStringList words;
+    for (auto& a_block: std::as_const(m_editor->m_blocks))
+        for (auto& a_word: a_block.words)
+            words.append(a_word.text);
+
+    QBENCHMARK {
+        qint64 valid{0};
+        for (auto& a_word: std::as_const(words))
+            valid += m_editor->isWordValid(a_word, m_editor->m_dictionary, m_editor->m_english_dictionary, language);
+        m_sink += valid;
+    }
+}
+
+void EditorBenchmark::loadDictionary_data()
+{
+    QTest::addColumn<QString>("language");
+
+    for (auto language: {"english", "hindi", "gujarati", "marathi", "telugu"})
+        QTest::newRow(language) << QString(language);
+}
+
+void EditorBenchmark::loadDictionary()
+{
+    QFETCH(QString, language);
+    m_editor->m_transcriptLang = language;
+
+    QBENCHMARK {
+        m_editor->loadDictionary();
+    }
+    QVERIFY(!m_editor->m_dictionary.isEmpty());
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+class Editor;
+
+/**
+ * @brief QBENCHMARK suite over the transcript engine of \c Editor.
+ *
+ * Every data driven benchmark runs on synthetic transcripts of 1k, 10k and 100k lines
+ * written in Latin, Devanagari and Telugu script, with words drawn from the bundled
+ * word lists so that dictionary lookups see a realistic hit rate.
+ */
+class EditorBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void loadTranscriptData_data();
+    void loadTranscriptData();
+    void saveXml_data();
+    void saveXml();
+    void setContent_data();
+    void setContent();
+    void contentChanged_data();
+    void contentChanged();
+    void highlightTranscript_data();
+    void highlightTranscript();
+    void isWordValid_data();
+    void isWordValid();
+    void loadDictionary_data();
+    void loadDictionary();
+
+private:
+    static void addTranscriptRows();
+
+    QString transcriptPath(const QString& language, int blocks);
+    bool loadTranscript(const QString& language, int blocks);
+
+    QScopedPointer<Editor> m_editor;
+    QTemporaryDir m_dir;
+    QHash<QString, QString> m_transcripts; ///< Generated transcript files keyed by row tag.
+    volatile qint64 m_sink{0}; ///< Volatile writes keep measured results observable so loops aren't optimised away.
+};
@@ -0,0 +1,139 @@
+#include "mediaplayer/utilities/peakpyramid.h"
+#include "mediaplayer/utilities/samplekernels.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Throughput of the waveform's sample kernels with every instruction set the CPU
+// supports, in samples per second. SIMD results are checked against the scalar
+// ones first, so a broken kernel fails the run instead of looking fast.
+
+namespace {
+
+constexpr int bufferSamples = 1 << 20;
+constexpr qint64 minimumNanoseconds = 300'000'000;
+
+using Set = SampleKernels::InstructionSet;
+
+/// Runs \a body over bufferSamples samples until enough time has passed.
+double samplesPerSecond(const std::function<void()>& body)
+{
+    body();  // warm up caches and the dispatcher
+    QElapsedTimer timer;
+    timer.start();
+    qint64 rounds = 0;
+    do {
+        body();
+        rounds++;
+    } while (timer.nsecsElapsed() < minimumNanoseconds);
+    return rounds * double(bufferSamples) / (timer.nsecsElapsed() / 1e9);
+}
+
+bool close(float a, float b)
+{
+    return std::abs(a - b) <= 1e-4f * qMax(1.0f, std::abs(a));
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    auto arguments = app.arguments();
+    QString jsonPath;
+    int jsonArgument = arguments.indexOf("--json");
+    if (jsonArgument != -1 && jsonArgument + 1 < arguments.size())
+        jsonPath = arguments[jsonArgument + 1];
+
+    // Speech-like input: noise with a slowly changing level
+    auto random = QRandomGenerator(0x5eed);
+    std::vector<qint16> pcm(bufferSamples);
+    std::vector<float> samples(bufferSamples);
+    for (int i = 0; i < bufferSamples; i++) {
+        double level = 0.5 + 0.5 * std::sin(i / 4000.0);
+        pcm[i] = qint16((random.generateDouble() * 2 - 1) * level * 32767);
+    }
+    std::vector<float> converted(bufferSamples);
+    std::vector<PeakPyramid::Bin> bins(PeakPyramid::binsFor(bufferSamples));
+    // Every kernel stores a result here, so the timed loops can't be optimised away
+    volatile float sink = 0;
+
+    // Compared a bin at a time, single precision sums over a whole buffer drift apart with the order
+    auto reduceBins = [&]() {
+        std::vector<SampleKernels::Summary> summaries;
+        for (int first = 0; first < bufferSamples; first += PeakPyramid::binSamples)
+            summaries.push_back(SampleKernels::reduce(samples.data() + first, PeakPyramid::binSamples));
+        return summaries;
+    };
+    SampleKernels::setInstructionSet(Set::Scalar);
+    SampleKernels::int16ToFloat(pcm.data(), bufferSamples, samples.data());
+    const auto reference = reduceBins();
+
+    QJsonArray results;
+    bool ok = true;
+    std::printf("%-14s %-8s %14s\n", "kernel", "isa", "Msamples/s");
+
+    for (auto set: SampleKernels::supportedInstructionSets()) {
+        SampleKernels::setInstructionSet(set);
+
+        SampleKernels::int16ToFloat(pcm.data(), bufferSamples, converted.data());
+        const auto summaries = reduceBins();
+        bool same = converted == samples;
+        for (size_t i = 0; same && i < summaries.size(); i++) {
+            same = summaries[i].min == reference[i].min && summaries[i].max == reference[i].max
+                   && close(summaries[i].energy, reference[i].energy);
+        }
+        if (!same) {
+            std::printf("%s results differ from scalar\n", SampleKernels::name(set));
+            ok = false;
+            continue;
+        }
+
+        const std::pair<const char*, std::function<void()>> kernels[] = {
+            {"int16ToFloat", [&]() {
+                SampleKernels::int16ToFloat(pcm.data(), bufferSamples, converted.data());
+                sink = converted.back();
+            }},
+            {"reduce", [&]() { sink = SampleKernels::reduce(samples.data(), bufferSamples).energy; }},
+            {"summarize", [&]() {
+                PeakPyramid::summarize(samples.data(), bufferSamples, bins.data());
+                sink = bins.back().rms;
+            }},
+        };
+        for (auto& [kernel, body]: kernels) {
+            double rate = samplesPerSecond(body);
+            std::printf("%-14s %-8s %14.1f\n", kernel, SampleKernels::name(set), rate / 1e6);
+            results.append(QJsonObject{
+                {"benchmark", kernel},
+                {"isa", SampleKernels::name(set)},
+                {"samplesPerSecond", rate}
+            });
+        }
+    }
+
+    if (!jsonPath.isEmpty()) {
+        QJsonObject report{
+            {"application", "Vagyojaka"},
+            {"version", VAGYOJAKA_VERSION},
+            {"date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+            {"results", results}
+        };
+        QFile json(jsonPath);
+        if (!json.open(QIODevice::WriteOnly | QIODevice::Truncate) || json.write(QJsonDocument(report).toJson()) < 0)
+            qWarning() << "Couldn't write benchmark report to" << jsonPath;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+#include "keyreplay.h"
+
+#include "editor/editor.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QRandomGenerator>
+#include <QTextBlock>
+
+KeyReplay::KeyReplay(Editor* editor)
+    : m_editor(editor)
+{
+}
+
+bool KeyReplay::loadTranscript(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    // What loadTranscriptFromUrl does, without the backup file and autosave
+    m_editor->loadTranscriptData(file);
+    if (m_editor->m_transcriptLang == "")
+        m_editor->m_transcriptLang = "english";
+    m_editor->loadDictionary();
+    m_editor->setContent();
+
+    return !m_editor->m_blocks.isEmpty();
+}
+
+QString KeyReplay::language() const
+{
+    return m_editor->m_transcriptLang;
+}
+
+int KeyReplay::blockCount() const
+{
+    return m_editor->m_blocks.size();
+}
+
+void KeyReplay::placeCursor()
+{
+    auto textBlock = m_editor->textBlockAt(m_editor->m_blocks.size() / 2);
+    int speakerEnd = textBlock.text().indexOf("}: ");
+
+    QTextCursor cursor(textBlock);
+    cursor.setPosition(textBlock.position() + (speakerEnd == -1 ? 0 : speakerEnd + 3));
+    m_editor->setTextCursor(cursor);
+    m_editor->setFocus();
+}
+
+QString KeyReplay::kindOf(const KeyStroke& stroke, QWidget* target) const
+{
+    if (target != m_editor || (stroke.key == Qt::Key_N && stroke.modifiers == Qt::ControlModifier))
+        return "completer";
+
+    switch (stroke.key) {
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        return "split";
+    case Qt::Key_Backspace:
+        return m_editor->textCursor().positionInBlock() == 0 ? "merge" : "delete";
+    case Qt::Key_Delete:
+        return m_editor->textCursor().atBlockEnd() ? "merge" : "delete";
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+    case Qt::Key_Left:
+    case Qt::Key_Right:
+    case Qt::Key_Home:
+    case Qt::Key_End:
+    case Qt::Key_PageUp:
+    case Qt::Key_PageDown:
+        return "navigation";
+    default:
+        break;
+    }
+
+    bool modified = (stroke.modifiers & ~(Qt::ShiftModifier | Qt::KeypadModifier)) != Qt::NoModifier;
+    return modified ? "shortcut" : "typing";
+}
+
+QVector<KeyReplay::Sample> KeyReplay::replay(const QList<KeyStroke>& strokes, int warmup)
+{
+    QVector<Sample> samples;
+    samples.reserve(strokes.size());
+    m_skipped = 0;
+
+    QElapsedTimer timer;
+    for (int i = 0; i < strokes.size(); i++) {
+        auto& stroke = strokes[i];
+
+        // The speaker and time propagation dialogs wait for input that a replay can't give
+        if (stroke.modifiers == Qt::ControlModifier && (stroke.key == Qt::Key_R || stroke.key == Qt::Key_T)) {
+            m_skipped++;
+            continue;
+        }
+
+        // Completer popups filter their own keys, as they do for a real keyboard
+        QWidget* target = QApplication::activePopupWidget();
+        if (!target)
+            target = m_editor;
+        auto kind = kindOf(stroke, target);
+
+        timer.start();
+        QKeyEvent press(QEvent::KeyPress, stroke.key, stroke.modifiers, stroke.text);
+        QApplication::sendEvent(target, &press);
+        QKeyEvent release(QEvent::KeyRelease, stroke.key, stroke.modifiers, stroke.text);
+        QApplication::sendEvent(target, &release);
+        QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+        double ms = timer.nsecsElapsed() / 1e6;
+
+        if (i >= warmup)
+            samples.append({kind, ms});
+    }
+
+    return samples;
+}
+
+QList<KeyStroke> KeyReplay::syntheticStream(const QStringList& vocabulary, int count, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QList<KeyStroke> strokes;
+    strokes.reserve(count + 16);
+
+    auto press = [&strokes](int key, Qt::KeyboardModifiers modifiers = Qt::NoModifier) {
+        strokes.append(KeyStroke::pressed(key, modifiers));
+    };
+    auto type = [&strokes](const QString& text) {
+        for (auto character: text)
+            strokes.append(KeyStroke::typed(character));
+    };
+
+    while (strokes.size() < count) {
+        auto word = vocabulary.isEmpty() ? QString("word") : vocabulary[random.bounded(int(vocabulary.size()))];
+        int action = random.bounded(100);
+
+        if (action < 70) {
+            type(word + " ");
+        }
+        else if (action < 78) {
+            // Mistype and correct
+            type(word.left(2));
+            for (int i = 0; i < 2; i++)
+                press(Qt::Key_Backspace);
+        }
+        else if (action < 83) {
+            press(Qt::Key_M, Qt::ControlModifier);
+        }
+        else if (action < 87) {
+            // Split the line at the cursor and join it back
+            press(Qt::Key_Return);
+            press(Qt::Key_Backspace);
+        }
+        else if (action < 92) {
+            // Ask for completions of a prefix, walk the list and dismiss it
+            type(word.left(2));
+            press(Qt::Key_N, Qt::ControlModifier);
+            press(Qt::Key_Down);
+            press(Qt::Key_Down);
+            press(Qt::Key_Escape);
+            type(word.mid(2) + " ");
+        }
+        else {
+            press(random.bounded(2) ? Qt::Key_Down : Qt::Key_Up);
+        }
+    }
+
+    return strokes;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "profiling/keyrecorder.h"
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class Editor;
+class QWidget;
+
+/**
+ * @class KeyReplay
+ * @brief Replays key presses into an \c Editor and times each one.
+ *
+ * A press is timed from delivery until the posted events it caused are processed,
+ * so the highlighter, completer and repaint work it triggers are included.
+ */
+class KeyReplay
+{
+public:
+    struct Sample
+    {
+        QString kind; ///< typing, split, merge, delete, completer, navigation or shortcut.
+        double ms{0};
+    };
+
+    explicit KeyReplay(Editor* editor);
+
+    bool loadTranscript(const QString& fileName);
+    QString language() const;
+    int blockCount() const;
+    /// Puts the cursor before the first word of the middle line.
+    void placeCursor();
+
+    /// Presses replayed in order, the first \a warmup of them aren't sampled.
+    QVector<Sample> replay(const QList<KeyStroke>& strokes, int warmup = 0);
+    int skipped() const { return m_skipped; }
+
+    /// Typing mixed with corrections, marking, split/merge, completer use and line changes.
+    static QList<KeyStroke> syntheticStream(const QStringList& vocabulary, int count, quint32 seed);
+
+private:
+    QString kindOf(const KeyStroke& stroke, QWidget* target) const;
+
+    Editor* m_editor;
+    int m_skipped{0};
+};
@@ -0,0 +1,182 @@
+#include "keyreplay.h"
+#include "synthetictranscript.h"
+#include "editor/editor.h"
+#include "profiling/profiler.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+struct Distribution
+{
+    int count{0};
+    double meanMs{0};
+    double p50Ms{0};
+    double p90Ms{0};
+    double p99Ms{0};
+    double maxMs{0};
+
+    QJsonObject toJson() const
+    {
+        return {{"count", count}, {"mean", meanMs}, {"p50", p50Ms}, {"p90", p90Ms}, {"p99", p99Ms}, {"max", maxMs}};
+    }
+};
+
+// Nearest-rank percentiles
+Distribution distribution(QVector<double> latencies)
+{
+    Distribution result;
+    if (latencies.isEmpty())
+        return result;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        int rank = qMax(1, int(std::ceil(p * latencies.size())));
+        return latencies[rank - 1];
+    };
+
+    result.count = latencies.size();
+    result.meanMs = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.size();
+    result.p50Ms = percentile(0.50);
+    result.p90Ms = percentile(0.90);
+    result.p99Ms = percentile(0.99);
+    result.maxMs = latencies.last();
+    return result;
+}
+
+}
+
+// Replays key presses into an Editor and fails when the p99 latency is over budget:
+//   vagyojaka_latency --keys recorded.keys --transcript big.xml --budget 16
+// Logs are recorded from the application with "--record-keys <file>". Without a
+// log a synthetic stream is replayed, and without a transcript a synthetic one is
+// loaded. Set QT_QPA_PLATFORM=offscreen to run without a display.
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    app.setApplicationName("Vagyojaka");
+    app.setOrganizationName("IIT Bombay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Keystroke latency replay for the transcript editor");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"transcript", "Transcript XML to load.", "file"},
+        {"language", "Language of the synthetic transcript.", "language", "english"},
+        {"blocks", "Lines in the synthetic transcript.", "count", "10000"},
+        {"keys", "Key log to replay instead of a synthetic stream.", "file"},
+        {"events", "Key presses in the synthetic stream.", "count", "2000"},
+        {"seed", "Seed of the synthetic stream.", "seed", "1"},
+        {"warmup", "Key presses replayed before sampling starts.", "count", "100"},
+        {"budget", "p99 latency budget in milliseconds, VAGYOJAKA_LATENCY_BUDGET by default, else 16.", "ms"},
+        {"json", "Write the report as JSON.", "file"},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    double budget = parser.isSet("budget") ? parser.value("budget").toDouble()
+                                           : qEnvironmentVariable("VAGYOJAKA_LATENCY_BUDGET", "16").toDouble();
+
+    QTemporaryDir dir;
+    auto transcript = parser.value("transcript");
+    if (transcript.isEmpty()) {
+        transcript = dir.filePath("synthetic.xml");
+        QFile file(transcript);
+        if (!file.open(QIODevice::WriteOnly)) {
+            err << "Couldn't write " << transcript << Qt::endl;
+            return 2;
+        }
+        file.write(syntheticTranscript(parser.value("language"), qMax(1, parser.value("blocks").toInt())));
+    }
+
+    Editor editor;
+    editor.resize(1200, 800);
+    editor.show();
+    QApplication::processEvents();
+
+    KeyReplay replay(&editor);
+    if (!replay.loadTranscript(transcript)) {
+        err << "Couldn't load " << transcript << Qt::endl;
+        return 2;
+    }
+    replay.placeCursor();
+
+    QList<KeyStroke> strokes;
+    if (parser.isSet("keys")) {
+        strokes = KeyStroke::readLog(parser.value("keys"));
+        if (strokes.isEmpty()) {
+            err << "No key presses in " << parser.value("keys") << Qt::endl;
+            return 2;
+        }
+    }
+    else {
+        strokes = KeyReplay::syntheticStream(syntheticVocabulary(replay.language()),
+                                             parser.value("events").toInt(), parser.value("seed").toUInt());
+    }
+
+    // Scope statistics show where the time of slow presses goes
+    Profiler::setEnabled(true);
+    auto samples = replay.replay(strokes, parser.value("warmup").toInt());
+
+    QMap<QString, QVector<double>> byKind;
+    QVector<double> all;
+    for (auto& sample: std::as_const(samples)) {
+        byKind[sample.kind].append(sample.ms);
+        all.append(sample.ms);
+    }
+    auto overall = distribution(all);
+
+    out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg("kind", -12).arg("count", 7).arg("mean", 9).arg("p50", 9)
+               .arg("p90", 9).arg("p99", 9).arg("max", 9);
+    auto printRow = [&out](const QString& kind, const Distribution& d) {
+        out << QString("%1 %2 %3 %4 %5 %6 %7\n").arg(kind, -12).arg(d.count, 7).arg(d.meanMs, 9, 'f', 3)
+                   .arg(d.p50Ms, 9, 'f', 3).arg(d.p90Ms, 9, 'f', 3).arg(d.p99Ms, 9, 'f', 3).arg(d.maxMs, 9, 'f', 3);
+    };
+
+    QJsonObject kinds;
+    for (auto it = byKind.cbegin(); it != byKind.cend(); ++it) {
+        auto d = distribution(it.value());
+        printRow(it.key(), d);
+        kinds.insert(it.key(), d.toJson());
+    }
+    printRow("all", overall);
+    if (replay.skipped())
+        out << replay.skipped() << " dialog shortcuts skipped\n";
+
+    bool withinBudget = overall.p99Ms <= budget;
+    out << QString("p99 %1 ms, budget %2 ms: %3\n").arg(overall.p99Ms, 0, 'f', 3).arg(budget)
+               .arg(withinBudget ? "PASS" : "FAIL");
+
+    if (parser.isSet("json")) {
+        QJsonObject report{
+            {"transcript", parser.isSet("transcript") ? transcript : QString("synthetic")},
+            {"blocks", replay.blockCount()},
+            {"budget", budget},
+            {"pass", withinBudget},
+            {"all", overall.toJson()},
+            {"kinds", kinds},
+            {"scopes", Profiler::toJson()}
+        };
+        QFile json(parser.value("json"));
+        if (json.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            json.write(QJsonDocument(report).toJson());
+        else
+            err << "Couldn't write " << parser.value("json") << Qt::endl;
+    }
+
+    return withinBudget ? 0 : 1;
+}
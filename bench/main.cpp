@@ -0,0 +1,81 @@
+#include "editorbench.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QTest>
+
+// Converts the rows of QTest's csv benchmark log into a JSON report that can be
+// compared between releases:
+//   "function","tag","metric",value per iteration,total,iterations
+static bool writeJsonReport(const QString& csvPath, const QString& jsonPath)
+{
+    QFile csv(csvPath);
+    if (!csv.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    static const QRegularExpression row(R"(^"([^"]*)","([^"]*)","([^"]*)",([^,]+),([^,]+),(\d+)$)");
+
+    QJsonArray results;
+    while (!csv.atEnd()) {
+        auto match = row.match(QString::fromUtf8(csv.readLine()).trimmed());
+        if (!match.hasMatch())
+            continue;
+
+        results.append(QJsonObject{
+            {"benchmark", match.captured(1)},
+            {"tag", match.captured(2)},
+            {"metric", match.captured(3)},
+            {"value", match.captured(4).toDouble()},
+            {"total", match.captured(5).toDouble()},
+            {"iterations", match.captured(6).toInt()}
+        });
+    }
+
+    QJsonObject report{
+        {"application", "Vagyojaka"},
+        {"version", VAGYOJAKA_VERSION},
+        {"qt", qVersion()},
+        {"date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"results", results}
+    };
+
+    QFile json(jsonPath);
+    if (!json.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    json.write(QJsonDocument(report).toJson());
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    app.setApplicationName("Vagyojaka");
+    app.setOrganizationName("IIT Bombay");
+
+    // "--json <file>" picks the report path, everything else goes to QTest
+    // (e.g. "setContent:hindi/10000" or "-iterations 5")
+    auto arguments = app.arguments();
+    QString jsonPath = "vagyojaka-bench.json";
+    int jsonArgument = arguments.indexOf("--json");
+    if (jsonArgument != -1 && jsonArgument + 1 < arguments.size()) {
+        jsonPath = arguments[jsonArgument + 1];
+        arguments.remove(jsonArgument, 2);
+    }
+
+    auto csvPath = jsonPath + ".csv";
+    arguments << "-o" << csvPath + ",csv" << "-o" << "-,txt";
+
+    EditorBenchmark benchmark;
+    int result = QTest::qExec(&benchmark, arguments);
+
+    if (!writeJsonReport(csvPath, jsonPath))
+        qWarning() << "Couldn't write benchmark report to" << jsonPath;
+    QFile::remove(csvPath);
+
+    return result;
+}
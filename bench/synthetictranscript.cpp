@@ -0,0 +1,66 @@
+#include "synthetictranscript.h"
+
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTime>
+#include <QXmlStreamWriter>
+
+QStringList syntheticVocabulary(const QString& language)
+{
+    QStringList words;
+    QFile file(QString(":/wordlists/%1.txt").arg(language));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return words;
+
+    while (!file.atEnd()) {
+        auto trimmed = QString::fromUtf8(file.readLine()).trimmed();
+        if (!trimmed.isEmpty() && trimmed.front().isLetter())
+            words.append(trimmed);
+    }
+    return words;
+}
+
+QByteArray syntheticTranscript(const QString& language, int blocks)
+{
+    QRandomGenerator random(0x5eed);
+    auto words = syntheticVocabulary(language);
+    if (words.isEmpty())
+        words.append("word");
+
+    // QTime wraps at midnight, so long transcripts get shorter lines
+    const int blockSpan = qMin(5000, 80000000 / blocks);
+
+    QByteArray data;
+    QXmlStreamWriter writer(&data);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("transcript");
+    writer.writeAttribute("lang", language);
+
+    for (int i = 0; i < blocks; i++) {
+        auto blockTime = QTime(0, 0).addMSecs(i * blockSpan);
+        int wordCount = random.bounded(6, 19);
+
+        writer.writeStartElement("line");
+        writer.writeAttribute("timestamp", blockTime.toString("hh:mm:ss.zzz"));
+        writer.writeAttribute("speaker", QString("Speaker_%1").arg(i % 4 + 1));
+
+        for (int j = 0; j < wordCount; j++) {
+            auto text = words[random.bounded(int(words.size()))];
+            // About one word in ten is out of vocabulary
+            if (random.bounded(10) == 0)
+                text += text.back();
+
+            writer.writeStartElement("word");
+            writer.writeAttribute("timestamp", blockTime.addMSecs((j + 1) * blockSpan / wordCount).toString("hh:mm:ss.zzz"));
+            writer.writeAttribute("isEdited", "false");
+            writer.writeCharacters(text);
+            writer.writeEndElement();
+        }
+        writer.writeEndElement();
+    }
+
+    writer.writeEndElement();
+    writer.writeEndDocument();
+    return data;
+}
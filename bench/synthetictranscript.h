@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Words from the bundled word list of a language, without punctuation and blank entries.
+ */
+QStringList syntheticVocabulary(const QString& language);
+
+/**
+ * @brief Generates a transcript XML of \a blocks timed lines in \a language.
+ *
+ * Words are drawn from the bundled word list with a fixed seed, about one in ten
+ * made out of vocabulary, so the same arguments always give the same transcript.
+ */
+QByteArray syntheticTranscript(const QString& language, int blocks);
@@ -0,0 +1,176 @@
+#include "transcriptbatch.h"
+#include "editor/utilities/corpusstatistics.h"
+#include "editor/utilities/transcriptexporter.h"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QThreadPool>
+#include <QTextStream>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <functional>
+
+// Ranks the words the dictionaries don't know over all files together
+static int runVocabulary(const QCommandLineParser& parser, const QStringList& files, QTextStream& out, QTextStream& err)
+{
+    auto table = CorpusStatistics::count(files, parser.value("language")).result();
+    auto entries = CorpusStatistics::rank(table);
+    qint64 minimumCount = qMax(1LL, parser.value("min-count").toLongLong());
+
+    QJsonArray report;
+    int listed{0};
+    int top = parser.value("top").toInt();
+    for (auto& entry: std::as_const(entries)) {
+        if (entry.known)
+            continue;
+        if (entry.occurrences < minimumCount || listed >= top)
+            break;
+
+        out << entry.occurrences << '\t' << entry.files << '\t' << entry.language << '\t' << entry.word << '\n';
+        report.append(QJsonObject{{"word", entry.word}, {"language", entry.language},
+                                  {"count", entry.occurrences}, {"files", entry.files}});
+        listed++;
+    }
+    out << QString("%1 files (%2 unreadable), %3 words, %4 distinct\n")
+               .arg(table.files).arg(table.failedFiles).arg(table.tokens).arg(entries.size());
+
+    if (parser.isSet("word-list") && !CorpusStatistics::writeWordList(entries, parser.value("word-list"), minimumCount)) {
+        err << "Couldn't write " << parser.value("word-list") << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet("json")) {
+        QFile json(parser.value("json"));
+        if (!json.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err << "Couldn't write " << parser.value("json") << Qt::endl;
+            return 1;
+        }
+        json.write(QJsonDocument(report).toJson());
+    }
+
+    return table.failedFiles ? 1 : 0;
+}
+
+// Batch processing of transcripts without the editor window, e.g. for nightly QA:
+//   vagyojaka-cli validate --recursive transcripts/
+//   vagyojaka-cli spell --json spelling.json transcripts/
+//   vagyojaka-cli vocabulary --min-count 5 --word-list unknown.txt transcripts/
+//   vagyojaka-cli normalize --offset -250 --output normalized/ transcripts/
+//   vagyojaka-cli export --format pdf --output pdf/ transcripts/
+//   vagyojaka-cli export --format ctm --output scoring/ transcripts/
+// Prints one line per file (per unknown word for vocabulary) and exits with 1 if any file failed.
+int main(int argc, char *argv[])
+{
+    // PDF export lays out text, which needs a GUI application but no display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName("Vagyojaka");
+    app.setOrganizationName("IIT Bombay");
+
+    auto exportFormats = TranscriptExporter::formats() << "pdf";
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Validates, spell checks, normalizes and exports Vagyojaka transcripts");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "validate, spell, vocabulary, normalize or export");
+    parser.addPositionalArgument("paths", "Transcript files or directories of them.", "paths...");
+    parser.addOptions({
+        {{"r", "recursive"}, "Search directories recursively."},
+        {{"j", "jobs"}, "Files processed in parallel, all cores by default.", "count"},
+        {{"o", "output"}, "Directory for normalized and exported files, next to the input by default.", "directory"},
+        {{"f", "format"}, "Export format: " + exportFormats.join(", ") + ".", "format", "txt"},
+        {"no-timestamps", "Leave line timestamps out of PDF exports."},
+        {"language", "Dictionary for spell checks instead of the transcript's language.", "language"},
+        {"offset", "Milliseconds to shift every timestamp by when normalizing.", "ms", "0"},
+        {"in-place", "Let normalize overwrite its input."},
+        {"top", "Unknown words listed by vocabulary.", "count", "100"},
+        {"min-count", "Leave out unknown words seen fewer times.", "count", "1"},
+        {"word-list", "Write the unknown words, one per line, for use as a custom dictionary.", "file"},
+        {"json", "Also write the per file results as JSON.", "file"},
+    });
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    auto positional = parser.positionalArguments();
+    auto command = positional.isEmpty() ? QString() : positional.takeFirst();
+    TranscriptBatch::Options options;
+    bool vocabulary = command == "vocabulary";
+    if (positional.isEmpty() || (!vocabulary && !TranscriptBatch::commandFromString(command, options.command))) {
+        err << parser.helpText();
+        return 2;
+    }
+
+    options.outputDirectory = parser.value("output");
+    options.inputRoots = positional;
+    options.format = parser.value("format");
+    options.language = parser.value("language");
+    options.offsetMs = parser.value("offset").toLongLong();
+    options.inPlace = parser.isSet("in-place");
+    options.withTimeStamps = !parser.isSet("no-timestamps");
+
+    // Formats are matched case insensitively but written with their own suffix ("TextGrid")
+    auto format = std::find_if(exportFormats.cbegin(), exportFormats.cend(), [&](const QString& name) {
+        return name.compare(options.format, Qt::CaseInsensitive) == 0;
+    });
+    if (format == exportFormats.cend()) {
+        err << "Unknown export format " << options.format << Qt::endl;
+        return 2;
+    }
+    options.format = *format;
+
+    auto files = TranscriptBatch::collectFiles(positional, parser.isSet("recursive"));
+    if (files.isEmpty()) {
+        err << "No transcripts found" << Qt::endl;
+        return 2;
+    }
+
+    if (parser.isSet("jobs"))
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, parser.value("jobs").toInt()));
+
+    if (vocabulary)
+        return runVocabulary(parser, files, out, err);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    TranscriptBatch batch(options);
+    batch.planOutputs(files);
+    std::function<TranscriptBatch::FileResult(const QString&)> process = [&batch](const QString& fileName) {
+        return batch.process(fileName);
+    };
+    auto results = QtConcurrent::blockingMapped<QList<TranscriptBatch::FileResult>>(files, process);
+
+    int failed{0};
+    QJsonArray report;
+    for (auto& result: std::as_const(results)) {
+        if (!result.ok)
+            failed++;
+        out << (result.ok ? "ok" : "FAIL") << '\t' << result.fileName << '\t' << result.summary << '\n';
+
+        auto details = result.details;
+        details.insert("file", result.fileName);
+        details.insert("ok", result.ok);
+        report.append(details);
+    }
+    out << QString("%1 files, %2 failed, %3 s on %4 threads\n").arg(files.size()).arg(failed)
+               .arg(timer.elapsed() / 1000.0, 0, 'f', 2).arg(QThreadPool::globalInstance()->maxThreadCount());
+
+    if (parser.isSet("json")) {
+        QFile json(parser.value("json"));
+        if (json.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            json.write(QJsonDocument(report).toJson());
+        else
+            err << "Couldn't write " << parser.value("json") << Qt::endl;
+    }
+
+    return failed ? 1 : 0;
+}
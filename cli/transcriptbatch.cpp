@@ -0,0 +1,296 @@
+#include "transcriptbatch.h"
+
+#include "editor/utilities/pdfexporter.h"
+#include "editor/utilities/transcriptexporter.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+TranscriptBatch::TranscriptBatch(const Options& options)
+    : m_options(options)
+{
+}
+
+bool TranscriptBatch::commandFromString(const QString& name, Command& command)
+{
+    static const QHash<QString, Command> commands = {
+        {"validate", Validate}, {"spell", Spell}, {"normalize", Normalize}, {"export", Export}
+    };
+    if (!commands.contains(name))
+        return false;
+
+    command = commands.value(name);
+    return true;
+}
+
+QStringList TranscriptBatch::collectFiles(const QStringList& paths, bool recursive)
+{
+    QStringList files;
+    for (auto& path: paths) {
+        QFileInfo info(path);
+        if (info.isFile()) {
+            files.append(info.filePath());
+            continue;
+        }
+        if (!info.isDir())
+            continue;
+
+        QDirIterator it(path, {"*.xml"}, QDir::Files,
+                        recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+        while (it.hasNext())
+            files.append(it.next());
+    }
+    files.sort();
+    return files;
+}
+
+void TranscriptBatch::planOutputs(const QStringList& fileNames)
+{
+    m_outputCount.clear();
+    if (m_options.command != Normalize && m_options.command != Export)
+        return;
+
+    auto suffix = m_options.command == Normalize ? QString("xml") : m_options.format;
+    for (auto& fileName: fileNames)
+        m_outputCount[QFileInfo(outputPath(fileName, suffix)).absoluteFilePath()]++;
+}
+
+TranscriptBatch::FileResult TranscriptBatch::process(const QString& fileName)
+{
+    FileResult result;
+    result.fileName = fileName;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.ok = false;
+        result.summary = file.errorString();
+        result.details.insert("error", result.summary);
+        return result;
+    }
+
+    Transcript transcript;
+    QString error;
+    if (!TranscriptIO::readXml(&file, transcript, &error)) {
+        result.ok = false;
+        result.summary = error;
+        result.details.insert("error", error);
+        return result;
+    }
+    file.close();
+
+    result.details.insert("language", transcript.language);
+    result.details.insert("lines", transcript.blocks.size());
+
+    switch (m_options.command) {
+    case Validate:
+        validate(transcript, result);
+        break;
+    case Spell:
+        spell(transcript, result);
+        break;
+    case Normalize:
+    case Export: {
+        auto target = outputPath(fileName, m_options.command == Normalize ? QString("xml") : m_options.format);
+        if (QFileInfo(target) == QFileInfo(fileName) && !m_options.inPlace) {
+            result.ok = false;
+            result.summary = "output would overwrite the input, use --output or --in-place";
+            result.details.insert("error", result.summary);
+            break;
+        }
+        // Files are processed concurrently, the last one renamed into place would silently win
+        if (m_outputCount.value(QFileInfo(target).absoluteFilePath()) > 1) {
+            result.ok = false;
+            result.summary = "another input writes " + target + " too";
+            result.details.insert("error", result.summary);
+            break;
+        }
+        if (!QDir().mkpath(QFileInfo(target).absolutePath())) {
+            result.ok = false;
+            result.summary = "couldn't create " + QFileInfo(target).absolutePath();
+            result.details.insert("error", result.summary);
+            break;
+        }
+        if (m_options.command == Normalize)
+            normalize(transcript, result);
+        exportTo(transcript, target, result);
+        break;
+    }
+    }
+
+    return result;
+}
+
+void TranscriptBatch::validate(const Transcript& transcript, FileResult& result) const
+{
+    int untimedLines{0}, backwardLines{0}, emptyLines{0}, lateWords{0};
+    QTime previous;
+
+    for (auto& a_block: transcript.blocks) {
+        if (a_block.text.isEmpty())
+            emptyLines++;
+
+        if (!a_block.timeStamp.isValid()) {
+            untimedLines++;
+            continue;
+        }
+        if (previous.isValid() && a_block.timeStamp < previous)
+            backwardLines++;
+        previous = a_block.timeStamp;
+
+        // A line's timestamp is where it ends
+        for (auto& a_word: a_block.words)
+            if (a_word.timeStamp.isValid() && a_word.timeStamp > a_block.timeStamp)
+                lateWords++;
+    }
+
+    result.details.insert("untimedLines", untimedLines);
+    result.details.insert("backwardLines", backwardLines);
+    result.details.insert("emptyLines", emptyLines);
+    result.details.insert("wordsAfterLineEnd", lateWords);
+    result.details.insert("missingLanguage", transcript.language.isEmpty());
+
+    // Timing problems break playback, the rest are only reported
+    result.ok = untimedLines == 0 && backwardLines == 0;
+    result.summary = QString("%1 lines, %2 untimed, %3 backwards, %4 empty, %5 words after line end%6")
+                         .arg(transcript.blocks.size()).arg(untimedLines).arg(backwardLines)
+                         .arg(emptyLines).arg(lateWords)
+                         .arg(transcript.language.isEmpty() ? ", no language" : "");
+}
+
+void TranscriptBatch::spell(const Transcript& transcript, FileResult& result)
+{
+    auto language = !m_options.language.isEmpty() ? m_options.language
+                    : !transcript.language.isEmpty() ? transcript.language : QString("english");
+    auto& words = dictionary(language);
+    if (words.isEmpty()) {
+        result.ok = false;
+        result.summary = "no dictionary for " + language;
+        result.details.insert("error", result.summary);
+        return;
+    }
+
+    int total{0}, unknown{0};
+    for (auto& a_block: transcript.blocks) {
+        // Lines the editor doesn't check, untimed or tagged as a whole, aren't counted either
+        if (!a_block.timeStamp.isValid() || !a_block.tagList.isEmpty())
+            continue;
+
+        for (auto& a_word: a_block.words) {
+            if (a_word.text.isEmpty())
+                continue;
+            total++;
+            if (!words.isKnown(a_word.text))
+                unknown++;
+        }
+    }
+
+    double rate = total ? 100.0 * unknown / total : 0;
+    result.details.insert("dictionary", language);
+    result.details.insert("words", total);
+    result.details.insert("unknownWords", unknown);
+    result.details.insert("unknownPercent", rate);
+    result.summary = QString("%1 words, %2 unknown (%3%)").arg(total).arg(unknown).arg(rate, 0, 'f', 2);
+}
+
+void TranscriptBatch::normalize(Transcript& transcript, FileResult& result) const
+{
+    auto shifted = [offset = m_options.offsetMs](const QTime& time) {
+        if (!time.isValid() || offset == 0)
+            return time;
+        return QTime::fromMSecsSinceStartOfDay(int(qBound<qint64>(0, time.msecsSinceStartOfDay() + offset, 86399999)));
+    };
+
+    int filled{0}, raised{0};
+    QTime previous(0, 0);
+    for (auto& a_block: transcript.blocks) {
+        a_block.timeStamp = shifted(a_block.timeStamp);
+        for (auto& a_word: a_block.words)
+            a_word.timeStamp = shifted(a_word.timeStamp);
+
+        // An untimed line ends with its last timed word, or where the previous line ended
+        if (!a_block.timeStamp.isValid()) {
+            a_block.timeStamp = previous;
+            for (auto& a_word: a_block.words)
+                if (a_word.timeStamp.isValid() && a_word.timeStamp > a_block.timeStamp)
+                    a_block.timeStamp = a_word.timeStamp;
+            filled++;
+        }
+        else if (a_block.timeStamp < previous) {
+            a_block.timeStamp = previous;
+            raised++;
+        }
+        previous = a_block.timeStamp;
+    }
+
+    result.details.insert("filledLines", filled);
+    result.details.insert("raisedLines", raised);
+    result.details.insert("offsetMs", m_options.offsetMs);
+    result.summary = QString("%1 untimed lines filled, %2 backward lines raised").arg(filled).arg(raised);
+}
+
+void TranscriptBatch::exportTo(const Transcript& transcript, const QString& fileName, FileResult& result) const
+{
+    auto format = m_options.command == Normalize ? QString("xml") : m_options.format;
+    bool written = false;
+
+    if (format == "pdf") {
+        PdfExporter::Options pdfOptions;
+        pdfOptions.title = QFileInfo(result.fileName).fileName();
+        pdfOptions.withTimeStamps = m_options.withTimeStamps;
+        written = PdfExporter::write(transcript.blocks, fileName, pdfOptions);
+    }
+    else {
+        QString error;
+        written = TranscriptExporter::exportFile(transcript, format, fileName, &error);
+        if (!written)
+            result.details.insert("error", error);
+    }
+
+    result.details.insert("output", fileName);
+    if (!written) {
+        result.ok = false;
+        result.summary = "couldn't write " + fileName;
+        if (!result.details.contains("error"))
+            result.details.insert("error", result.summary);
+    }
+    else if (m_options.command == Export) {
+        result.summary = "wrote " + fileName;
+    }
+}
+
+QString TranscriptBatch::outputPath(const QString& fileName, const QString& suffix) const
+{
+    QFileInfo info(fileName);
+    if (m_options.outputDirectory.isEmpty())
+        return info.dir().filePath(info.completeBaseName() + "." + suffix);
+
+    // Files found in a directory keep their path below it, so a/x.xml and b/x.xml stay apart
+    QString relativeDirectory;
+    bool underRoot = false;
+    for (auto& root: m_options.inputRoots) {
+        if (!QFileInfo(root).isDir())
+            continue;
+        auto relative = QDir(root).relativeFilePath(info.absolutePath());
+        if (relative.startsWith("..") || QDir::isAbsolutePath(relative))
+            continue;
+        if (!underRoot || relative.size() < relativeDirectory.size())
+            relativeDirectory = relative;
+        underRoot = true;
+    }
+
+    QDir directory(m_options.outputDirectory);
+    if (!relativeDirectory.isEmpty() && relativeDirectory != ".")
+        directory.setPath(directory.filePath(relativeDirectory));
+    return directory.filePath(info.completeBaseName() + "." + suffix);
+}
+
+const TranscriptDictionary& TranscriptBatch::dictionary(const QString& language)
+{
+    QMutexLocker locker(&m_dictionaryMutex);
+    auto& entry = m_dictionaries[language];
+    if (!entry)
+        entry = std::make_shared<TranscriptDictionary>(language);
+    return *entry;
+}
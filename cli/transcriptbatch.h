@@ -0,0 +1,68 @@
+#pragma once
+
+#include "editor/utilities/transcriptdictionary.h"
+#include "editor/utilities/transcriptio.h"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QStringList>
+
+#include <memory>
+
+/**
+ * @class TranscriptBatch
+ * @brief One vagyojaka-cli command applied to transcript files, one file per call.
+ *
+ * process() only reads the options and the shared dictionaries, so files can be
+ * processed on as many threads as there are cores.
+ */
+class TranscriptBatch
+{
+public:
+    enum Command { Validate, Spell, Normalize, Export };
+
+    struct Options
+    {
+        Command command{Validate};
+        QString outputDirectory;  ///< Empty writes next to the input, otherwise mirrors its path below its input root.
+        QStringList inputRoots;   ///< Files and directories given on the command line.
+        QString format{"txt"};    ///< pdf or one of TranscriptExporter::formats().
+        QString language;         ///< Overrides the transcript language for spell checks.
+        qint64 offsetMs{0};       ///< Shift applied by normalize.
+        bool inPlace{false};      ///< Normalize overwrites its input.
+        bool withTimeStamps{true};
+    };
+
+    struct FileResult
+    {
+        QString fileName;
+        bool ok{true};
+        QString summary;
+        QJsonObject details;
+    };
+
+    explicit TranscriptBatch(const Options& options);
+
+    static bool commandFromString(const QString& name, Command& command);
+    /// Transcript XML files among \a paths, directories are searched for *.xml.
+    static QStringList collectFiles(const QStringList& paths, bool recursive);
+
+    /// Notes the output of every file, so inputs that would write the same file fail instead.
+    void planOutputs(const QStringList& fileNames);
+    FileResult process(const QString& fileName);
+
+private:
+    void validate(const Transcript& transcript, FileResult& result) const;
+    void spell(const Transcript& transcript, FileResult& result);
+    void normalize(Transcript& transcript, FileResult& result) const;
+    void exportTo(const Transcript& transcript, const QString& fileName, FileResult& result) const;
+
+    QString outputPath(const QString& fileName, const QString& suffix) const;
+    const TranscriptDictionary& dictionary(const QString& language);
+
+    Options m_options;
+    QHash<QString, int> m_outputCount; ///< Inputs writing each output, filled by planOutputs().
+    QMutex m_dictionaryMutex;
+    QHash<QString, std::shared_ptr<TranscriptDictionary>> m_dictionaries; ///< Loaded once per language, read only after.
+};
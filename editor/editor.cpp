@@ -1,4 +1,9 @@
 #include "editor.h"
+#include "profiling/profiler.h"
+#include "utilities/pdfexporter.h"
+#include "utilities/transcriptdictionary.h"
+#include "utilities/transcriptexporter.h"
+#include "utilities/transcriptio.h"
 #include <iostream>
 #include <qclipboard.h>
 #include <QJsonDocument>
@@ -16,10 +21,10 @@
 #include <QMessageBox>
 #include <QMenu>
 #include <algorithm>
-#include <QEventLoop>
+#include <numeric>
 #include <QDebug>
 #include <QUndoStack>
-#include <QPrinter>
+#include <QProgressDialog>
 #include <qthreadpool.h>
 // #include "config/settingsmanager.h"
 
@@ -33,12 +38,18 @@ Editor::Editor(QWidget *parent)
 {
     // taskSemaphore.release();
     connect(this->document(), &QTextDocument::contentsChange, this, &Editor::contentChanged);
-    connect(this, &Editor::cursorPositionChanged, this, &Editor::updateWordEditor);
+    connect(this, &Editor::cursorPositionChanged, this,
+            [this]()
+            {
+                // Only switching lines resets the word model, edits refresh it through updateWordEditor
+                if (m_wordEditor && !dontUpdateWordEditor && currentBlockIndex() != m_wordEditor->wordModel()->blockNumber())
+                    updateWordEditor();
+            });
     connect(this, &Editor::cursorPositionChanged, this,
             [&]()
             {
-                if (!m_blocks.isEmpty() && textCursor().blockNumber() < m_blocks.size())
-                    emit refreshTagList(m_blocks[textCursor().blockNumber()].tagList);
+                if (!m_blocks.isEmpty() && currentBlockIndex() < m_blocks.size())
+                    emit refreshTagList(m_blocks[currentBlockIndex()].tagList);
             });
 
     m_textCompleter->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
@@ -54,6 +65,8 @@ Editor::Editor(QWidget *parent)
             this, &Editor::insertTransliterationCompletion);
 
 
+    connect(&m_pdfExport, &QFutureWatcher<bool>::finished, this, &Editor::pdfExportFinished);
+
     connect(m_saveTimer, &QTimer::timeout, this, [this](){
         if (m_autoSave && m_transcriptUrl.isValid())
             transcriptSave();
@@ -74,6 +87,15 @@ Editor::Editor(QWidget *parent)
 
     settings->setValue("showTimeStamps", QVariant(showTimeStamp).toString());
 
+    m_nudgeStep = qMax(1, settings->value("timeNudgeStep", m_nudgeStep).toInt());
+    m_windowSize = qMax(100, settings->value("virtualWindowSize", m_windowSize).toInt());
+    m_windowMargin = qMin(m_windowMargin, m_windowSize / 4);
+    m_transcriptScrollBar = new QScrollBar(Qt::Vertical, this);
+    m_transcriptScrollBar->hide();
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &Editor::onViewportScrolled);
+    connect(m_transcriptScrollBar, &QScrollBar::valueChanged, this, &Editor::onTranscriptScrolled);
+    setVirtualizedView(settings->value("virtualizedView").toString() == "true");
+
     // auto& settings = SettingsManager::getInstance();
     // showTimeStamp = settings.getShowTimeStamps();
 
@@ -119,6 +141,7 @@ void Editor::setMoveAlongTimeStamps()
 // Current Edit
 void Highlighter::highlightBlock(const QString& text)
 {
+    PROFILE_SCOPE("Highlighter::highlightBlock");
     if (invalidBlockNumbers.contains(currentBlock().blockNumber())) {
         QTextCharFormat format;
         format.setForeground(Qt::red);
@@ -428,7 +451,7 @@ void Editor::keyPressEvent(QKeyEvent *event)
         int wordNumber = 0;
 
         if ((containsSpeakerBraces && textTillCursor.count(" ") > 0) || !containsSpeakerBraces) {
-            if (m_blocks.size() > textCursor().blockNumber() &&
+            if (m_blocks.size() > currentBlockIndex() &&
                 !(containsTimeStamp && textTillCursor.count(" ") == blockText.count(" "))) {
                 isAWordUnderCursor = true;
 
@@ -441,11 +464,11 @@ void Editor::keyPressEvent(QKeyEvent *event)
             }
         }
 
-        markWordAsCorrect(textCursor().blockNumber(), wordNumber);
+        markWordAsCorrect(currentBlockIndex(), wordNumber);
     }
     else if (event->modifiers() == Qt::ControlModifier && event->key() == Qt::Key_I){
         // qInfo()<<"doubtful"; // Disabled debug
-        int blocknumber = textCursor().blockNumber();
+        int blocknumber = currentBlockIndex();
         int wordNumber = textCursor().block().text().left(textCursor().positionInBlock()).trimmed().count(" ");
         // qInfo()<<blocknumber; // Disabled debug
         // qInfo()<<wordNumber; // Disabled debug
@@ -461,9 +484,9 @@ void Editor::keyPressEvent(QKeyEvent *event)
         //     qInfo()<<"marked";
         // }
 
-        QTextBlock block = document()->findBlockByNumber(blocknumber);
-        QTextCursor cursor(document()->findBlockByNumber(blocknumber));
         setContent();
+        QTextBlock block = textBlockAt(blocknumber);
+        QTextCursor cursor(block);
 
         cursor.setPosition(block.position());
         cursor.movePosition(QTextCursor::NextWord, QTextCursor::MoveAnchor, wordNumber - 1);
@@ -497,6 +520,9 @@ void Editor::keyPressEvent(QKeyEvent *event)
         }
     }
 
+    // Edits parse the line back, it has to show its time first
+    if (m_timeOffsets.hasPending() && !event->text().isEmpty())
+        flushTimeOffsets();
     TextEditor::keyPressEvent(event);
 
     QString blockText = textCursor().block().text();
@@ -547,7 +573,7 @@ void Editor::keyPressEvent(QKeyEvent *event)
             int wordNumber = 0;
 
             if ((containsSpeakerBraces && textTillCursor.count(" ") > 0) || !containsSpeakerBraces) {
-                if (m_blocks.size() > textCursor().blockNumber() &&
+                if (m_blocks.size() > currentBlockIndex() &&
                     !(containsTimeStamp && textTillCursor.count(" ") == blockText.count(" "))) {
                     isAWordUnderCursor = true;
 
@@ -559,9 +585,9 @@ void Editor::keyPressEvent(QKeyEvent *event)
                         wordNumber = textTillCursor.trimmed().count(" ");
                 }
             }
-            if(m_blocks[textCursor().block().blockNumber()].words[wordNumber].text.size()>2){
-                QString text = m_blocks[textCursor().blockNumber()].words[wordNumber].text.toLower();
-                QString text2 = m_blocks[textCursor().blockNumber()].words[wordNumber].text;
+            if(m_blocks[currentBlockIndex()].words[wordNumber].text.size()>2){
+                QString text = m_blocks[currentBlockIndex()].words[wordNumber].text.toLower();
+                QString text2 = m_blocks[currentBlockIndex()].words[wordNumber].text;
                 text=text.trimmed();
                 text2=text.trimmed();
                 //            qInfo()<<text;
@@ -601,7 +627,7 @@ void Editor::keyPressEvent(QKeyEvent *event)
             }
         }
         if(showTimeStamp)
-            if (m_blocks[textCursor().blockNumber()].timeStamp.isValid()
+            if (m_blocks[currentBlockIndex()].timeStamp.isValid()
                 && textTillCursor.count(" ") == blockText.count(" "))
                 return;
 
@@ -630,25 +656,13 @@ void Editor::keyPressEvent(QKeyEvent *event)
         return;
 
     if (m_completer == m_transliterationCompleter) {
-        QTimer replyTimer;
-        replyTimer.setSingleShot(true);
-        QEventLoop loop;
-        connect(this, &Editor::replyCame, &loop, &QEventLoop::quit);
-        connect(&replyTimer, &QTimer::timeout, &loop,
-                [&]() {
-                    emit message("Reply Timeout, Network Connection is slow or inaccessible", 2000);
-                    loop.quit();
-                });
-
-        sendRequest(completionPrefix, m_transliterateLangCode);
-        replyTimer.start(1000);
-        loop.exec();
-
-        dynamic_cast<QStringListModel*>(m_completer->model())->setStringList(m_lastReplyList);
+        // Cached suggestions come back immediately, the rest through showTransliterationSuggestions
+        if (m_transliterator)
+            m_transliterator->request(completionPrefix, m_transliterateLangCode);
+        return;
     }
 
-
-    if (m_completer != m_transliterationCompleter && completionPrefix != m_completer->completionPrefix()) {
+    if (completionPrefix != m_completer->completionPrefix()) {
         m_completer->setCompletionPrefix(completionPrefix);
     }
     m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
@@ -672,7 +686,7 @@ void Editor::contextMenuEvent(QContextMenuEvent *event)
     int wordNumber = 0;
 
     if ((containsSpeakerBraces && textTillCursor.count(" ") > 0) || !containsSpeakerBraces) {
-        if (m_blocks.size() > textCursor().blockNumber() &&
+        if (m_blocks.size() > currentBlockIndex() &&
             !(containsTimeStamp && textTillCursor.count(" ") == blockText.count(" "))) {
             isAWordUnderCursor = true;
 
@@ -694,12 +708,12 @@ void Editor::contextMenuEvent(QContextMenuEvent *event)
         connect(markAsCorrectAction, &QAction::triggered, this,
                 [this, wordNumber]()
                 {
-                    markWordAsCorrect(textCursor().blockNumber(), wordNumber);
+                    markWordAsCorrect(currentBlockIndex(), wordNumber);
                 });
         menu->addAction(markAsCorrectAction);
         //added suggestions
-        QString text = m_blocks[textCursor().blockNumber()].words[wordNumber].text.toLower();
-        QString text2 = m_blocks[textCursor().blockNumber()].words[wordNumber].text;
+        QString text = m_blocks[currentBlockIndex()].words[wordNumber].text.toLower();
+        QString text2 = m_blocks[currentBlockIndex()].words[wordNumber].text;
         text=text.trimmed();
         text2=text.trimmed();
         //        qInfo()<<text;
@@ -876,6 +890,7 @@ void Editor::transcriptSave()
                                + " "+repDictFileInfo.absoluteFilePath().replace(" ", "\\ ").toStdString();
 
     if(!realTimeDataSaver){
+        PROFILE_SCOPE("script: alignment.py");
         result = system(alignmentstr.c_str());
     }
     // qInfo()<<result; // Disabled debug
@@ -928,6 +943,7 @@ void Editor::transcriptClose()
     emit message("Closing file " + m_transcriptUrl.toLocalFile());
     m_transcriptUrl.clear();
     m_blocks.clear();
+    m_windowStart = 0;
     m_transcriptLang = "english";
 
     loadDictionary();
@@ -946,24 +962,28 @@ void Editor::showBlocksFromData()
 
 void Editor::highlightTranscript(const QTime& elapsedTime)
 {
+    PROFILE_SCOPE("Editor::highlightTranscript");
     int blockToHighlight = -1;
     int wordToHighlight = -1;
 
     if (!m_blocks.isEmpty()) {
-
+        // Pending shifts are summed on the way, this runs on every player tick
+        bool pending = m_timeOffsets.hasPending() && m_timeOffsets.size() == m_blocks.size();
+        qint64 offset = 0;
         for (int i=0; i < m_blocks.size(); i++) {
-
-            if(m_blocks[i].timeStamp.isValid()){if (m_blocks[i].timeStamp > elapsedTime) {
-
-
-                    QTextBlock tb = this->document()->findBlockByNumber(i);//block number
-                    QString s = tb.text();
-                    blockToHighlight=tb.blockNumber();
-                    break;
-                }}
-
+            if (pending)
+                offset += m_timeOffsets.differenceAt(i);
+            auto timeStamp = m_blocks[i].timeStamp;
+            if (offset)
+                timeStamp = (timeStamp.isNull() ? QTime(0, 0) : timeStamp).addMSecs(int(offset));
+
+            if (timeStamp.isValid() && timeStamp > elapsedTime) {
+                blockToHighlight = i;
+                break;
+            }
         }
-
+        if (blockToHighlight != -1)
+            materializeBlockTime(blockToHighlight);
     }
     //qInfo()<<blockToHighlight;
     if (blockToHighlight != highlightedBlock ) {
@@ -971,13 +991,13 @@ void Editor::highlightTranscript(const QTime& elapsedTime)
         if (!m_highlighter)
             m_highlighter = new Highlighter(document());
 
-        m_highlighter->setBlockToHighlight(blockToHighlight);
-
-        if(moveAlongTimeStamps){
-            QTextCursor cursor(this->document()->findBlockByNumber(blockToHighlight));
+        if(moveAlongTimeStamps && blockToHighlight != -1){
+            QTextCursor cursor(textBlockAt(blockToHighlight));
             this->setTextCursor(cursor);
         }
 
+        m_highlighter->setBlockToHighlight(blockToHighlight == -1 ? -1 : blockToHighlight - m_windowStart);
+
 
         if (blockToHighlight == -1)
             return;
@@ -1005,27 +1025,25 @@ void Editor::addCustomDictonary()
 {
     QString temp=QFileDialog::getOpenFileName(this,"Open Custom Dictonary",QString("/"),"Text Files (*txt)");
     if(temp.isEmpty()) return;
-    m_customDictonaryPath=temp;
-    QFile file(m_customDictonaryPath);
+    useCustomDictonary(temp);
+}
+
+void Editor::useCustomDictonary(const QString& fileName)
+{
+    QFile file(fileName);
     if(!file.open(QIODevice::ReadOnly)){
         qDebug() << "From addCustomDictonary - 1";
         QMessageBox::critical(this,"Error",file.errorString());
         return;
     }
+    m_customDictonaryPath=fileName;
 
     loadDictionary();
 }
 
 QTime Editor::getTime(const QString& text)
 {
-    if (text.contains(".")) {
-        if (text.count(":") == 2) return QTime::fromString(text, "h:m:s.z");
-        return QTime::fromString(text, "m:s.z");
-    }
-    else {
-        if (text.count(":") == 2) return QTime::fromString(text, "h:m:s");
-        return QTime::fromString(text, "m:s");
-    }
+    return TranscriptIO::parseTime(text);
 }
 
 word Editor::makeWord(const QTime& t, const QString& s, const QStringList& tagList, const QString& isEdited)
@@ -1141,150 +1159,29 @@ block Editor::fromEditor(qint64 blockNumber) const
 
 void Editor::loadTranscriptData(QFile& file)
 {
+    PROFILE_SCOPE("Editor::loadTranscriptData");
     // qInfo()<<moveAlongTimeStamps; // Disabled debug
-    QXmlStreamReader reader(&file);
-    m_transcriptLang = "";
-    m_blocks.clear();
-    if (reader.readNextStartElement()) {
-        //Qt6
-        // if (reader.name() == "transcript") {
-        if (reader.name() == QString("transcript")) {
-            m_transcriptLang = reader.attributes().value("lang").toString();
-
-            while(reader.readNextStartElement()) {
-                //Qt6
-                // if(reader.name() == "line") {
-                if(reader.name() == QString("line")) {
-                    QString t1=reader.attributes().value("timestamp").toString();
-                    QStringList tl=t1.split(":");
-                    auto blockTimeStamp = getTime(reader.attributes().value("timestamp").toString());
-
-                    if(!blockTimeStamp.isValid()){
-                        QString t2="";
-                        if(t1.count(":")==1){
-                            int hr=tl[0].toInt()/60;
-                            if(hr<10){
-                                t2+="0";
-                                t2+=QString::number(hr);
-                            }
-                            else
-                                t2+=QString::number(hr);
-
-                            t2+=":";
-                            t2+=QString::number(tl[0].toInt()%60);
-                            t2+=":";
-                            t2+=tl[1];
-                            blockTimeStamp=getTime(t2);
-                        }
-                        else if(t1.count(":")==2){
-                            int hr=(tl[1].toInt()/60)+tl[0].toInt();
-
-                            if(hr<10){
-                                t2+="0";
-                                t2+=QString::number(hr);
-                            }
-                            else
-                                t2+=QString::number(hr);
-
-                            t2+=":";
-                            t2+=QString::number(tl[1].toInt()%60);
-                            t2+=":";
-                            t2+=tl[2];
-                            blockTimeStamp=getTime(t2);
-                        }
-                    }
-
-                    auto blockText = QString("");
-                    auto blockSpeaker = reader.attributes().value("speaker").toString();
-                    auto tagString = reader.attributes().value("tags").toString();
-                    QStringList tagList;
-                    if (tagString != "")
-                        tagList = tagString.split(",");
-
-                    struct block line = {blockTimeStamp, "", blockSpeaker, tagList, QVector<word>()};
-                    while(reader.readNextStartElement()){
-                        //Qt6
-                        // if(reader.name() == "word")
-                        if(reader.name() == QString("word")){
-                            QString isEditedStr = reader.attributes().value("isEdited").toString();
-                            auto wordTimeStamp  = getTime(reader.attributes().value("timestamp").toString());
-                            auto wordTagString  = reader.attributes().value("tags").toString();
-                            auto wordText       = reader.readElementText();
-                            QStringList wordTagList;
-                            if (wordTagString != "")
-                                wordTagList = wordTagString.split(",");
-
-                            blockText += (wordText + " ");
-                            line.words.append(makeWord(wordTimeStamp, wordText, wordTagList, isEditedStr.toLower()));
-                        }
-                        else
-                            reader.skipCurrentElement();
-                    }
-                    line.text = blockText.trimmed();
-                    m_blocks.append(line);
-                }
-                else
-                    reader.skipCurrentElement();
-            }
-        }
-        else
-            reader.raiseError(QObject::tr("Incorrect file"));
-    }
+    Transcript transcript;
+    TranscriptIO::readXml(&file, transcript);
+    m_transcriptLang = transcript.language;
+    m_blocks = std::move(transcript.blocks);
+    m_windowStart = 0;
 }
 
 void Editor::saveXml(QFile* file)
 {
-    QXmlStreamWriter writer(file);
-    writer.setAutoFormatting(true);
-    writer.writeStartDocument();
-    writer.writeStartElement("transcript");
-
-    if (m_transcriptLang != "")
-        writer.writeAttribute("lang", m_transcriptLang);
-
-    //Qt6
-    // for (auto& a_block: qsConst(m_blocks)) {
-    for (auto& a_block: std::as_const(m_blocks)) {
-        if (a_block.text != "") {
-            // qDebug() << a_block.text; // Disabled debug
-            auto timeStamp = a_block.timeStamp;
-            QString timeStampString = timeStamp.toString("hh:mm:ss.zzz");
-            auto speaker = a_block.speaker;
-
-            writer.writeStartElement("line");
-            writer.writeAttribute("timestamp", timeStampString);
-            writer.writeAttribute("speaker", speaker);
-
-            if (!a_block.tagList.isEmpty())
-                writer.writeAttribute("tags", a_block.tagList.join(","));
-
-            for (auto& a_word: std::as_const(a_block.words)) {
-                writer.writeStartElement("word");
-                writer.writeAttribute("timestamp", a_word.timeStamp.toString("hh:mm:ss.zzz"));
-                writer.writeAttribute("isEdited", (a_word.isEdited == "true") ? "true": "false");
-
-                if (!a_word.tagList.isEmpty())
-                    writer.writeAttribute("tags", a_word.tagList.join(","));
-
-                writer.writeCharacters(a_word.text);
-                writer.writeEndElement();
-                // if(a_word.text.contains('.')==true)
-                // {
-                //     break;
-                // }
-            }
-            writer.writeEndElement();
-        }
-    }
-    writer.writeEndElement();
+    PROFILE_SCOPE("Editor::saveXml");
+    flushTimeOffsets();
+    TranscriptIO::writeXml(file, {m_transcriptLang, m_blocks});
     file->close();
     delete file;
 }
 
 void Editor::helpJumpToPlayer()
 {
+    flushTimeOffsets();
     emit sendBlockText(textCursor().block().text());
-    auto currentBlockNumber = textCursor().blockNumber();
+    auto currentBlockNumber = currentBlockIndex();
     auto timeToJump = QTime(0, 0);
 
     if (m_blocks[currentBlockNumber].timeStamp.isNull())
@@ -1297,25 +1194,19 @@ void Editor::helpJumpToPlayer()
     if (m_blocks[currentBlockNumber].speaker != "" || textCursor().block().text().contains("{}:"))
         wordNumber--;
 
-    for (int i = currentBlockNumber - 1; i >= 0; i--) {
-        if (m_blocks[i].timeStamp.isValid()) {
-
-            timeToJump = m_blocks[i].timeStamp;
-            break;
-        }
-    }
+    auto previousBlockTime = m_timeStampIndex.timeBeforeBlock(m_blocks, currentBlockNumber);
+    if (previousBlockTime.isValid())
+        timeToJump = previousBlockTime;
 
     // If we can jump to a word, then do so
     if (wordNumber >= 0 &&
         wordNumber < m_blocks[currentBlockNumber].words.size() &&
         m_blocks[currentBlockNumber].words[wordNumber].timeStamp.isValid()
         ) {
-        for (int i = wordNumber - 1; i >= 0; i--) {
-            if (m_blocks[currentBlockNumber].words[i].timeStamp.isValid()) {
-                timeToJump = m_blocks[currentBlockNumber].words[i].timeStamp;
-                emit jumpToPlayer(timeToJump);
-                return;
-            }
+        auto previousWordTime = m_timeStampIndex.timeBeforeWord(m_blocks, currentBlockNumber, wordNumber);
+        if (previousWordTime.isValid()) {
+            emit jumpToPlayer(previousWordTime);
+            return;
         }
     }
     // qInfo()<<timeToJump; // Disabled debug
@@ -1324,6 +1215,7 @@ void Editor::helpJumpToPlayer()
 
 void Editor::loadDictionary()
 {
+    PROFILE_SCOPE("Editor::loadDictionary");
     m_correctedWords.clear();
     m_dictionary.clear();
     if(QFile::exists("Dictonaries/"+m_transcriptLang+"/"+m_transcriptLang+"combined.txt")){
@@ -1397,42 +1289,13 @@ void Editor::loadDictionary()
     if (!m_highlighter)
         return;
 
-    QMultiMap<int, int> invalidWords;
-    for (int i = 0; i < m_blocks.size(); i++) {
-
-        for (int j = 0; j < m_blocks[i].words.size(); j++) {
-            auto wordText = m_blocks[i].words[j].text.toLower();
-
-            if (wordText != "" && m_punctuation.contains(wordText.back()))
-                wordText = wordText.left(wordText.size() - 1);
-
-            if (!isWordValid(wordText,
-                             m_dictionary,
-                             m_english_dictionary,
-                             m_transcriptLang)) {
-                invalidWords.insert(i, j);
-            }
-        }
-    }
-    m_highlighter->setInvalidWords(invalidWords);
+    updateHighlights();
     m_highlighter->rehighlight();
 }
 
 QStringList Editor::listFromFile(const QString& fileName)
 {
-    QStringList words;
-
-    QFile file(fileName);
-    if (!file.open(QFile::ReadOnly))
-        return {};
-
-    while (!file.atEnd()) {
-        QByteArray line = file.readLine();
-        if (!line.isEmpty()) {
-            words << QString::fromUtf8(line.trimmed());
-        }
-    }
-    return words;
+    return TranscriptIO::readWordList(fileName);
 }
 
 
@@ -1450,176 +1313,312 @@ void Editor::setShowTimeStamp()
     // SettingsManager::getInstance().setShowTimeStamps(showTimeStamp);
 
     setContent();
-    QTextCursor cursorx(this->document()->findBlockByNumber(highlightedBlock));
+    QTextCursor cursorx(textBlockAt(highlightedBlock));
     this->setTextCursor(cursorx);
 
 }
 
 void Editor::setContent()
 {
+    PROFILE_SCOPE("Editor::setContent");
+    // Every line is rendered again below
+    foldTimeOffsets();
     if (!settingContent) {
         settingContent = true;
 
         if (m_highlighter)
             delete m_highlighter;
 
-        QString content_with_time_stamp("");
-        QString content_without_time_stamp("");
-        for (auto& a_block: std::as_const(m_blocks)) {
-            auto blockText = "{" + a_block.speaker + "}: " + a_block.text + " {" + a_block.timeStamp.toString("hh:mm:ss.zzz") + "}";
-            content_with_time_stamp.append(blockText + "\n");
+        // In the virtualized view only a window of blocks is put into the document
+        if (m_virtualized) {
+            m_windowStart = qBound(0, m_windowStart, qMax(0, int(m_blocks.size()) - m_windowSize));
+            m_windowCount = qMin(m_windowSize, int(m_blocks.size()) - m_windowStart);
         }
-
-        for (auto& a_block: std::as_const(m_blocks)) {
-            auto blockText = "{" + a_block.speaker + "}: " + a_block.text ;
-            content_without_time_stamp.append(blockText + "\n");
+        else {
+            m_windowStart = 0;
+            m_windowCount = m_blocks.size();
         }
 
-        if(showTimeStamp){
-            setPlainText(content_with_time_stamp.trimmed());}
-        else{
-            setPlainText(content_without_time_stamp.trimmed());
-        }
+        QStringList lines;
+        lines.reserve(m_windowCount);
+        for (int i = m_windowStart; i < m_windowStart + m_windowCount; i++)
+            lines.append(blockLine(m_blocks[i]));
+
+        setPlainText(lines.join("\n").trimmed());
+        m_wordIndexDirty = true;
+        // Every structural edit goes through here, only paging the window leaves the blocks untouched
+        if (!m_shiftingWindow)
+            m_timeStampIndex.invalidate();
         m_highlighter = new Highlighter(document());
+        m_highlighter->setBlockToHighlight(highlightedBlock == -1 ? -1 : highlightedBlock - m_windowStart);
+        m_highlighter->setWordToHighlight(highlightedWord);
+        updateHighlights();
+        settingContent = false;
+    }
+}
 
-        QList<int> invalidBlocks;
-        QList<int> taggedBlocks;
-        QMultiMap<int, int> invalidWords;
-        QMultiMap<int, int>  taggedWords;
-        QMultiMap<int, int> editedWords;
-        for (int i = 0; i < m_blocks.size(); i++) {
-            if (m_blocks[i].timeStamp.isNull())
-                invalidBlocks.append(i);
-            else if(!m_blocks[i].tagList.isEmpty()){
-                taggedBlocks.append(i);
-            }
-            else {
+int Editor::currentBlockIndex() const
+{
+    return textCursor().blockNumber() + m_windowStart;
+}
 
-                for (int j = 0; j < m_blocks[i].words.size(); j++) {
-                    auto wordText = m_blocks[i].words[j].text.toLower();
-                    // auto isWordEdited = m_blocks[i].words[j].isEdited;
+QTextBlock Editor::textBlockAt(int blockNumber)
+{
+    if (m_virtualized && blockNumber >= 0 && blockNumber < m_blocks.size()
+        && (blockNumber < m_windowStart || blockNumber >= m_windowStart + m_windowCount))
+        materializeWindow(blockNumber - m_windowSize / 2);
 
-                    // if (isWordEdited == "true") {
-                    //     editedWords.insert(i, j);
-                    // }
+    return document()->findBlockByNumber(blockNumber - m_windowStart);
+}
 
-                    if (wordText != "" && m_punctuation.contains(wordText.back()))
-                        wordText = wordText.left(wordText.size() - 1);
+void Editor::setVirtualizedView(bool value)
+{
+    if (m_virtualized == value)
+        return;
 
-                    if (wordText != "" && wordText[0] == '\"'){
+    int currentBlock = m_blocks.isEmpty() ? 0 : currentBlockIndex();
+    m_virtualized = value;
+    settings->setValue("virtualizedView", QVariant(value).toString());
 
-                        QString text="";
-                        for(int i=1;i<wordText.size();i++){
-                            text+=wordText[i];
-                        }
-                        wordText=text;
-                    }
-                    if (wordText != "" && wordText[wordText.size()-1] == '\"'){
-                        wordText = wordText.left(wordText.size() - 1);
+    // The document scroll bar only spans the window, the transcript one spans every line
+    setVerticalScrollBarPolicy(value ? Qt::ScrollBarAlwaysOff : Qt::ScrollBarAsNeeded);
+    m_transcriptScrollBar->setVisible(value);
+    setRightMargin(value ? m_transcriptScrollBar->sizeHint().width() : 0);
 
-                    }
-                    if (wordText != "" && wordText[0] == '('){
+    if (m_blocks.isEmpty())
+        return;
 
-                        QString text="";
-                        for(int i=1;i<wordText.size();i++){
-                            text+=wordText[i];
-                        }
-                        wordText=text;
-                    }
-                    if (wordText != "" && wordText[wordText.size()-1] == ')'){
-                        wordText = wordText.left(wordText.size() - 1);
+    materializeWindow(currentBlock - m_windowSize / 2);
+    setTextCursor(QTextCursor(textBlockAt(currentBlock)));
+    centerCursor();
+}
 
-                    }
-                    if (wordText != "" && wordText[0] == '['){
+void Editor::materializeWindow(int first)
+{
+    m_shiftingWindow = true;
 
-                        QString text="";
-                        for(int i=1;i<wordText.size();i++){
-                            text+=wordText[i];
-                        }
-                        wordText=text;
-                    }
-                    if (wordText != "" && wordText[wordText.size()-1] == ']'){
-                        wordText = wordText.left(wordText.size() - 1);
-                        // qInfo()<<wordText; // Disabled debug
-                    }
-                    if (wordText != "" && wordText[0] == '{'){
-                        QString text="";
-                        for(int i=1;i<wordText.size();i++){
-                            text+=wordText[i];
-                        }
-                        wordText=text;
-                    }
-                    if (wordText != "" &&wordText[wordText.size()-1] == '}'){
-                        wordText = wordText.left(wordText.size() - 1);
+    int cursorBlock = currentBlockIndex();
+    int cursorColumn = textCursor().positionInBlock();
+    int topBlock = firstVisibleBlock().blockNumber() + m_windowStart;
 
-                    }
-                    if (wordText != "" && wordText[0] == '\''){
+    m_windowStart = first;
+    setContent();
 
-                        QString text="";
-                        for(int i=1;i<wordText.size();i++){
-                            text+=wordText[i];
-                        }
-                        wordText=text;
-                    }
-                    if (wordText != "" && wordText[wordText.size()-1] == '\''){
-                        wordText = wordText.left(wordText.size() - 1);
+    // Keep the cursor and the first visible line where they were if they are still in the window
+    int windowEnd = m_windowStart + m_windowCount;
+    if (cursorBlock < m_windowStart || cursorBlock >= windowEnd) {
+        cursorBlock = qBound(m_windowStart, topBlock, qMax(m_windowStart, windowEnd - 1));
+        cursorColumn = 0;
+    }
+    auto cursorTextBlock = document()->findBlockByNumber(cursorBlock - m_windowStart);
+    QTextCursor cursor(cursorTextBlock);
+    cursor.setPosition(cursorTextBlock.position() + qMin(cursorColumn, qMax(0, cursorTextBlock.length() - 1)));
+    setTextCursor(cursor);
 
-                    }
-                    if (wordText != "" && wordText[0] == '<'){
+    if (topBlock >= m_windowStart && topBlock < windowEnd)
+        verticalScrollBar()->setValue(document()->findBlockByNumber(topBlock - m_windowStart).firstLineNumber());
 
-                        QString text="";
-                        for(int i=1;i<wordText.size();i++){
-                            text+=wordText[i];
-                        }
-                        wordText=text;
-                    }
-                    if (wordText != "" && wordText[wordText.size()-1] == '>'){
-                        wordText = wordText.left(wordText.size() - 1);
+    m_shiftingWindow = false;
+    syncTranscriptScrollBar();
+}
 
-                    }
+void Editor::shiftWindow(int blockNumber)
+{
+    if (!m_virtualized || m_blocks.isEmpty())
+        return;
 
-                    if (wordText != "" && wordText[wordText.size()-1] == '?'){
-                        wordText = wordText.left(wordText.size() - 1);
+    int windowEnd = m_windowStart + m_windowCount;
+    bool nearStart = m_windowStart > 0 && blockNumber < m_windowStart + m_windowMargin;
+    bool nearEnd = windowEnd < m_blocks.size() && blockNumber >= windowEnd - m_windowMargin;
 
-                    }
-                    if (wordText != "" && wordText[wordText.size()-1] == '!'){
-                        wordText = wordText.left(wordText.size() - 1);
+    if (nearStart || nearEnd)
+        materializeWindow(blockNumber - m_windowSize / 2);
+}
 
-                    }
-                    if (wordText != "" && wordText[wordText.size()-1] == ','){
-                        wordText = wordText.left(wordText.size() - 1);
+void Editor::syncTranscriptScrollBar()
+{
+    if (!m_virtualized)
+        return;
 
-                    }
-                    static QRegularExpression regex("([0-1][0-9]|2[0-3]):([0-5][0-9]):([0-5][0-9])(\\.[0-9]+)?");
-                    bool match = regex.match(wordText).hasMatch();
-                    if (match) {
-                        continue;
-                        // the string is a valid time in the format "HH:MM:SS.f"
-                    }
-                    if (!isWordValid(wordText,
-                                     m_dictionary,
-                                     m_english_dictionary,
-                                     m_transcriptLang)) {
-                        invalidWords.insert(i, j);
-                    }
-                    if(!m_blocks[i].words[j].tagList.empty()){
-                        taggedWords.insert(i,j);
-                    }
-                    if(m_blocks[i].words[j].isEdited == "true") {
-                        editedWords.insert(i, j);
-                    }
-                }
-            }
-        }
-        m_highlighter->setInvalidBlocks(invalidBlocks);
-        m_highlighter->setTaggedBlocks(taggedBlocks);
-        m_highlighter->setInvalidWords(invalidWords);
-        m_highlighter->setTaggedWords(taggedWords);
-        m_highlighter->setBlockToHighlight(highlightedBlock);
-        m_highlighter->setWordToHighlight(highlightedWord);
-        m_highlighter->setEditedWords(editedWords);
-        settingContent = false;
+    QSignalBlocker blocker(m_transcriptScrollBar);
+    m_transcriptScrollBar->setRange(0, qMax(0, int(m_blocks.size()) - 1));
+    m_transcriptScrollBar->setPageStep(qMax(1, viewport()->height() / qMax(1, fontMetrics().lineSpacing())));
+    m_transcriptScrollBar->setValue(firstVisibleBlock().blockNumber() + m_windowStart);
+}
+
+void Editor::onViewportScrolled(int value)
+{
+    Q_UNUSED(value);
+    // Lines scrolled into view show their pending time shifts
+    if (m_timeOffsets.hasPending() && !settingContent)
+        QTimer::singleShot(0, this, &Editor::renderVisibleTimes);
+
+    if (!m_virtualized || m_shiftingWindow || settingContent)
+        return;
+
+    syncTranscriptScrollBar();
+    // Defer the shift, the document must not be replaced from inside its own scroll handling
+    QTimer::singleShot(0, this, [this]() {
+        if (!m_shiftingWindow)
+            shiftWindow(firstVisibleBlock().blockNumber() + m_windowStart);
+    });
+}
+
+void Editor::onTranscriptScrolled(int value)
+{
+    if (!m_virtualized || m_shiftingWindow || m_blocks.isEmpty())
+        return;
+
+    shiftWindow(value);
+    auto textBlock = textBlockAt(value);
+    if (textBlock.isValid())
+        verticalScrollBar()->setValue(textBlock.firstLineNumber());
+}
+
+void Editor::insertFromMimeData(const QMimeData* source)
+{
+    // Like typing, see keyPressEvent()
+    flushTimeOffsets();
+    TextEditor::insertFromMimeData(source);
+}
+
+void Editor::resizeEvent(QResizeEvent *e)
+{
+    TextEditor::resizeEvent(e);
+
+    QRect cr = contentsRect();
+    int width = m_transcriptScrollBar->sizeHint().width();
+    m_transcriptScrollBar->setGeometry(QRect(cr.right() - width + 1, cr.top(), width, cr.height()));
+    syncTranscriptScrollBar();
+    if (m_timeOffsets.hasPending())
+        QTimer::singleShot(0, this, &Editor::renderVisibleTimes);
+}
+
+QString Editor::blockLine(const block& a_block) const
+{
+    auto line = "{" + a_block.speaker + "}: " + a_block.text;
+    if (showTimeStamp)
+        line += " {" + a_block.timeStamp.toString("hh:mm:ss.zzz") + "}";
+    return line;
+}
+
+int Editor::replaceAll(const FindReplaceQuery& query, const QString& replacement)
+{
+    flushTimeOffsets();
+    FindReplaceEngine engine(query);
+    if (!engine.isValid() || m_blocks.isEmpty() || m_windowCount != blockCount())
+        return TextEditor::replaceAll(query, replacement);
+
+    int replacementCount{0};
+    auto blocks = m_blocks;
+    auto changedBlocks = engine.replaceAll(blocks, replacement, &replacementCount);
+    if (changedBlocks.isEmpty())
+        return 0;
+
+    // Undo only reaches the lines in the document, which in the virtualized view is a window
+    bool outsideWindow = std::any_of(changedBlocks.cbegin(), changedBlocks.cend(), [this](int blockNumber) {
+        return blockNumber < m_windowStart || blockNumber >= m_windowStart + m_windowCount;
+    });
+    if (outsideWindow) {
+        auto answer = QMessageBox::question(this, "Replace All",
+                                            QString("%1 occurrences are in lines outside the loaded window, "
+                                                    "so this replacement can't be undone. Replace anyway?")
+                                                .arg(replacementCount));
+        if (answer != QMessageBox::Yes)
+            return 0;
+    }
+
+    m_blocks = std::move(blocks);
+    if (outsideWindow) {
+        // Reloading the window also clears the undo history, which would only revert part of it
+        setContent();
+        updateWordEditor();
+        if (realTimeDataSaver)
+            transcriptSave();
+        return replacementCount;
+    }
+    m_timeStampIndex.invalidate(*std::min_element(changedBlocks.cbegin(), changedBlocks.cend()));
+
+    // Rewrite only the changed lines, as a single undo step and without per-edit revalidation
+    settingContent = true;
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    for (int blockNumber: std::as_const(changedBlocks)) {
+        if (!m_wordIndexDirty)
+            m_wordIndex.updateBlock(blockNumber, m_blocks[blockNumber]);
+
+        renderBlockLine(cursor, blockNumber);
     }
+    cursor.endEditBlock();
+    settingContent = false;
+
+    updateHighlights();
+    updateWordEditor();
+    if (realTimeDataSaver)
+        transcriptSave();
+
+    return replacementCount;
+}
+
+bool Editor::inFindScope(int blockIndex, const FindReplaceQuery& query) const
+{
+    if (!TextEditor::inFindScope(blockIndex, query))
+        return false;
+    return query.speaker.isEmpty()
+           || (blockIndex < m_blocks.size() && m_blocks[blockIndex].speaker == query.speaker);
+}
+
+void Editor::renderBlockLine(QTextCursor& cursor, int blockNumber)
+{
+    // Blocks outside the virtualized window are rendered when they are paged in
+    if (blockNumber < m_windowStart || blockNumber >= m_windowStart + m_windowCount)
+        return;
+
+    auto textBlock = document()->findBlockByNumber(blockNumber - m_windowStart);
+    cursor.setPosition(textBlock.position());
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText(blockLine(m_blocks[blockNumber]));
+}
+
+QVector<WordPosition> Editor::searchWords(const WordQuery& query)
+{
+    flushTimeOffsets();
+    if (m_wordIndexDirty || m_wordIndex.blockCount() != m_blocks.size()) {
+        m_wordIndex.rebuild(m_blocks);
+        m_wordIndexDirty = false;
+    }
+    return m_wordIndex.search(query, m_blocks);
+}
+
+void Editor::jumpToWord(int blockNumber, int wordNumber)
+{
+    flushTimeOffsets();
+    if (blockNumber < 0 || blockNumber >= m_blocks.size()
+        || wordNumber < 0 || wordNumber >= m_blocks[blockNumber].words.size())
+        return;
+
+    auto& a_block = m_blocks[blockNumber];
+
+    // Select the word in the line, which is rendered as "{speaker}: word word ..."
+    int offset = a_block.speaker.size() + 4;
+    for (int j = 0; j < wordNumber; j++)
+        offset += a_block.words[j].text.size() + 1;
+
+    auto textBlock = textBlockAt(blockNumber);
+    QTextCursor cursor(textBlock);
+    cursor.setPosition(textBlock.position() + qMin(offset, textBlock.length() - 1));
+    cursor.setPosition(qMin(cursor.position() + int(a_block.words[wordNumber].text.size()),
+                            textBlock.position() + textBlock.length() - 1), QTextCursor::KeepAnchor);
+    setTextCursor(cursor);
+    centerCursor();
+    setFocus();
+
+    // Word timestamps are end times, so the word starts where the previous one ended
+    auto wordStart = m_timeStampIndex.timeBeforeWord(m_blocks, blockNumber, wordNumber);
+    if (!wordStart.isValid())
+        wordStart = m_timeStampIndex.timeBeforeBlock(m_blocks, blockNumber);
+
+    emit jumpToPlayer(wordStart.isValid() ? wordStart : QTime(0, 0));
 }
 
 bool Editor::timestampVisibility()
@@ -1629,6 +1628,7 @@ bool Editor::timestampVisibility()
 
 void Editor::contentChanged(int position, int charsRemoved, int charsAdded)
 {
+    PROFILE_SCOPE("Editor::contentChanged");
     // If chars aren't added or deleted then return
     if (!(charsAdded || charsRemoved) || settingContent)
         return;
@@ -1636,16 +1636,33 @@ void Editor::contentChanged(int position, int charsRemoved, int charsAdded)
     if (m_blocks.isEmpty()) { // If block data is empty (i.e. no file opened) just fill them from editor
         for (int i = 0; i < document()->blockCount(); i++)
             m_blocks.append(fromEditor(i));
+        m_windowStart = 0;
+        m_windowCount = m_blocks.size();
+        m_wordIndexDirty = true;
+        m_timeStampIndex.invalidate();
         return;
     }
 
     delete m_highlighter;
     m_highlighter = new Highlighter(this->document());
 
-    int currentBlockNumber = textCursor().blockNumber();
-
-    if(m_blocks.size() != blockCount()) {
-        auto blocksChanged = m_blocks.size() - blockCount();
+    // Document block numbers are relative to the virtualized window, m_blocks indices are absolute
+    int currentDocumentBlock = textCursor().blockNumber();
+    int currentBlockNumber = currentBlockIndex();
+    bool blockCountChanged = m_windowCount != blockCount();
+
+    // User edits flush pending shifts first (see keyPressEvent()), so they only remain for
+    // edits from elsewhere. A shifted line still shows its old time and is parsed back as
+    // such, so the shift is added again after parsing and the line rendered once more.
+    bool staleLines = m_timeOffsets.hasPending() && showTimeStamp;
+    if (blockCountChanged)
+        foldTimeOffsets();
+
+    if(blockCountChanged) {
+        // Line numbers shift, the word index is rebuilt on the next search
+        m_wordIndexDirty = true;
+        auto blocksChanged = m_windowCount - blockCount();
+        m_timeStampIndex.invalidate(currentBlockNumber - qAbs(blocksChanged));
         if (blocksChanged > 0) { // Blocks deleted
             // qInfo() << "[Lines Deleted]" << QString("%1 lines deleted").arg(QString::number(blocksChanged)); // Disabled debug
             for (int i = 1; i <= blocksChanged; i++)
@@ -1654,68 +1671,199 @@ void Editor::contentChanged(int position, int charsRemoved, int charsAdded)
         else { // Blocks added
             // qInfo() << "[Lines Inserted]" << QString("%1 lines inserted").arg(QString::number(-blocksChanged)); // Disabled debug
             for (int i = 1; i <= -blocksChanged; i++) {
-                if (document()->findBlockByNumber(currentBlockNumber + blocksChanged).text().trimmed() == "")
-                    m_blocks.insert(currentBlockNumber + blocksChanged, fromEditor(currentBlockNumber - i));
+                if (document()->findBlockByNumber(currentDocumentBlock + blocksChanged).text().trimmed() == "")
+                    m_blocks.insert(currentBlockNumber + blocksChanged, fromEditor(currentDocumentBlock - i));
                 else
-                    m_blocks.insert(currentBlockNumber + blocksChanged + 1, fromEditor(currentBlockNumber - i + 1));
+                    m_blocks.insert(currentBlockNumber + blocksChanged + 1, fromEditor(currentDocumentBlock - i + 1));
             }
         }
+        m_windowCount = blockCount();
+        syncTranscriptScrollBar();
     }
 
-    auto currentBlockFromEditor = fromEditor(currentBlockNumber);
-    auto& currentBlockFromData = m_blocks[currentBlockNumber];
+    if (!blockCountChanged) {
+        // Undo and redo of batched edits (e.g. replace all) can touch many lines at once
+        int firstChanged = qMax(0, document()->findBlock(position).blockNumber());
+        int lastChanged = qMin(m_windowCount - 1, document()->findBlock(position + charsAdded).blockNumber());
+        for (int i = firstChanged; i <= lastChanged; i++)
+            syncShiftedBlockFromEditor(i);
+        if (currentDocumentBlock < firstChanged || currentDocumentBlock > lastChanged)
+            syncShiftedBlockFromEditor(currentDocumentBlock);
+    }
+    else
+        syncBlockFromEditor(currentDocumentBlock);
 
-    if (currentBlockFromData.speaker != currentBlockFromEditor.speaker) {
-        // qInfo() << "[Speaker Changed]"
-        //         << QString("line number: %1").arg(QString::number(currentBlockNumber + 1))
-        //         << QString("initial: %1").arg(currentBlockFromData.speaker)
-        //         << QString("final: %1").arg(currentBlockFromEditor.speaker); // Disabled debug
+    if (staleLines) {
+        QTimer::singleShot(0, this, [this]() {
+            foldTimeOffsets();
+            QVector<int> window(m_windowCount);
+            std::iota(window.begin(), window.end(), m_windowStart);
+            renderTimeLines(window);
+            updateHighlights();
+        });
+    }
 
-        currentBlockFromData.speaker = currentBlockFromEditor.speaker;
+    m_highlighter->setBlockToHighlight(highlightedBlock == -1 ? -1 : highlightedBlock - m_windowStart);
+    m_highlighter->setWordToHighlight(highlightedWord);
+    updateHighlights();
+    updateWordEditor();
+    if(realTimeDataSaver){
+        transcriptSave();
     }
-    if(showTimeStamp){
-        if (currentBlockFromData.timeStamp != currentBlockFromEditor.timeStamp) {
 
-            currentBlockFromData.timeStamp = currentBlockFromEditor.timeStamp;
-            // qInfo() << "[TimeStamp Changed]"
-            //         << QString("line number: %1, %2").arg(QString::number(currentBlockNumber + 1), currentBlockFromEditor.timeStamp.toString("hh:mm:ss.zzz"));
+    // {
+    //     QMutexLocker locker(&queueMutex);
+    //     taskQueue.enqueue({
+    //         QVariant(position),
+    //         QVariant(charsRemoved),
+    //         QVariant(charsAdded),
+    //         QVariant(textCursor().blockNumber()),
+    //         QVariant(document()->blockCount()),
+    //         QVariant::fromValue(currentBlockFromEditor),
+    //         QVariant::fromValue(currentBlockFromData)
+    //     });
+    // }
 
-        }
-    }
-    if (currentBlockFromData.text != currentBlockFromEditor.text) {
-        // qInfo() << "[Text Changed]"
-        //         << QString("line number: %1").arg(QString::number(currentBlockNumber + 1))
-        //         << QString("initial: %1").arg(currentBlockFromData.text)
-        //         << QString("final: %1").arg(currentBlockFromEditor.text); // Disabled debug
+    // std::cerr << "Enqueued task\n";
 
-        currentBlockFromData.text = currentBlockFromEditor.text;
-        auto tagList = currentBlockFromData.tagList;
+    // QMetaObject::invokeMethod(this, "processNextTask", Qt::QueuedConnection);
 
-        auto& wordsFromEditor = currentBlockFromEditor.words;
-        auto& wordsFromData = currentBlockFromData.words;
+    // debounceTimer->start();
+    // handleContentChanged();
 
-        int wordsDifference = wordsFromEditor.size() - wordsFromData.size();
-        int diffStart{-1}, diffEnd{-1};
+}
 
-        bool flag = true;
-        for (int i = 0; i < wordsFromEditor.size() && i < wordsFromData.size(); i++)
-            if (flag && wordsFromEditor[i].text != wordsFromData[i].text) {
-                diffStart = i;
-                flag = false;
-                // break; //added flag instead of breaking
-            } else {
-                wordsFromEditor[i].isEdited = wordsFromData[i].isEdited;
-            }
+// void Editor::processNextTask() {
 
-        if (diffStart == -1)
-            diffStart = wordsFromEditor.size() - 1;
-        for (int i = 0; i <= diffStart; i++)
-            if (i < wordsFromData.size()){
-                wordsFromEditor[i].timeStamp = wordsFromData[i].timeStamp;
-                //                wordsFromEditor[i].tagList = wordsFromData[i].tagList;
-            }
+//     std::cerr << "Processing next task\n";
 
-        if (!wordsDifference) {
+//     if (taskQueue.isEmpty())
+//         return;
+
+//     if (!taskSemaphore.tryAcquire()) {
+//         return;
+//     }
+
+//     QVariantList task;
+//     {
+//         QMutexLocker locker(&queueMutex);
+//         if (taskQueue.isEmpty()) {  // Check again under lock
+//             taskSemaphore.release();
+//             return;
+//         }
+//         task = taskQueue.dequeue();
+//     }
+
+//     int position = task[0].toInt();
+//     int charsRemoved = task[1].toInt();
+//     int charsAdded = task[2].toInt();
+//     int currentBlockNumber = task[3].toInt();
+//     int blockCount = task[4].toInt();
+//     block currentBlockFromEditor = task[5].value<block>();
+//     block currentBlockFromData = task[6].value<block>();
+
+//     auto* worker = new TaskRunner(
+//         this,
+//         task[0].toInt(),
+//         task[1].toInt(),
+//         task[2].toInt(),
+//         task[3].toInt(),
+//         task[4].toInt(),
+//         task[5].value<block>(),
+//         task[6].value<block>()
+//         );
+
+//     std::cerr << "Starting worker\n";
+//     QThreadPool::globalInstance()->start(worker);
+// }
+
+// void Editor::processContentChange(int position, int charsRemoved, int charsAdded, int currentBlockNumber, int blockCount,
+//                                   block currentBlockFromEditor, block currentBlockFromData) {
+
+//     std::cerr << "Processing content change\n";
+//     QMutexLocker locker(&queueMutex);
+//     std::cerr << "After locker\n";
+
+
+//     std::cerr << "Task completed\n";
+// }
+
+// void Editor::handleContentChanged() {
+
+
+
+// }
+
+void Editor::syncShiftedBlockFromEditor(int documentBlockNumber)
+{
+    int blockNumber = documentBlockNumber + m_windowStart;
+    auto offset = blockNumber < m_timeOffsets.size() ? m_timeOffsets.takeOffset(blockNumber) : 0;
+    syncBlockFromEditor(documentBlockNumber);
+    if (offset && blockNumber < m_blocks.size())
+        TimeOffsetTree::apply(m_blocks[blockNumber], offset);
+}
+
+void Editor::syncBlockFromEditor(int documentBlockNumber)
+{
+    int currentBlockNumber = documentBlockNumber + m_windowStart;
+    if (documentBlockNumber < 0 || currentBlockNumber >= m_blocks.size())
+        return;
+
+    auto currentBlockFromEditor = fromEditor(documentBlockNumber);
+    auto& currentBlockFromData = m_blocks[currentBlockNumber];
+    m_timeStampIndex.invalidate(currentBlockNumber);
+
+    if (currentBlockFromData.speaker != currentBlockFromEditor.speaker) {
+        // qInfo() << "[Speaker Changed]"
+        //         << QString("line number: %1").arg(QString::number(currentBlockNumber + 1))
+        //         << QString("initial: %1").arg(currentBlockFromData.speaker)
+        //         << QString("final: %1").arg(currentBlockFromEditor.speaker); // Disabled debug
+
+        currentBlockFromData.speaker = currentBlockFromEditor.speaker;
+    }
+    if(showTimeStamp){
+        if (currentBlockFromData.timeStamp != currentBlockFromEditor.timeStamp) {
+
+            currentBlockFromData.timeStamp = currentBlockFromEditor.timeStamp;
+            // qInfo() << "[TimeStamp Changed]"
+            //         << QString("line number: %1, %2").arg(QString::number(currentBlockNumber + 1), currentBlockFromEditor.timeStamp.toString("hh:mm:ss.zzz"));
+
+        }
+    }
+    if (currentBlockFromData.text != currentBlockFromEditor.text) {
+        // qInfo() << "[Text Changed]"
+        //         << QString("line number: %1").arg(QString::number(currentBlockNumber + 1))
+        //         << QString("initial: %1").arg(currentBlockFromData.text)
+        //         << QString("final: %1").arg(currentBlockFromEditor.text); // Disabled debug
+
+        currentBlockFromData.text = currentBlockFromEditor.text;
+        auto tagList = currentBlockFromData.tagList;
+
+        auto& wordsFromEditor = currentBlockFromEditor.words;
+        auto& wordsFromData = currentBlockFromData.words;
+
+        int wordsDifference = wordsFromEditor.size() - wordsFromData.size();
+        int diffStart{-1}, diffEnd{-1};
+
+        bool flag = true;
+        for (int i = 0; i < wordsFromEditor.size() && i < wordsFromData.size(); i++)
+            if (flag && wordsFromEditor[i].text != wordsFromData[i].text) {
+                diffStart = i;
+                flag = false;
+                // break; //added flag instead of breaking
+            } else {
+                wordsFromEditor[i].isEdited = wordsFromData[i].isEdited;
+            }
+
+        if (diffStart == -1)
+            diffStart = wordsFromEditor.size() - 1;
+        for (int i = 0; i <= diffStart; i++)
+            if (i < wordsFromData.size()){
+                wordsFromEditor[i].timeStamp = wordsFromData[i].timeStamp;
+                //                wordsFromEditor[i].tagList = wordsFromData[i].tagList;
+            }
+
+        if (!wordsDifference) {
             wordsFromEditor[diffStart].isEdited = "true";
             for (int i = diffStart; i < wordsFromEditor.size(); i++){
                 wordsFromEditor[i].timeStamp = wordsFromData[i].timeStamp;
@@ -1790,10 +1938,17 @@ void Editor::contentChanged(int position, int charsRemoved, int charsAdded)
         }
 
         currentBlockFromData.tagList = tagList;
+
+        if (!m_wordIndexDirty)
+            m_wordIndex.updateBlock(currentBlockNumber, currentBlockFromData);
     }
+}
 
-    m_highlighter->setBlockToHighlight(highlightedBlock);
-    m_highlighter->setWordToHighlight(highlightedWord);
+void Editor::updateHighlights()
+{
+    PROFILE_SCOPE("Editor::updateHighlights");
+    if (!m_highlighter)
+        m_highlighter = new Highlighter(document());
 
     QList<int> invalidBlocks;
     QList<int> taggedBlocks;
@@ -1801,122 +1956,33 @@ void Editor::contentChanged(int position, int charsRemoved, int charsAdded)
     QMultiMap<int, int>  taggedWords;
     QMultiMap<int, int> editedWords;
 
-    for (int i = 0; i < m_blocks.size(); i++) {
+    // Highlights are keyed by document block, only the materialised window is checked
+    for (int i = m_windowStart; i < m_windowStart + m_windowCount && i < m_blocks.size(); i++) {
+        int line = i - m_windowStart;
         if (m_blocks[i].timeStamp.isNull())
-            invalidBlocks.append(i);
+            invalidBlocks.append(line);
         else if(!m_blocks[i].tagList.isEmpty()){
-            taggedBlocks.append(i);
+            taggedBlocks.append(line);
         }
         else {
             for (int j = 0; j < m_blocks[i].words.size(); j++) {
-                auto wordText = m_blocks[i].words[j].text.toLower();
+                auto wordText = TranscriptDictionary::normalizeWord(m_blocks[i].words[j].text);
                 auto isWordEdited = m_blocks[i].words[j].isEdited == "true";
 
                 if (isWordEdited) {
-                    editedWords.insert(i, j);
-                }
-                if (wordText != "" && m_punctuation.contains(wordText.back()))
-                    wordText = wordText.left(wordText.size() - 1);
-
-                if (wordText != "" && wordText[0] == '\"'){
-
-                    QString text="";
-                    for(int i=1;i<wordText.size();i++){
-                        text+=wordText[i];
-                    }
-                    wordText=text;
-                }
-                if (wordText != "" && wordText[wordText.size()-1] == '\"'){
-                    wordText = wordText.left(wordText.size() - 1);
-
+                    editedWords.insert(line, j);
                 }
-                if (wordText != "" && wordText[0] == '('){
-
-                    QString text="";
-                    for(int i=1;i<wordText.size();i++){
-                        text+=wordText[i];
-                    }
-                    // qInfo()<<text;  // Disabled debug
-                    wordText=text;
-                }
-                if (wordText != "" && wordText[wordText.size()-1] == ')'){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-                if (wordText != "" && wordText[0] == '['){
-
-                    QString text="";
-                    for(int i=1;i<wordText.size();i++){
-                        text+=wordText[i];
-                    }
-                    wordText=text;
-                }
-                if (wordText != "" && wordText[wordText.size()-1] == ']'){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-                if (wordText != "" && wordText[0] == '{'){
-                    QString text="";
-                    for(int i=1;i<wordText.size();i++){
-                        text+=wordText[i];
-                    }
-                    wordText=text;
-                }
-                if (wordText != "" &&wordText[wordText.size()-1]== '}'){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-                if (wordText != "" && wordText[0] == '\''){
-
-                    QString text="";
-                    for(int i=1;i<wordText.size();i++){
-                        text+=wordText[i];
-                    }
-                    wordText=text;
-                }
-                if (wordText != "" && wordText[wordText.size()-1] == '\''){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-                if (wordText != "" && wordText[0] == '<'){
-
-                    QString text="";
-                    for(int i=1;i<wordText.size();i++){
-                        text+=wordText[i];
-                    }
-                    wordText=text;
-                }
-                if (wordText != "" && wordText[wordText.size()-1] == '>'){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-
-                if (wordText != "" && wordText[wordText.size()-1] == '?'){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-                if (wordText != "" && wordText[wordText.size()-1] == '!'){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-                if (wordText != "" && wordText[wordText.size()-1] == ','){
-                    wordText = wordText.left(wordText.size() - 1);
-
-                }
-                static QRegularExpression regex("([0-1][0-9]|2[0-3]):([0-5][0-9]):([0-5][0-9])(\\.[0-9]+)?");
-                bool match = regex.match(wordText).hasMatch();
-                if (match) {
+                // Times typed into the text aren't words
+                if (TranscriptDictionary::isTimeStamp(wordText))
                     continue;
-                    // the string is a valid time in the format "HH:MM:SS.f"
-                }
                 if (!isWordValid(wordText,
                                  m_dictionary,
                                  m_english_dictionary,
                                  m_transcriptLang)) {
-                    invalidWords.insert(i, j);
+                    invalidWords.insert(line, j);
                 }
                 if(!m_blocks[i].words[j].tagList.empty()){
-                    taggedWords.insert(i,j);
+                    taggedWords.insert(line,j);
                 }
             }
 
@@ -1928,111 +1994,13 @@ void Editor::contentChanged(int position, int charsRemoved, int charsAdded)
     m_highlighter->setInvalidWords(invalidWords);
     m_highlighter->setTaggedWords(taggedWords);
     m_highlighter->setEditedWords(editedWords);
-    updateWordEditor();
-    if(realTimeDataSaver){
-        transcriptSave();
-    }
-
-    // {
-    //     QMutexLocker locker(&queueMutex);
-    //     taskQueue.enqueue({
-    //         QVariant(position),
-    //         QVariant(charsRemoved),
-    //         QVariant(charsAdded),
-    //         QVariant(textCursor().blockNumber()),
-    //         QVariant(document()->blockCount()),
-    //         QVariant::fromValue(currentBlockFromEditor),
-    //         QVariant::fromValue(currentBlockFromData)
-    //     });
-    // }
-
-    // std::cerr << "Enqueued task\n";
-
-    // QMetaObject::invokeMethod(this, "processNextTask", Qt::QueuedConnection);
-
-    // debounceTimer->start();
-    // handleContentChanged();
-
 }
 
-// void Editor::processNextTask() {
-
-//     std::cerr << "Processing next task\n";
-
-//     if (taskQueue.isEmpty())
-//         return;
-
-//     if (!taskSemaphore.tryAcquire()) {
-//         return;
-//     }
-
-//     QVariantList task;
-//     {
-//         QMutexLocker locker(&queueMutex);
-//         if (taskQueue.isEmpty()) {  // Check again under lock
-//             taskSemaphore.release();
-//             return;
-//         }
-//         task = taskQueue.dequeue();
-//     }
-
-//     int position = task[0].toInt();
-//     int charsRemoved = task[1].toInt();
-//     int charsAdded = task[2].toInt();
-//     int currentBlockNumber = task[3].toInt();
-//     int blockCount = task[4].toInt();
-//     block currentBlockFromEditor = task[5].value<block>();
-//     block currentBlockFromData = task[6].value<block>();
-
-//     auto* worker = new TaskRunner(
-//         this,
-//         task[0].toInt(),
-//         task[1].toInt(),
-//         task[2].toInt(),
-//         task[3].toInt(),
-//         task[4].toInt(),
-//         task[5].value<block>(),
-//         task[6].value<block>()
-//         );
-
-//     std::cerr << "Starting worker\n";
-//     QThreadPool::globalInstance()->start(worker);
-// }
-
-// void Editor::processContentChange(int position, int charsRemoved, int charsAdded, int currentBlockNumber, int blockCount,
-//                                   block currentBlockFromEditor, block currentBlockFromData) {
-
-//     std::cerr << "Processing content change\n";
-//     QMutexLocker locker(&queueMutex);
-//     std::cerr << "After locker\n";
-
-
-//     std::cerr << "Task completed\n";
-// }
-
-// void Editor::handleContentChanged() {
-
-
-
-// }
-
 bool Editor::isWordValid(const QString& wordText,
                  const QStringList& primaryDict,
                  const QStringList& englishDict,
                  const QString& transcriptLang) {
-
-    bool inPrimaryDict = std::binary_search(primaryDict.begin(),
-                                            primaryDict.end(),
-                                            wordText);
-    if (inPrimaryDict) return true;
-
-    if (transcriptLang != "english") {
-        return std::binary_search(englishDict.begin(),
-                                  englishDict.end(),
-                                  wordText);
-    }
-
-    return false;
+    return TranscriptDictionary::isWordValid(wordText, primaryDict, englishDict, transcriptLang);
 }
 
 
@@ -2040,13 +2008,14 @@ void Editor::jumpToHighlightedLine()
 {
     if (highlightedBlock == -1)
         return;
-    QTextCursor cursor(document()->findBlockByNumber(highlightedBlock));
+    QTextCursor cursor(textBlockAt(highlightedBlock));
     setTextCursor(cursor);
 }
 
 void Editor::splitLine(const QTime& elapsedTime)
 {
-    if (document()->blockCount() <= 0)
+    flushTimeOffsets();
+    if (document()->blockCount() <= 0 || m_blocks.isEmpty())
         return;
 
     // qInfo() << "Split Line - - - - - -- - - - -- - \n";  // Disabled debug
@@ -2055,7 +2024,7 @@ void Editor::splitLine(const QTime& elapsedTime)
     //     return;
     int positionInBlock = cursor.positionInBlock();
     auto blockText = cursor.block().text();
-    auto blockNumber = cursor.blockNumber();
+    int blockNumber = currentBlockIndex();
 
     auto textBeforeCursor = blockText.left(positionInBlock);
     auto textAfterCursor = blockText.right(blockText.size() - positionInBlock);
@@ -2104,9 +2073,9 @@ void Editor::splitLine(const QTime& elapsedTime)
     // m_blocks[highlightedBlock].text = textBeforeCursor.trimmed();
     // m_blocks[highlightedBlock].timeStamp = elapsedTime;
 
-    if (m_blocks[cursor.blockNumber()].speaker != "" || blockText.contains("{}:"))
+    if (m_blocks[blockNumber].speaker != "" || blockText.contains("{}:"))
         wordNumber--;
-    if (wordNumber < 0 || wordNumber >= m_blocks[cursor.blockNumber()].words.size())
+    if (wordNumber < 0 || wordNumber >= m_blocks[blockNumber].words.size())
         return;
 
 
@@ -2117,41 +2086,41 @@ void Editor::splitLine(const QTime& elapsedTime)
         textAfterCursor = textAfterCursor.split("{").first();
 
 
-    auto timeStampOfCutWord = m_blocks[cursor.blockNumber()].words[wordNumber].timeStamp;
-    auto tagsOfCutWord = m_blocks[cursor.blockNumber()].words[wordNumber].tagList;
+    auto timeStampOfCutWord = m_blocks[blockNumber].words[wordNumber].timeStamp;
+    auto tagsOfCutWord = m_blocks[blockNumber].words[wordNumber].tagList;
     QVector<word> words;
-    int sizeOfWordsAfter = m_blocks[cursor.blockNumber()].words.size() - wordNumber - 1;
+    int sizeOfWordsAfter = m_blocks[blockNumber].words.size() - wordNumber - 1;
 
     //checking
     if (cutWordRight != "")
         words.append(makeWord(timeStampOfCutWord, cutWordRight, tagsOfCutWord, "true"));
 
     for (int i = 0; i < sizeOfWordsAfter; i++) {
-        words.append(m_blocks[cursor.blockNumber()].words[wordNumber + 1]);
-        m_blocks[cursor.blockNumber()].words.removeAt(wordNumber + 1);
+        words.append(m_blocks[blockNumber].words[wordNumber + 1]);
+        m_blocks[blockNumber].words.removeAt(wordNumber + 1);
     }
 
     if (cutWordLeft == "")
-        m_blocks[cursor.blockNumber()].words.removeAt(wordNumber);
+        m_blocks[blockNumber].words.removeAt(wordNumber);
     else {
-        m_blocks[cursor.blockNumber()].words[wordNumber].text = cutWordLeft;
-        m_blocks[cursor.blockNumber()].words[wordNumber].timeStamp = elapsedTime;
+        m_blocks[blockNumber].words[wordNumber].text = cutWordLeft;
+        m_blocks[blockNumber].words[wordNumber].timeStamp = elapsedTime;
     }
 
-    block blockToInsert = {m_blocks[cursor.blockNumber()].timeStamp,
+    block blockToInsert = {m_blocks[blockNumber].timeStamp,
                            textAfterCursor.trimmed(),
-                           m_blocks[cursor.blockNumber()].speaker,
-                           m_blocks[cursor.blockNumber()].tagList,
+                           m_blocks[blockNumber].speaker,
+                           m_blocks[blockNumber].tagList,
                            words};
-    m_blocks.insert(cursor.blockNumber() + 1, blockToInsert);
+    m_blocks.insert(blockNumber + 1, blockToInsert);
 
-    m_blocks[cursor.blockNumber()].text = textBeforeCursor.trimmed();
-    m_blocks[cursor.blockNumber()].timeStamp = elapsedTime;
+    m_blocks[blockNumber].text = textBeforeCursor.trimmed();
+    m_blocks[blockNumber].timeStamp = elapsedTime;
 
     setContent();
     updateWordEditor();
 
-    int totalBlocks = document()->blockCount();
+    int totalBlocks = m_blocks.size();
     if (blockNumber >= totalBlocks)
     {
         blockNumber = totalBlocks - 1;
@@ -2161,7 +2130,7 @@ void Editor::splitLine(const QTime& elapsedTime)
         blockNumber = 0;
     }
 
-    QTextCursor newCursor(document()->findBlockByNumber(blockNumber));
+    QTextCursor newCursor(textBlockAt(blockNumber));
     newCursor.movePosition(QTextCursor::EndOfBlock);
     setTextCursor(newCursor);
 
@@ -2175,7 +2144,8 @@ void Editor::splitLine(const QTime& elapsedTime)
 
 void Editor::mergeUp()
 {
-    auto blockNumber = textCursor().blockNumber();
+    flushTimeOffsets();
+    auto blockNumber = currentBlockIndex();
     auto previousBlockNumber = blockNumber - 1;
 
     if (m_blocks.isEmpty() || blockNumber == 0 || m_blocks[blockNumber].speaker != m_blocks[previousBlockNumber].speaker)
@@ -2191,7 +2161,7 @@ void Editor::mergeUp()
     setContent();
     updateWordEditor();
 
-    QTextCursor cursor(document()->findBlockByNumber(previousBlockNumber));
+    QTextCursor cursor(textBlockAt(previousBlockNumber));
     setTextCursor(cursor);
     centerCursor();
 
@@ -2205,7 +2175,8 @@ void Editor::mergeUp()
 
 void Editor::mergeDown()
 {
-    auto blockNumber = textCursor().blockNumber();
+    flushTimeOffsets();
+    auto blockNumber = currentBlockIndex();
     auto nextBlockNumber = blockNumber + 1;
 
     if (m_blocks.isEmpty() || blockNumber == m_blocks.size() - 1 || m_blocks[blockNumber].speaker != m_blocks[nextBlockNumber].speaker)
@@ -2225,7 +2196,7 @@ void Editor::mergeDown()
     setContent();
     updateWordEditor();
 
-    QTextCursor cursor(document()->findBlockByNumber(blockNumber));
+    QTextCursor cursor(textBlockAt(blockNumber));
     setTextCursor(cursor);
     centerCursor();
 
@@ -2248,7 +2219,7 @@ void Editor::createChangeSpeakerDialog()
         speakers.insert(a_block.speaker);
 
     m_changeSpeaker->addItems(speakers.values());
-    m_changeSpeaker->setCurrentSpeaker(m_blocks.at(textCursor().blockNumber()).speaker);
+    m_changeSpeaker->setCurrentSpeaker(m_blocks.at(currentBlockIndex()).speaker);
 
     connect(m_changeSpeaker,
             &ChangeSpeakerDialog::accepted,
@@ -2269,7 +2240,7 @@ void Editor::createTimePropagationDialog()
     m_propagateTime->setModal(true);
     m_propagateTime->setAttribute(Qt::WA_DeleteOnClose);
 
-    m_propagateTime->setBlockRange(textCursor().blockNumber() + 1, blockCount());
+    m_propagateTime->setBlockRange(currentBlockIndex() + 1, m_blocks.size());
 
     connect(m_propagateTime,
             &TimePropagationDialog::accepted,
@@ -2293,7 +2264,7 @@ void Editor::createTagSelectionDialog()
     m_selectTag->setModal(true);
     m_selectTag->setAttribute(Qt::WA_DeleteOnClose);
 
-    m_selectTag->markExistingTags(m_blocks[textCursor().blockNumber()].tagList);
+    m_selectTag->markExistingTags(m_blocks[currentBlockIndex()].tagList);
 
     connect(m_selectTag,
             &TagSelectionDialog::accepted,
@@ -2307,7 +2278,8 @@ void Editor::createTagSelectionDialog()
 
 void Editor::insertTimeStamp(const QTime& elapsedTime)
 {
-    auto blockNumber = textCursor().blockNumber();
+    flushTimeOffsets();
+    auto blockNumber = currentBlockIndex();
 
     if (m_blocks.size() <= blockNumber)
         return;
@@ -2316,7 +2288,7 @@ void Editor::insertTimeStamp(const QTime& elapsedTime)
 
     dontUpdateWordEditor = true;
     setContent();
-    QTextCursor cursor(document()->findBlockByNumber(blockNumber));
+    QTextCursor cursor(textBlockAt(blockNumber));
     cursor.movePosition(QTextCursor::EndOfBlock);
     setTextCursor(cursor);
     centerCursor();
@@ -2337,6 +2309,7 @@ void Editor::changeTranscriptLang()
 
 void Editor::speakerWiseJump(const QString& jumpDirection)
 {
+    flushTimeOffsets();
     auto& blockNumber = highlightedBlock;
 
     if (blockNumber == -1) {
@@ -2369,18 +2342,16 @@ void Editor::speakerWiseJump(const QString& jumpDirection)
 
     QTime timeToJump(0, 0);
 
-    for (int i = blockToJump - 1; i >= 0; i--) {
-        if (m_blocks[i].timeStamp.isValid()) {
-            timeToJump = m_blocks[i].timeStamp;
-            break;
-        }
-    }
+    auto previousBlockTime = m_timeStampIndex.timeBeforeBlock(m_blocks, blockToJump);
+    if (previousBlockTime.isValid())
+        timeToJump = previousBlockTime;
 
     emit jumpToPlayer(timeToJump);
 }
 
 void Editor::wordWiseJump(const QString& jumpDirection)
 {
+    flushTimeOffsets();
     auto& wordNumber = highlightedWord;
 
     if (highlightedBlock == -1 || wordNumber == -1) {
@@ -2405,20 +2376,12 @@ void Editor::wordWiseJump(const QString& jumpDirection)
     if (jumpDirection == "left") {
         if (wordToJump == 0){
             timeToJump = QTime(0, 0);
-            for (int i = highlightedBlock - 1; i >= 0; i--) {
-                if (m_blocks[i].timeStamp.isValid()) {
-                    timeToJump = m_blocks[i].timeStamp;
-                    break;
-                }
-            }
-        }
-        else {
-            for (int i = wordToJump - 1; i >= 0; i--)
-                if (highlightedBlockWords[i].timeStamp.isValid()) {
-                    timeToJump = highlightedBlockWords[i].timeStamp;
-                    break;
-                }
+            auto previousBlockTime = m_timeStampIndex.timeBeforeBlock(m_blocks, highlightedBlock);
+            if (previousBlockTime.isValid())
+                timeToJump = previousBlockTime;
         }
+        else
+            timeToJump = m_timeStampIndex.timeBeforeWord(m_blocks, highlightedBlock, wordToJump);
     }
 
     if (jumpDirection == "right")
@@ -2435,6 +2398,7 @@ void Editor::wordWiseJump(const QString& jumpDirection)
 
 void Editor::blockWiseJump(const QString& jumpDirection)
 {
+    flushTimeOffsets();
     if (highlightedBlock == -1)
         return;
 
@@ -2445,19 +2409,16 @@ void Editor::blockWiseJump(const QString& jumpDirection)
     else if (jumpDirection == "down")
         blockToJump = highlightedBlock + 1;
 
-    if (blockToJump == -1 || blockToJump == blockCount())
+    if (blockToJump == -1 || blockToJump == m_blocks.size())
         return;
 
     QTime timeToJump;
 
     if (jumpDirection == "up") {
         timeToJump = QTime(0, 0);
-        for (int i = blockToJump - 1; i >= 0; i--) {
-            if (m_blocks[i].timeStamp.isValid()) {
-                timeToJump = m_blocks[i].timeStamp;
-                break;
-            }
-        }
+        auto previousBlockTime = m_timeStampIndex.timeBeforeBlock(m_blocks, blockToJump);
+        if (previousBlockTime.isValid())
+            timeToJump = previousBlockTime;
     }
     else if (jumpDirection == "down")
         timeToJump = m_blocks[highlightedBlock].timeStamp;
@@ -2470,6 +2431,61 @@ void Editor::useTransliteration(bool value, const QString& langCode)
 {
     m_transliterate = value;
     m_transliterateLangCode = langCode;
+
+    if (!m_transliterate) {
+        if (m_transliterator)
+            m_transliterator->cancelAll();
+        m_transliterationCompleter->popup()->hide();
+        return;
+    }
+
+    if (m_transliterator)
+        return;
+
+    m_transliterator = new Transliterator(this);
+
+    auto backendName = settings->value("transliterationBackend", "inputtools").toString();
+    if (backendName == "offline") {
+        auto tablePath = settings->value("transliterationTable").toString();
+        auto backend = new OfflineTableBackend(tablePath, m_transliterator);
+        if (!backend->entryCount())
+            emit message("Transliteration table " + tablePath + " is empty or missing");
+        m_transliterator->setBackend(backend);
+    }
+    else {
+        auto url = settings->value("transliterationUrl", InputToolsBackend::DefaultUrl).toString();
+        m_transliterator->setBackend(new InputToolsBackend(url, m_transliterator));
+    }
+
+    connect(m_transliterator, &Transliterator::suggestionsReady, this, &Editor::showTransliterationSuggestions);
+    connect(m_transliterator, &Transliterator::message, this, &Editor::message);
+}
+
+void Editor::showTransliterationSuggestions(const QString& input, const QString& langCode, const QStringList& suggestions)
+{
+    if (!m_transliterate || langCode != m_transliterateLangCode || !hasFocus())
+        return;
+
+    // The user may have kept typing while the request was in flight
+    QString blockText = textCursor().block().text();
+    QString textTillCursor = blockText.left(textCursor().positionInBlock());
+    auto words = blockText.split(" ");
+    int index = textTillCursor.count(" ");
+    if (index >= words.size() || words[index] != input)
+        return;
+
+    if (suggestions.isEmpty()) {
+        m_transliterationCompleter->popup()->hide();
+        return;
+    }
+
+    dynamic_cast<QStringListModel*>(m_transliterationCompleter->model())->setStringList(suggestions);
+    m_transliterationCompleter->popup()->setCurrentIndex(m_transliterationCompleter->completionModel()->index(0, 0));
+
+    QRect cr = cursorRect();
+    cr.setWidth(m_transliterationCompleter->popup()->sizeHintForColumn(0)
+                + m_transliterationCompleter->popup()->verticalScrollBar()->sizeHint().width());
+    m_transliterationCompleter->complete(cr);
 }
 
 void Editor::suggest(QString suggest)
@@ -2500,140 +2516,123 @@ void Editor::realTimeDataSavingToggle()
 
 void Editor::saveAsPDF()
 {
+    flushTimeOffsets();
 
-    QFile final("pdf.txt");
-    if(!final.open(QIODevice::OpenModeFlag::WriteOnly)){
-        qDebug() << "From PDF - 1";
-        QMessageBox::critical(this,"Error",final.errorString());
+    if (m_pdfExport.isRunning()) {
+        emit message("A PDF export is already running");
         return;
     }
-    QString initialhtm="<!DOCTYPE html><html lang='en'><head><meta charset='UTF-8'><meta http-equiv='X-UA-Compatible' content='IE=edge'><meta name='viewport' content='width= 290 , initial-scale=1.0'><title>Document</title></head><body>\n";
-    QString finalhtml="</body></html>";
-    QString content_with_time_stamp("");
-    QString content_without_time_stamp("");
-    QString htmlpart(initialhtm);
-
-
-
-    for (auto& a_block: std::as_const(m_blocks)) {
-        auto blockText = "<p>{" + a_block.speaker + "}: " + a_block.text + " {" + a_block.timeStamp.toString("hh:mm:ss.zzz") + "}<p>";
-        content_with_time_stamp.append(blockText + "\n\n");
-    }
-
-    for (auto& a_block: std::as_const(m_blocks)) {
-        auto blockText = "<p>{" + a_block.speaker + "}: " + a_block.text+"<p>" ;
-        content_without_time_stamp.append(blockText + "\n\n");
-    }
-
-    if(showTimeStamp){
-        htmlpart.append(content_with_time_stamp);
-    }
-    else{
-        htmlpart.append(content_without_time_stamp);
-    }
-    htmlpart.append(finalhtml);
-
-
 
     auto pdfSaveLocation = QFileDialog::getSaveFileName(this, "Export PDF", QString("/"), "*.pdf");
-    if(pdfSaveLocation!=""){
-        if (QFileInfo(pdfSaveLocation).suffix().isEmpty()) { pdfSaveLocation.append(".pdf"); }
-        // qInfo()<<pdfSaveLocation; // Disabled debug
+    if (pdfSaveLocation == "")
+        return;
+    if (QFileInfo(pdfSaveLocation).suffix().isEmpty()) { pdfSaveLocation.append(".pdf"); }
+
+    PdfExporter::Options options;
+    options.title = m_transcriptUrl.fileName();
+    options.font = document()->defaultFont();
+    options.withTimeStamps = showTimeStamp;
+
+    // Lines are painted on a worker, the dialog only follows and cancels it
+    auto progress = new QProgressDialog("Exporting PDF...", "Cancel", 0, m_blocks.size(), this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setMinimumDuration(500);
+    connect(&m_pdfExport, &QFutureWatcher<bool>::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(&m_pdfExport, &QFutureWatcher<bool>::finished, progress, &QProgressDialog::close);
+    connect(progress, &QProgressDialog::canceled, &m_pdfExport, &QFutureWatcher<bool>::cancel);
+
+    m_pdfExportFile = pdfSaveLocation;
+    m_pdfExport.setFuture(PdfExporter::writeAsync(m_blocks, pdfSaveLocation, options));
+}
 
-        QPrinter printer(QPrinter::PrinterResolution);
-        printer.setOutputFormat(QPrinter::PdfFormat);
-        printer.setPageSize(QPageSize::A4);
-        printer.setOutputFileName(pdfSaveLocation);
-        QTextDocument doc;
-        doc.setHtml(htmlpart);
-        //doc.setPageSize(printer.pageRect().size()); // This is necessary if you want to hide the page number
-        doc.print(&printer);
-    }
+void Editor::pdfExportFinished()
+{
+    auto future = m_pdfExport.future();
+    if (future.isCanceled())
+        emit message("PDF export cancelled");
+    else if (future.resultCount() && future.result())
+        emit message("Exported PDF: " + QFileInfo(m_pdfExportFile).fileName());
+    else
+        QMessageBox::critical(this, "Error", "Couldn't write " + m_pdfExportFile);
 }
 
 void Editor::saveAsTXT()    // save the transcript as a text file
 {
-    QString txtContent;
-
-    for (auto& a_block : std::as_const(m_blocks)) {
-        auto blockText = "{" + a_block.speaker + "}: " + a_block.text + " {" + a_block.timeStamp.toString("hh:mm:ss.zzz") + "}\n";
-        txtContent.append(blockText + "\n");
-    }
-
-    QString txtSaveLocation = QFileDialog::getSaveFileName(this, "Export TXT", QString("/"), "*.txt");
-    if (txtSaveLocation != "") {
-        if (QFileInfo(txtSaveLocation).suffix().isEmpty()) {
-            txtSaveLocation.append(".txt");
-        }
-        // qInfo() << txtSaveLocation;
-
-        QFile txtFile(txtSaveLocation);
-        if (txtFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream out(&txtFile);
-            out << txtContent;
-            txtFile.close();
-        } else {
-            qDebug() << "from txtSaveLocation";
-            QMessageBox::critical(this, "Error", txtFile.errorString());
-        }
-    }
+    exportTranscript("txt");
 }
 
-void Editor::updateWordEditor()
+void Editor::exportTranscript(const QString& format)
 {
-    if (!m_wordEditor || dontUpdateWordEditor)
+    auto exporter = TranscriptExporter::create(format);
+    if (!exporter)
         return;
-    updatingWordEditor = true;
 
-    auto blockNumber = textCursor().blockNumber();
+    flushTimeOffsets();
 
-    if (blockNumber >= m_blocks.size()) {
-        m_wordEditor->clear();
+    auto suffix = exporter->format();
+    auto saveLocation = QFileDialog::getSaveFileName(this, "Export " + exporter->description(), QString("/"),
+                                                     QString("%1 (*.%2)").arg(exporter->description(), suffix));
+    if (saveLocation == "")
         return;
-    }
+    if (QFileInfo(saveLocation).suffix().isEmpty()) { saveLocation.append("." + suffix); }
 
-    m_wordEditor->refreshWords(m_blocks[blockNumber].words);
-    updatingWordEditor = false;
+    QString error;
+    if (!TranscriptExporter::exportFile({m_transcriptLang, m_blocks}, format, saveLocation, &error))
+        QMessageBox::critical(this, "Error", error);
 }
 
-void Editor::wordEditorChanged()
+void Editor::updateWordEditor()
 {
-    auto editorBlockNumber = textCursor().blockNumber();
+    if (!m_wordEditor || dontUpdateWordEditor)
+        return;
 
-    if (document()->isEmpty() || m_blocks.isEmpty())
-        m_blocks.append(fromEditor(0));
+    auto model = m_wordEditor->wordModel();
+    auto blockNumber = currentBlockIndex();
+    materializeBlockTime(blockNumber);
 
-    if (settingContent || updatingWordEditor || editorBlockNumber >= m_blocks.size())
-        return;
+    if (blockNumber != model->blockNumber())
+        model->setBlockNumber(blockNumber < m_blocks.size() ? blockNumber : -1);
+    else
+        model->refresh();
+}
 
-    auto& block = m_blocks[editorBlockNumber];
-    if (block.words.isEmpty()) {
-        block.words = m_wordEditor->currentWords();
+void Editor::wordEditorChanged(int blockNumber, int wordNumber, int column)
+{
+    Q_UNUSED(wordNumber);
+    if (settingContent || blockNumber < 0 || blockNumber >= m_blocks.size())
         return;
-    }
 
-    auto& words = block.words;
-    words.clear();
+    if (column == WordTableModel::TimeColumn)
+        m_timeStampIndex.invalidate(blockNumber);
 
-    QString blockText;
-    words = m_wordEditor->currentWords();
-    for (auto& a_word: words)
-        blockText += a_word.text + " ";
-    block.text = blockText.trimmed();
+    // The model already updated the word, only the line text has to follow a text edit
+    if (column == WordTableModel::TextColumn) {
+        auto& a_block = m_blocks[blockNumber];
+        QStringList texts;
+        texts.reserve(a_block.words.size());
+        for (auto& a_word: std::as_const(a_block.words))
+            texts.append(a_word.text);
+        a_block.text = texts.join(" ");
 
-    dontUpdateWordEditor = true;
-    setContent();
-    QTextCursor cursor(document()->findBlockByNumber(editorBlockNumber));
-    setTextCursor(cursor);
-    centerCursor();
-    dontUpdateWordEditor = false;
+        if (!m_wordIndexDirty)
+            m_wordIndex.updateBlock(blockNumber, a_block);
+
+        dontUpdateWordEditor = true;
+        settingContent = true;
+        QTextCursor cursor(document());
+        renderBlockLine(cursor, blockNumber);
+        settingContent = false;
+        dontUpdateWordEditor = false;
+    }
+
+    updateHighlights();
 }
 
 void Editor::changeSpeaker(const QString& newSpeaker, bool replaceAllOccurrences)
 {
     if (m_blocks.isEmpty())
         return;
-    auto blockNumber = textCursor().blockNumber();
+    auto blockNumber = currentBlockIndex();
     auto blockSpeaker = m_blocks[blockNumber].speaker;
 
     if (!replaceAllOccurrences)
@@ -2646,7 +2645,7 @@ void Editor::changeSpeaker(const QString& newSpeaker, bool replaceAllOccurrences
     }
 
     setContent();
-    QTextCursor cursor(document()->findBlockByNumber(blockNumber));
+    QTextCursor cursor(textBlockAt(blockNumber));
     setTextCursor(cursor);
     centerCursor();
 
@@ -2663,46 +2662,182 @@ void Editor::propagateTime(const QTime& time, int start, int end, bool negateTim
         errorBox.exec();
         return;
     }
-    else if (start < 1 || end > blockCount() || start > end) {
+    else if (start < 1 || end > m_blocks.size() || start > end) {
         QMessageBox errorBox(QMessageBox::Critical, "Error", "Invalid Block Range Selected", QMessageBox::Ok);
         errorBox.exec();
         return;
     }
 
-    for (int i = start - 1; i < end; i++) {
-        auto& currentTimeStamp = m_blocks[i].timeStamp;
+    qint64 msecsToAdd = QTime(0, 0).msecsTo(time);
+    if (negateTime)
+        msecsToAdd = -msecsToAdd;
 
-        if (currentTimeStamp.isNull())
-            currentTimeStamp = QTime(0,0, 0, 0);
+    shiftTime(start - 1, end - 1, msecsToAdd);
 
-        int secondsToAdd = time.hour() * 3600 + time.minute() * 60 + time.second();
-        int msecondsToAdd = time.msec();
+    // qInfo() << "[Time propagated]"
+    //         << QString("block range: %1 - %2").arg(QString::number(start), QString::number(end))
+    //         << QString("time: %1 %2").arg(negateTime? "-" : "+", time.toString("hh:mm:ss.zzz")); // Disabled debug
+}
 
-        if (negateTime) {
-            secondsToAdd = -secondsToAdd;
-            msecondsToAdd = -msecondsToAdd;
-        }
+void Editor::nudgeTime(int steps)
+{
+    if (m_blocks.isEmpty())
+        return;
 
-        currentTimeStamp = currentTimeStamp.addMSecs(msecondsToAdd);
-        currentTimeStamp = currentTimeStamp.addSecs(secondsToAdd);
+    shiftTime(currentBlockIndex(), m_blocks.size() - 1, qint64(steps) * m_nudgeStep);
+}
 
+void Editor::shiftTime(int first, int last, qint64 msecs)
+{
+    if (m_timeOffsets.size() != m_blocks.size()) {
+        flushTimeOffsets();
+        m_timeOffsets.reset(m_blocks.size());
     }
 
-    int blockNumber = textCursor().blockNumber();
+    m_timeOffsets.addRange(first, last, msecs);
+    m_timeStampIndex.invalidate(first);
+    refreshBlockTimes(first, last);
+}
 
-    setContent();
-    QTextCursor cursor(document()->findBlockByNumber(blockNumber));
-    setTextCursor(cursor);
-    centerCursor();
+void Editor::refreshBlockTimes(int first, int last)
+{
+    // Only the lines in view and the word editor need the new times now, the rest is
+    // rendered when scrolled into view and folded in on the next bulk read
+    QPair<int, int> visible = visibleBlockRange();
+    QVector<int> lines;
+    bool becameValid = false;
+    for (int i = qMax(first, visible.first); i <= qMin(last, visible.second); i++)
+        if (takeBlockTime(i, &becameValid))
+            lines.append(i);
+    renderTimeLines(lines);
+    if (becameValid)
+        updateHighlights();
+    refreshWordEditorTimes(first, last);
+}
 
-    // qInfo() << "[Time propagated]"
-    //         << QString("block range: %1 - %2").arg(QString::number(start), QString::number(end))
-    //         << QString("time: %1 %2").arg(negateTime? "-" : "+", time.toString("hh:mm:ss.zzz")); // Disabled debug
+void Editor::refreshWordEditorTimes(int first, int last)
+{
+    if (!m_wordEditor)
+        return;
+
+    int wordEditorBlock = m_wordEditor->wordModel()->blockNumber();
+    if (wordEditorBlock >= first && wordEditorBlock <= last) {
+        materializeBlockTime(wordEditorBlock);
+        m_wordEditor->wordModel()->refresh();
+    }
+}
+
+void Editor::renderVisibleTimes()
+{
+    if (!m_timeOffsets.hasPending())
+        return;
+
+    QPair<int, int> visible = visibleBlockRange();
+    refreshBlockTimes(visible.first, visible.second);
+}
+
+QPair<int, int> Editor::visibleBlockRange() const
+{
+    auto textBlock = firstVisibleBlock();
+    int first = textBlock.blockNumber();
+    int last = first;
+    qreal top = blockBoundingGeometry(textBlock).translated(contentOffset()).top();
+    int bottom = viewport()->rect().bottom();
+    while (textBlock.isValid() && top <= bottom) {
+        last = textBlock.blockNumber();
+        top += blockBoundingRect(textBlock).height();
+        textBlock = textBlock.next();
+    }
+    return {first + m_windowStart, last + m_windowStart};
+}
+
+void Editor::renderTimeLines(const QVector<int>& blockNumbers)
+{
+    if (!showTimeStamp || blockNumbers.isEmpty())
+        return;
+
+    // Undoing a time render would bring back a time the model no longer has, so like
+    // setContent() it isn't undoable. The caret keeps its place in its line.
+    auto caret = textCursor();
+    int caretBlock = caret.blockNumber();
+    int caretColumn = caret.positionInBlock();
+    bool caretLineRendered = !caret.hasSelection() && blockNumbers.contains(caretBlock + m_windowStart);
+    bool wasSettingContent = settingContent;
+    settingContent = true;
+    document()->setUndoRedoEnabled(false);
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    for (int blockNumber: blockNumbers)
+        renderBlockLine(cursor, blockNumber);
+    cursor.endEditBlock();
+    document()->setUndoRedoEnabled(true);
+    settingContent = wasSettingContent;
+
+    if (caretLineRendered) {
+        auto textBlock = document()->findBlockByNumber(caretBlock);
+        caret.setPosition(textBlock.position() + qMin(caretColumn, textBlock.length() - 1));
+        setTextCursor(caret);
+    }
+}
+
+bool Editor::takeBlockTime(int blockNumber, bool* becameValid)
+{
+    if (!m_timeOffsets.hasPending() || blockNumber < 0 || blockNumber >= m_blocks.size())
+        return false;
+
+    auto offset = m_timeOffsets.takeOffset(blockNumber);
+    if (!offset)
+        return false;
+    if (becameValid && m_blocks[blockNumber].timeStamp.isNull())
+        *becameValid = true;
+    TimeOffsetTree::apply(m_blocks[blockNumber], offset);
+    return true;
+}
+
+void Editor::materializeBlockTime(int blockNumber)
+{
+    bool becameValid = false;
+    if (takeBlockTime(blockNumber, &becameValid))
+        renderTimeLines({blockNumber});
+    if (becameValid)
+        updateHighlights();
+}
+
+QVector<qint64> Editor::foldTimeOffsets(bool* becameValid)
+{
+    if (!m_timeOffsets.hasPending())
+        return {};
+
+    auto offsets = m_timeOffsets.takeOffsets();
+    for (int i = 0; i < offsets.size() && i < m_blocks.size(); i++) {
+        if (becameValid && offsets[i] && m_blocks[i].timeStamp.isNull())
+            *becameValid = true;
+        TimeOffsetTree::apply(m_blocks[i], offsets[i]);
+    }
+    return offsets;
+}
+
+void Editor::flushTimeOffsets()
+{
+    if (!m_timeOffsets.hasPending())
+        return;
+
+    bool becameValid = false;
+    auto offsets = foldTimeOffsets(&becameValid);
+
+    // Lines in the window that weren't in view still show their old times
+    QVector<int> lines;
+    for (int i = m_windowStart; i < m_windowStart + m_windowCount && i < offsets.size(); i++)
+        if (offsets[i])
+            lines.append(i);
+    renderTimeLines(lines);
+    if (becameValid)
+        updateHighlights();
 }
 
 void Editor::selectTags(const QStringList& newTagList)
 {
-    m_blocks[textCursor().blockNumber()].tagList = newTagList;
+    m_blocks[currentBlockIndex()].tagList = newTagList;
 
     emit refreshTagList(newTagList);
 
@@ -2733,24 +2868,7 @@ void Editor::markWordAsCorrect(int blockNumber, int wordNumber)
     static_cast<QStringListModel*>(m_textCompleter->model())->setStringList(m_dictionary);
     m_correctedWords.insert(textToInsert);
 
-    QMultiMap<int, int> invalidWords;
-    for (int i = 0; i < m_blocks.size(); i++) {
-        //        qInfo()<<"\n \n m_blocks["<<i<<"].words : ";
-        for (int j = 0; j < m_blocks[i].words.size(); j++) {
-            auto wordText = m_blocks[i].words[j].text.toLower();
-
-            if (wordText != "" && m_punctuation.contains(wordText.back()))
-                wordText = wordText.left(wordText.size() - 1);
-
-            if (!isWordValid(wordText,
-                             m_dictionary,
-                             m_english_dictionary,
-                             m_transcriptLang)) {
-                invalidWords.insert(i, j);
-            }
-        }
-    }
-    m_highlighter->setInvalidWords(invalidWords);
+    updateHighlights();
     m_highlighter->rehighlight();
 
     QFile correctedWords(QString("corrected_words_%1.txt").arg(m_transcriptLang));
@@ -2808,47 +2926,9 @@ void Editor::insertTransliterationCompletion(const QString& completion)
     setTextCursor(tc);
 }
 
-void Editor::handleReply()
-{
-    QStringList tokens;
-
-    QString replyString = m_reply->readAll();
-
-    if (replyString.split("[\"").size() < 4)
-        return;
-
-    tokens = replyString.split("[\"")[3].split("]").first().split("\",\"");
-
-    auto lastString = tokens[tokens.size() - 1];
-    tokens[tokens.size() - 1] = lastString.left(lastString.size() - 1);
-
-    m_lastReplyList = tokens;
-}
-
-void Editor::sendRequest(const QString& input, const QString& langCode)
-{
-    if (m_reply) {
-        m_reply->abort();
-        delete m_reply;
-        m_reply = nullptr;
-    }
-
-    QString url = QString("http://inputtools.google.com/request?text=%1&itc=%2-t-i0-und&num=10&cp=0&cs=1&ie=utf-8&oe=utf-8&app=test").arg(input, langCode);
-
-    QNetworkRequest request(url);
-    m_reply = m_manager.get(request);
-
-    connect(m_reply, &QNetworkReply::finished, this, [this] () {
-        if (m_reply->error() == QNetworkReply::NoError)
-            handleReply();
-        else if (m_reply->error() != QNetworkReply::OperationCanceledError)
-            emit message(m_reply->errorString());
-        emit replyCame();
-    });
-}
-
 QList<QTime> Editor::getTimeStamps()
 {
+    flushTimeOffsets();
 
     QList<QTime> timeStamps;
 
@@ -2867,37 +2947,55 @@ QList<QTime> Editor::getTimeStamps()
 }
 
 void Editor::updateTimeStamp(int block_num, QTime endTime){
+    flushTimeOffsets();
     if (m_blocks.empty() || block_num >= m_blocks.size() || block_num < 0)
         return;
-    // if (block_num < m_blocks.size()) {
+
+    // Untimed lines are painted as invalid, which only changes when a time is set or cleared
+    bool validityChanged = m_blocks[block_num].timeStamp.isNull() != endTime.isNull();
     m_blocks[block_num].timeStamp = endTime;
     m_blocks[block_num].words[m_blocks[block_num].words.size() - 1].timeStamp = endTime;
-    setContent();
-    // } else if (block_num == m_blocks.size()) {
-    //     struct block obj;
-    //     obj.timeStamp = endTime;
-    //     m_blocks.append(obj);
-    //     setContent();
-    // }
-    /*for(int i = 0; i < m_blocks.size(); ++i)
-    {
-        qInfo()<<"timestamp of block "<<i+1<<" is: "<<m_blocks[i].timeStamp<<"\n";
-    }*/
+    m_timeStampIndex.invalidate(block_num);
+    renderTimeLines({block_num});
+    if (validityChanged)
+        updateHighlights();
+    refreshWordEditorTimes(block_num, block_num);
 }
 
-void Editor::updateTimeStampsBlock(QVector<int> blks) {
-
-    for (int i = 0; i < m_blocks.size(); i++) {
-        QTime time(0,0,0);
-        time = time.addSecs(blks[i]);
+void Editor::updateTimeStampsBlock(QVector<qint64> blks) {
+    flushTimeOffsets();
+
+    // Only the lines whose time changed are rendered again, unless blocks are added
+    QVector<int> changed;
+    bool validityChanged = false;
+    for (int i = 0; i < m_blocks.size() && i < blks.size(); i++) {
+        // Lines the waveform has no boundary for keep whatever they have
+        if (blks[i] < 0)
+            continue;
+        QTime time = QTime(0, 0).addMSecs(blks[i]);
+        if (m_blocks[i].timeStamp == time)
+            continue;
+        validityChanged |= m_blocks[i].timeStamp.isNull();
         m_blocks[i].timeStamp = time;
         m_blocks[i].words[m_blocks[i].words.size() - 1].timeStamp = time;
+        changed.append(i);
+    }
+
+    if (blks.size() <= m_blocks.size()) {
+        if (!changed.isEmpty()) {
+            m_timeStampIndex.invalidate(changed.first());
+            renderTimeLines(changed);
+            if (validityChanged)
+                updateHighlights();
+            refreshWordEditorTimes(changed.first(), changed.last());
+        }
+        return;
     }
 
     for (int i = m_blocks.size(); i < blks.size(); i++) {
 
         QTime time(0,0,0);
-        time = time.addSecs(blks[i]);
+        time = time.addMSecs(blks[i]);
 
         word wrd;
         wrd.timeStamp = time;
@@ -2917,6 +3015,7 @@ void Editor::updateTimeStampsBlock(QVector<int> blks) {
 
 void Editor::showWaveform()
 {
+    flushTimeOffsets();
     if (m_blocks.isEmpty())
         return;
     //waveform
@@ -6,6 +6,10 @@
 #include "utilities/changespeakerdialog.h"
 #include "utilities/timepropagationdialog.h"
 #include "utilities/tagselectiondialog.h"
+#include "utilities/transliterator.h"
+#include "utilities/wordindex.h"
+#include "utilities/timestampindex.h"
+#include "utilities/timeoffsettree.h"
 
 #include <QXmlStreamReader>
 #include <QRegularExpression>
@@ -20,12 +24,11 @@
 #include <qrunnable.h>
 #include <qsemaphore.h>
 #include <set>
-#include <QNetworkAccessManager>
-#include <QNetworkRequest>
-#include <QNetworkReply>
 #include <QTimer>
+#include <QFutureWatcher>
 #include <QUndoCommand>
 #include <QSettings>
+#include <QScrollBar>
 // #include <QQueue>
 
 class Highlighter;
@@ -52,15 +55,16 @@ public:
     /**
      * @brief Sets the word editor for the current Editor instance.
      *
-     * This function connects the word editor's itemChanged signal
-     * to the Editor's wordEditorChanged slot.
+     * The word editor's model works directly on `m_blocks`; its wordChanged
+     * signal is connected to the Editor's wordEditorChanged slot.
      *
      * @param wordEditor Pointer to the WordEditor instance.
      */
     void setWordEditor(WordEditor* wordEditor)
     {
         m_wordEditor = wordEditor;
-        connect(m_wordEditor, &QTableWidget::itemChanged, this, &Editor::wordEditorChanged);
+        m_wordEditor->wordModel()->setBlocks(&m_blocks);
+        connect(m_wordEditor->wordModel(), &WordTableModel::wordChanged, this, &Editor::wordEditorChanged);
     }
 
     /**
@@ -100,6 +104,33 @@ public:
      */
     void setContent();
 
+    /**
+     * @brief Replaces every match of a query in the block/word model.
+     *
+     * All matches are applied to `m_blocks` first, then only the changed lines are
+     * rewritten in a single edit block, so the whole operation is one undo step and
+     * the transcript is revalidated once. In the virtualized view, replacements in
+     * lines outside the window can't be undone; they are confirmed first and the
+     * window is reloaded, which clears the undo history.
+     *
+     * @param query What to find and where.
+     * @param replacement The replacement text.
+     * @return The number of replaced occurrences.
+     */
+    int replaceAll(const FindReplaceQuery& query, const QString& replacement) override;
+    bool inFindScope(int blockIndex, const FindReplaceQuery& query) const override;
+
+    /**
+     * @brief Searches the transcript through the inverted word index.
+     *
+     * The index follows line edits incrementally and is rebuilt lazily when lines
+     * are added, removed or the content is reset.
+     *
+     * @param query Terms and filters to search for.
+     * @return Matching word positions, ordered by line and word.
+     */
+    QVector<WordPosition> searchWords(const WordQuery& query);
+
     /**
      * @brief Checks the visibility status of timestamps.
      *
@@ -118,6 +149,8 @@ public:
     QList<QTime> getTimeStamps();
 
     friend class Highlighter; ///< Grants Highlighter access to private members.
+    friend class EditorBenchmark; ///< Grants the benchmark suite access to the load/save internals.
+    friend class KeyReplay; ///< Grants the latency harness access to the dictionary loading.
 
     /**
      * @brief Loads transcript data from a given URL.
@@ -134,9 +167,34 @@ public:
      */
     void showWaveform();
 
+    /**
+     * @brief Index in `m_blocks` of the line holding the text cursor.
+     */
+    int currentBlockIndex() const;
+
+    /**
+     * @brief Returns the document block of a transcript line, paging it into view if needed.
+     *
+     * @param blockNumber Index of the line in `m_blocks`.
+     */
+    QTextBlock textBlockAt(int blockNumber);
+
+    int firstBlockIndex() const override { return m_windowStart; }
+    int totalBlockCount() const override { return m_virtualized ? int(m_blocks.size()) : blockCount(); }
+
     //    QUndoStack *undoStack=nullptr;
 protected:
 
+    /**
+     * @brief Keeps the transcript scroll bar of the virtualized view beside the viewport.
+     */
+    void resizeEvent(QResizeEvent *e) override;
+
+    /**
+     * @brief Shows pending time shifts before pasted or dropped text is parsed back.
+     */
+    void insertFromMimeData(const QMimeData* source) override;
+
     /**
      * @brief Handles mouse press events, enabling specific behavior with Ctrl key.
      *
@@ -194,11 +252,6 @@ signals:
      */
     void refreshTagList(const QStringList& tagList);
 
-    /**
-     * @brief Signal emitted when a reply is received from an external source.
-     */
-    void replyCame();
-
     /**
      * @brief Signal emitted to open a message box or display a message in the UI.
      *
@@ -275,6 +328,13 @@ public slots:
      */
     void addCustomDictonary();
 
+    /**
+     * @brief Uses a word list as the custom dictionary and reloads the dictionary.
+     *
+     * @param fileName Text file with one word per line.
+     */
+    void useCustomDictonary(const QString& fileName);
+
     /**
      * @brief Displays all blocks and their content in the QDebug (Saved in Logfile).
      * Iterates through each block and prints its timestamp, speaker, text, and associated tags,
@@ -288,6 +348,14 @@ public slots:
      */
     void jumpToHighlightedLine();
 
+    /**
+     * @brief Selects a word in the editor and jumps the player to where it starts.
+     * The start time is the end time of the previous timed word or block.
+     * @param blockNumber The line of the word.
+     * @param wordNumber The index of the word in the line.
+     */
+    void jumpToWord(int blockNumber, int wordNumber);
+
     /**
      * @brief Splits the current text line at the cursor's position.
      * Divides the block into two based on cursor position, creating a new block and adjusting
@@ -371,6 +439,24 @@ public slots:
      */
     void useTransliteration(bool value, const QString& langCode = "en");
 
+    /**
+     * @brief Enables or disables the virtualized view.
+     *
+     * In the virtualized view only a window of lines around the viewport is kept in
+     * the document and a separate scroll bar spans the whole transcript, so long
+     * transcripts stay responsive. Moving the window resets the undo history.
+     *
+     * @param value True to only materialise a window of lines.
+     */
+    void setVirtualizedView(bool value);
+
+    /**
+     * @brief Shifts the current and all following blocks by a number of nudge steps.
+     *
+     * @param steps Number of steps (config key timeNudgeStep, in milliseconds), negative to shift back.
+     */
+    void nudgeTime(int steps);
+
     /**
      * @brief Enables or disables the auto-save feature for the editor.
      *
@@ -397,25 +483,33 @@ public slots:
     /**
      * @brief Exports the transcript as a PDF file.
      *
-     * This function gathers the content of the transcript and formats
-     * it into HTML before exporting it as a PDF. The user is prompted
-     * to select a save location.
+     * The user is prompted to select a save location, then the lines are
+     * painted page by page on a worker thread while a progress dialog
+     * follows the export and can cancel it.
      */
     void saveAsPDF();
 
     /**
      * @brief Exports the transcript as a text file.
      *
-     * The function compiles the content of the transcript into a
-     * plain text format and allows the user to choose a save location.
+     * Same as exportTranscript("txt").
      */
     void saveAsTXT();
 
+    /**
+     * @brief Exports the transcript in one of TranscriptExporter::formats().
+     *
+     * The user is prompted for a save location, then the lines are streamed
+     * to the file by the format's writer.
+     */
+    void exportTranscript(const QString& format);
+
     /**
      * @brief Updates the current block's timestamp with a new value.
      *
      * This function sets the timestamp of the specified block to
-     * the given end time.
+     * the given end time and renders only that line again, outside the
+     * undo history, so a waveform drag doesn't become a run of undo steps.
      *
      * @param block_num The index of the block to update (0-indexed).
      * @param endTime The new timestamp to set for the block.
@@ -424,27 +518,30 @@ public slots:
 
     /**
      * @brief Updates timestamps for a range of blocks based on a
-     *        provided vector of seconds.
+     *        provided vector of milliseconds.
      *
      * This function sets the timestamps of the blocks based on the
-     * provided vector. New blocks are added if the vector exceeds the
-     * current number of blocks.
+     * provided vector. Only lines whose time changed are rendered
+     * again; new blocks are added, and the document rebuilt, if the
+     * vector exceeds the current number of blocks.
      *
-     * @param blks A QVector of integers representing the timestamps in seconds.
+     * @param blks A QVector of block end times in milliseconds.
      */
-    void updateTimeStampsBlock(QVector<int> blks);
+    void updateTimeStampsBlock(QVector<qint64> blks);
 
     void handleContentChanged();
 
 private slots:
     void contentChanged(int position, int charsRemoved, int charsAdded);
-    void wordEditorChanged();
+    void wordEditorChanged(int blockNumber, int wordNumber, int column);
+    /// Reports how the PDF export started by saveAsPDF() ended.
+    void pdfExportFinished();
 
     /**
      * @brief Updates the word editor with the current block's words.
      *
-     * This function refreshes the word editor display based on the
-     * current block of text being edited.
+     * Switching lines resets the word model; staying on a line refreshes it,
+     * as its words may have been edited.
      */
     void updateWordEditor();
 
@@ -464,8 +561,9 @@ private slots:
     /**
      * @brief Propagates a specified time adjustment to a range of blocks.
      *
-     * This function adjusts the timestamps of the selected blocks
-     * based on the specified time, either adding or subtracting it.
+     * This function adjusts the timestamps of the selected blocks and their
+     * words based on the specified time, either adding or subtracting it. The
+     * shift is recorded in `m_timeOffsets` and folded into the blocks lazily.
      *
      * @param time The time to be added or subtracted from the blocks' timestamps.
      * @param start The starting block number (1-indexed).
@@ -527,28 +625,16 @@ private slots:
     void insertTransliterationCompletion(const QString &completion);
 
     /**
-     * @brief Processes the response received from a network reply and extracts tokens.
+     * @brief Shows transliteration suggestions delivered by the transliterator.
      *
-     * Reads the data from `m_reply`, parses the response string to extract meaningful
-     * tokens, and stores them in `m_lastReplyList`. The function expects the response
-     * to follow a specific format: it splits on a predefined delimiter pattern (`[\"`)
-     * to access the content, extracts the token list, and removes extraneous characters.
+     * Replies arrive asynchronously, so the suggestions are only shown if the
+     * word under the cursor still matches the input they were requested for.
      *
-     * @note If the response format does not meet the expected structure
-     * (less than four sections when split by `"[\""`), the function will exit early.
+     * @param input The text the suggestions were requested for.
+     * @param langCode The language code of the suggestions.
+     * @param suggestions The transliteration candidates.
      */
-    void handleReply();
-
-    /**
-     * @brief Sends a request to an external service for text completion.
-     *
-     * This function constructs and sends a network request to an
-     * external API based on the input text and language code.
-     *
-     * @param input The input text to send for completion suggestions.
-     * @param langCode The language code indicating the language of the input text.
-     */
-    void sendRequest(const QString& input, const QString& langCode);
+    void showTransliterationSuggestions(const QString& input, const QString& langCode, const QStringList& suggestions);
 
 private:
 
@@ -633,6 +719,94 @@ private:
      */
     block fromEditor(qint64 blockNumber) const;
 
+    /**
+     * @brief Renders a block as an editor line ("{speaker}: text {timestamp}").
+     *
+     * @param a_block The block to render.
+     * @return The line text, without the timestamp if timestamps are hidden.
+     */
+    QString blockLine(const block& a_block) const;
+
+    /**
+     * @brief Merges the text of an editor line back into `m_blocks`.
+     *
+     * Words that did not change keep their timestamps, tags and edited state.
+     *
+     * @param documentBlockNumber The document line to synchronise.
+     */
+    void syncBlockFromEditor(int documentBlockNumber);
+    /// Like syncBlockFromEditor(), for a line that may still show a time with a pending shift.
+    void syncShiftedBlockFromEditor(int documentBlockNumber);
+
+    /**
+     * @brief Rewrites the editor line of a block, if it is in the materialised window.
+     *
+     * @param cursor Cursor used for the edit, so callers can batch several lines in one edit block.
+     * @param blockNumber Index of the block in `m_blocks`.
+     */
+    void renderBlockLine(QTextCursor& cursor, int blockNumber);
+
+    /**
+     * @brief Shifts a range of blocks and their words, rendering only the affected lines in view.
+     */
+    void shiftTime(int first, int last, qint64 msecs);
+
+    /**
+     * @brief Folds the pending shifts of a range of blocks into the lines in view and the word editor.
+     *
+     * Lines out of view keep their shifts pending, and so their old rendered times,
+     * until they are scrolled into view or flushed.
+     */
+    void refreshBlockTimes(int first, int last);
+    void refreshWordEditorTimes(int first, int last);
+    void renderVisibleTimes();
+    /// Absolute indices of the first and last blocks in the viewport.
+    QPair<int, int> visibleBlockRange() const;
+
+    /**
+     * @brief Renders lines again after their times changed, outside the undo history.
+     */
+    void renderTimeLines(const QVector<int>& blockNumbers);
+
+    /**
+     * @brief Folds pending time shifts into one block, or into all blocks.
+     *
+     * A block with a pending shift is one whose rendered line still shows its old time.
+     * Reads of one block materialise it, which renders its line; bulk reads (save,
+     * export, the waveform) and user edits flush first. foldTimeOffsets() only
+     * updates the model, for callers that render every line anyway.
+     */
+    bool takeBlockTime(int blockNumber, bool* becameValid = nullptr);
+    void materializeBlockTime(int blockNumber);
+    QVector<qint64> foldTimeOffsets(bool* becameValid = nullptr);
+    void flushTimeOffsets();
+
+    /**
+     * @brief Renders the window of lines starting at a transcript line into the document.
+     *
+     * @param first Index in `m_blocks` of the first line of the window.
+     */
+    void materializeWindow(int first);
+
+    /**
+     * @brief Re-centres the window around a line when it gets close to a window edge.
+     *
+     * @param blockNumber Index in `m_blocks` of the line that should be visible.
+     */
+    void shiftWindow(int blockNumber);
+
+    /**
+     * @brief Follows the viewport and the transcript scroll bar in the virtualized view.
+     */
+    void onViewportScrolled(int value);
+    void onTranscriptScrolled(int value);
+    void syncTranscriptScrollBar();
+
+    /**
+     * @brief Revalidates all words and updates the highlighter with invalid, tagged and edited words.
+     */
+    void updateHighlights();
+
     /**
      * @brief Loads transcript data from an XML file into the editor.
      *
@@ -649,7 +823,6 @@ private:
 
     // State flags
     bool settingContent{false}; ///< Indicates if the editor is currently in a setting content mode.
-    bool updatingWordEditor{false}; ///< Indicates if the word editor is being updated.
     bool dontUpdateWordEditor{false}; ///< Flag to prevent updates to the word editor.
 
     // Configuration options
@@ -686,13 +859,33 @@ private:
     std::set<QString> m_correctedWords; ///< Set of words that have been corrected.
     QString m_transliterateLangCode; ///< Language code for transliteration.
 
-    // Network management
-    QStringList m_lastReplyList; ///< List of the last replies from network requests.
-    QNetworkAccessManager m_manager; ///< Network manager for handling requests.
-    QNetworkReply* m_reply = nullptr; ///< Pointer to the current network reply.
+    // Transliteration
+    Transliterator* m_transliterator = nullptr; ///< Asynchronous, cached transliteration service.
+
+    // Search
+    WordIndex m_wordIndex; ///< Inverted index over the words of m_blocks.
+    bool m_wordIndexDirty{true}; ///< Set when line numbers shift and the index must be rebuilt.
+
+    // Jumps
+    TimeStampIndex m_timeStampIndex; ///< Nearest preceding valid timestamp of every block and word.
+
+    // Time propagation
+    TimeOffsetTree m_timeOffsets; ///< Time shifts not yet applied to m_blocks.
+    int m_nudgeStep{100}; ///< Milliseconds shifted per nudge.
+
+    // Virtualized view
+    bool m_virtualized{false}; ///< Only a window of m_blocks is kept in the document.
+    int m_windowStart{0}; ///< Index in m_blocks of the first document line.
+    int m_windowCount{0}; ///< Number of lines in the document.
+    int m_windowSize{400}; ///< Lines materialised at once in the virtualized view.
+    int m_windowMargin{60}; ///< Lines left before a window edge that trigger a shift.
+    bool m_shiftingWindow{false}; ///< Set while the window is being rematerialised.
+    QScrollBar* m_transcriptScrollBar = nullptr; ///< Scroll bar spanning the whole transcript.
 
     // Auto-saving configuration
     QTimer* m_saveTimer = nullptr; ///< Timer for managing save intervals.
+    QFutureWatcher<bool> m_pdfExport; ///< Running PDF export, see saveAsPDF().
+    QString m_pdfExportFile; ///< File the running or last PDF export writes.
     int m_saveInterval{20}; ///< Interval in seconds for auto-saving documents.
 
     // Clipboard management
@@ -26,7 +26,7 @@ TextEditor::TextEditor(QWidget *parent) : QPlainTextEdit(parent)
 int TextEditor::lineNumberAreaWidth()
 {
     int digits = 1;
-    int max = qMax(1, blockCount());
+    int max = qMax(1, totalBlockCount());
     while (max >= 10) {
         max /= 10;
         ++digits;
@@ -52,9 +52,58 @@ void TextEditor::findReplace()
     m_findReplace->show();
 }
 
+int TextEditor::replaceAll(const FindReplaceQuery& query, const QString& replacement)
+{
+    FindReplaceEngine engine(query);
+    if (!engine.isValid())
+        return 0;
+
+    int firstLine = qMax(0, query.firstBlock);
+    int lastLine = query.lastBlock < 0 ? blockCount() - 1 : qMin(query.lastBlock, blockCount() - 1);
+
+    // Plain documents have no speakers, so only the line range applies here
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    int replacementCount{0};
+    for (int i = lastLine; i >= firstLine; i--) {
+        auto textBlock = document()->findBlockByNumber(i);
+        auto text = textBlock.text();
+        int matches{0};
+        auto it = engine.expression().globalMatch(text);
+        while (it.hasNext())
+            if (it.next().capturedLength())
+                matches++;
+        if (!matches)
+            continue;
+
+        auto replaced = text;
+        replaced.replace(engine.expression(), replacement);
+        replacementCount += matches;
+
+        cursor.setPosition(textBlock.position());
+        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        cursor.insertText(replaced);
+    }
+    cursor.endEditBlock();
+
+    return replacementCount;
+}
+
+bool TextEditor::inFindScope(int blockIndex, const FindReplaceQuery& query) const
+{
+    // Plain documents have no speakers, so only the line range applies here
+    return blockIndex >= query.firstBlock && (query.lastBlock < 0 || blockIndex <= query.lastBlock);
+}
+
 void TextEditor::updateLineNumberAreaWidth(int /* newBlockCount */)
 {
-    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    setViewportMargins(lineNumberAreaWidth(), 0, m_rightMargin, 0);
+}
+
+void TextEditor::setRightMargin(int margin)
+{
+    m_rightMargin = margin;
+    updateLineNumberAreaWidth(0);
 }
 
 void TextEditor::updateLineNumberArea(const QRect &rect, int dy)
@@ -135,7 +184,7 @@ void TextEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 
 
     QTextBlock block = firstVisibleBlock();
-    int blockNumber = block.blockNumber();
+    int blockNumber = block.blockNumber() + firstBlockIndex();
     int top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
     int bottom = top + qRound(blockBoundingRect(block).height());
 
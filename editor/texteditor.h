@@ -24,6 +24,16 @@ public:
         lineNumberArea->setFont(font);
     }
 
+    // Replaces every match of the query in the document, returns the number of replacements
+    virtual int replaceAll(const FindReplaceQuery& query, const QString& replacement);
+    // Whether the line with absolute index blockIndex is in the query's scope
+    virtual bool inFindScope(int blockIndex, const FindReplaceQuery& query) const;
+
+    // Absolute index of the first document block, for views that only hold part of a transcript
+    virtual int firstBlockIndex() const { return 0; }
+    virtual int totalBlockCount() const { return blockCount(); }
+    void setRightMargin(int margin);
+
 public slots:
     void findReplace();
 
@@ -43,6 +53,7 @@ private slots:
 private:
     QWidget *lineNumberArea;
     FindReplaceDialog *m_findReplace = nullptr;
+    int m_rightMargin = 0;
     // QTimer *m_debounceTimer = nullptr;
     // void processContentChanges();
     // void highlightSyntaxInBackground();
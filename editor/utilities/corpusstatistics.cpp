@@ -0,0 +1,142 @@
+#include "corpusstatistics.h"
+
+#include "transcriptdictionary.h"
+#include "transcriptio.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+struct Chunk
+{
+    QStringList files;
+    int firstFile{0};
+};
+
+CorpusStatistics::Table countChunk(const Chunk& chunk, const QString& language)
+{
+    CorpusStatistics::Table table;
+    for (int i = 0; i < chunk.files.size(); i++) {
+        QFile file(chunk.files[i]);
+        Transcript transcript;
+        if (!file.open(QIODevice::ReadOnly) || !TranscriptIO::readXml(&file, transcript)) {
+            table.failedFiles++;
+            continue;
+        }
+        table.files++;
+
+        auto dictionaryLanguage = !language.isEmpty() ? language
+                                  : !transcript.language.isEmpty() ? transcript.language : QString("english");
+        int fileNumber = chunk.firstFile + i;
+
+        for (auto& a_block: std::as_const(transcript.blocks)) {
+            for (auto& a_word: a_block.words) {
+                auto text = TranscriptDictionary::normalizeWord(a_word.text);
+                if (text.isEmpty() || TranscriptDictionary::isTimeStamp(text))
+                    continue;
+
+                auto& count = table.counts[{dictionaryLanguage, text}];
+                count.occurrences++;
+                if (count.lastFile != fileNumber) {
+                    count.lastFile = fileNumber;
+                    count.files++;
+                }
+                table.tokens++;
+            }
+        }
+    }
+    return table;
+}
+
+// Chunks hold files from one worker, so file counts simply add up
+void mergeTable(CorpusStatistics::Table& merged, const CorpusStatistics::Table& table)
+{
+    merged.files += table.files;
+    merged.failedFiles += table.failedFiles;
+    merged.tokens += table.tokens;
+
+    if (merged.counts.isEmpty()) {
+        merged.counts = table.counts;
+        return;
+    }
+
+    merged.counts.reserve(merged.counts.size() + table.counts.size() / 2);
+    for (auto it = table.counts.cbegin(); it != table.counts.cend(); ++it) {
+        auto& count = merged.counts[it.key()];
+        count.occurrences += it->occurrences;
+        count.files += it->files;
+    }
+}
+
+}
+
+QStringList CorpusStatistics::transcriptFiles(const QString& directory, bool recursive)
+{
+    QStringList files;
+    QDirIterator it(directory, {"*.xml"}, QDir::Files,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext())
+        files.append(it.next());
+    files.sort();
+    return files;
+}
+
+QFuture<CorpusStatistics::Table> CorpusStatistics::count(const QStringList& files, const QString& language)
+{
+    // Several chunks per thread keep the workers busy when file sizes vary
+    int threads = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    int chunkSize = qBound(1, int(files.size()) / (threads * 8), 256);
+
+    QList<Chunk> chunks;
+    for (int first = 0; first < files.size(); first += chunkSize)
+        chunks.append({files.mid(first, chunkSize), first});
+
+    return QtConcurrent::mappedReduced<Table>(
+        chunks,
+        [language](const Chunk& chunk) { return countChunk(chunk, language); },
+        mergeTable,
+        QtConcurrent::UnorderedReduce);
+}
+
+QVector<CorpusStatistics::Entry> CorpusStatistics::rank(const Table& table)
+{
+    QHash<QString, std::shared_ptr<TranscriptDictionary>> dictionaries;
+
+    QVector<Entry> entries;
+    entries.reserve(table.counts.size());
+    for (auto it = table.counts.cbegin(); it != table.counts.cend(); ++it) {
+        auto& language = it.key().first;
+        auto& dictionary = dictionaries[language];
+        if (!dictionary)
+            dictionary = std::make_shared<TranscriptDictionary>(language);
+
+        entries.append({language, it.key().second, it->occurrences, it->files, dictionary->contains(it.key().second)});
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.occurrences != b.occurrences)
+            return a.occurrences > b.occurrences;
+        return a.word < b.word;
+    });
+    return entries;
+}
+
+bool CorpusStatistics::writeWordList(const QVector<Entry>& entries, const QString& fileName, qint64 minimumOccurrences)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    for (auto& entry: entries)
+        if (!entry.known && entry.occurrences >= minimumOccurrences)
+            file.write(entry.word.toUtf8() + "\n");
+
+    return file.commit();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QFuture>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @class CorpusStatistics
+ * @brief Word frequencies over a folder of transcripts and the words missing from the dictionaries.
+ *
+ * Files are split into chunks that each worker counts into its own hash table,
+ * the tables are then merged (map-reduce on the global thread pool). Words are
+ * normalized as the highlighter does before they are looked up, and every
+ * distinct word is looked up only once, after merging.
+ */
+class CorpusStatistics
+{
+public:
+    using Key = QPair<QString, QString>; ///< Dictionary language and normalized word.
+
+    struct Count
+    {
+        qint64 occurrences{0};
+        int files{0};
+        int lastFile{-1}; ///< Counts every file once.
+    };
+
+    struct Table
+    {
+        QHash<Key, Count> counts;
+        int files{0};
+        int failedFiles{0};
+        qint64 tokens{0};
+    };
+
+    struct Entry
+    {
+        QString language;
+        QString word;
+        qint64 occurrences{0};
+        int files{0};
+        bool known{false};
+    };
+
+    /// Transcript XMLs under \a directory.
+    static QStringList transcriptFiles(const QString& directory, bool recursive = true);
+
+    /**
+     * @brief Counts the words of \a files on the global thread pool.
+     *
+     * Words are counted against \a language, or each transcript's own language if empty.
+     * Progress is reported in chunks of files and the future can be cancelled.
+     */
+    static QFuture<Table> count(const QStringList& files, const QString& language = QString());
+
+    /// Entries of \a table ranked by occurrences, with \c known set from the dictionaries.
+    static QVector<Entry> rank(const Table& table);
+
+    /// Writes the unknown words seen at least \a minimumOccurrences times, one per line as custom dictionaries are read.
+    static bool writeWordList(const QVector<Entry>& entries, const QString& fileName, qint64 minimumOccurrences = 1);
+};
@@ -0,0 +1,198 @@
+#include "corpusstatisticsdialog.h"
+
+#include <QDir>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+CorpusStatisticsDialog::CorpusStatisticsDialog(QWidget* parent)
+    : QDialog(parent),
+    m_folder(new QLineEdit(this)), m_language(new QLineEdit(this)), m_recursive(new QCheckBox("Subfolders", this)),
+    m_analyze(new QPushButton("Analyze", this)), m_progress(new QProgressBar(this)),
+    m_unknownOnly(new QCheckBox("Unknown words only", this)), m_minimumCount(new QSpinBox(this)),
+    m_words(new QTreeWidget(this)), m_status(new QLabel(this)),
+    m_save(new QPushButton("Save Word List...", this)), m_useAsDictionary(new QPushButton("Use as Custom Dictionary...", this))
+{
+    setWindowTitle("Corpus Statistics");
+    resize(640, 560);
+
+    m_folder->setPlaceholderText("Folder of transcripts");
+    m_language->setPlaceholderText("Each transcript's language");
+    m_language->setToolTip("Dictionary to check every transcript against, empty for the language of each transcript");
+    m_recursive->setChecked(true);
+    m_unknownOnly->setChecked(true);
+    m_minimumCount->setRange(1, 1000000);
+    m_minimumCount->setPrefix("Seen at least ");
+    m_minimumCount->setSuffix(" times");
+    m_progress->setVisible(false);
+    m_save->setEnabled(false);
+    m_useAsDictionary->setEnabled(false);
+
+    m_words->setColumnCount(4);
+    m_words->setHeaderLabels({"Word", "Language", "Count", "Files"});
+    m_words->setRootIsDecorated(false);
+    m_words->setUniformRowHeights(true);
+    m_words->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    auto browseButton = new QPushButton("Browse...", this);
+
+    auto source = new QHBoxLayout;
+    source->addWidget(m_folder);
+    source->addWidget(browseButton);
+
+    auto options = new QHBoxLayout;
+    options->addWidget(m_language);
+    options->addWidget(m_recursive);
+    options->addStretch();
+    options->addWidget(m_analyze);
+
+    auto filters = new QHBoxLayout;
+    filters->addWidget(m_unknownOnly);
+    filters->addWidget(m_minimumCount);
+    filters->addStretch();
+
+    auto actions = new QHBoxLayout;
+    actions->addWidget(m_status);
+    actions->addStretch();
+    actions->addWidget(m_save);
+    actions->addWidget(m_useAsDictionary);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(source);
+    layout->addLayout(options);
+    layout->addWidget(m_progress);
+    layout->addLayout(filters);
+    layout->addWidget(m_words);
+    layout->addLayout(actions);
+
+    connect(browseButton, &QPushButton::clicked, this, &CorpusStatisticsDialog::chooseFolder);
+    connect(m_analyze, &QPushButton::clicked, this, &CorpusStatisticsDialog::analyze);
+    connect(m_unknownOnly, &QCheckBox::toggled, this, &CorpusStatisticsDialog::updateList);
+    connect(m_minimumCount, &QSpinBox::valueChanged, this, &CorpusStatisticsDialog::updateList);
+
+    connect(&m_watcher, &QFutureWatcher<CorpusStatistics::Table>::progressRangeChanged, m_progress, &QProgressBar::setRange);
+    connect(&m_watcher, &QFutureWatcher<CorpusStatistics::Table>::progressValueChanged, m_progress, &QProgressBar::setValue);
+    connect(&m_watcher, &QFutureWatcher<CorpusStatistics::Table>::finished, this, [this]() {
+        if (!m_watcher.isCanceled())
+            m_status->setText("Ranking words...");
+    });
+    connect(&m_rankWatcher, &QFutureWatcher<Results>::finished, this, &CorpusStatisticsDialog::showResults);
+
+    connect(m_save, &QPushButton::clicked, this, [this]() {
+        auto fileName = QFileDialog::getSaveFileName(this, "Save Word List", QString(), "Text Files (*.txt)");
+        if (!fileName.isEmpty())
+            saveWordList(fileName);
+    });
+    connect(m_useAsDictionary, &QPushButton::clicked, this, [this]() {
+        auto fileName = QFileDialog::getSaveFileName(this, "Save Custom Dictionary", QString(), "Text Files (*.txt)");
+        if (!fileName.isEmpty() && saveWordList(fileName))
+            emit customDictionaryRequested(fileName);
+    });
+}
+
+CorpusStatisticsDialog::~CorpusStatisticsDialog()
+{
+    m_watcher.cancel();
+    m_rankWatcher.cancel();
+    m_rankWatcher.waitForFinished();
+}
+
+void CorpusStatisticsDialog::chooseFolder()
+{
+    auto folder = QFileDialog::getExistingDirectory(this, "Transcript Folder", m_folder->text());
+    if (!folder.isEmpty())
+        m_folder->setText(folder);
+}
+
+void CorpusStatisticsDialog::analyze()
+{
+    // The same button cancels a running analysis
+    if (m_rankWatcher.isRunning()) {
+        m_watcher.cancel();
+        m_rankWatcher.cancel();
+        return;
+    }
+
+    auto files = CorpusStatistics::transcriptFiles(m_folder->text(), m_recursive->isChecked());
+    if (files.isEmpty()) {
+        m_status->setText("No transcripts in this folder");
+        return;
+    }
+
+    m_entries.clear();
+    m_words->clear();
+    m_save->setEnabled(false);
+    m_useAsDictionary->setEnabled(false);
+    m_progress->setValue(0);
+    m_progress->setVisible(true);
+    m_analyze->setText("Cancel");
+    m_status->setText(QString("Counting words of %1 transcripts...").arg(files.size()));
+
+    // Ranking loads dictionaries and sorts every distinct word, which can take a while on a large corpus
+    auto counting = CorpusStatistics::count(files, m_language->text().trimmed());
+    m_watcher.setFuture(counting);
+    m_rankWatcher.setFuture(counting.then(QtFuture::Launch::Async, [](const CorpusStatistics::Table& table) {
+        return Results{table.files, table.failedFiles, table.tokens, CorpusStatistics::rank(table)};
+    }));
+}
+
+void CorpusStatisticsDialog::showResults()
+{
+    m_progress->setVisible(false);
+    m_analyze->setText("Analyze");
+
+    if (m_rankWatcher.isCanceled()) {
+        m_status->setText("Cancelled");
+        return;
+    }
+
+    auto results = m_rankWatcher.result();
+    m_entries = std::move(results.entries);
+
+    qint64 unknownTokens{0};
+    int unknownWords{0};
+    for (auto& entry: std::as_const(m_entries)) {
+        if (!entry.known) {
+            unknownWords++;
+            unknownTokens += entry.occurrences;
+        }
+    }
+
+    m_status->setText(QString("%1 files (%2 unreadable), %3 words, %4 distinct, %5 unknown (%6 occurrences)")
+                          .arg(results.files).arg(results.failedFiles).arg(results.tokens)
+                          .arg(m_entries.size()).arg(unknownWords).arg(unknownTokens));
+    m_save->setEnabled(unknownWords > 0);
+    m_useAsDictionary->setEnabled(unknownWords > 0);
+    updateList();
+}
+
+void CorpusStatisticsDialog::updateList()
+{
+    m_words->clear();
+
+    QList<QTreeWidgetItem*> items;
+    for (auto& entry: std::as_const(m_entries)) {
+        // Ranked by count, so the rest are rarer still
+        if (entry.occurrences < m_minimumCount->value() || items.size() >= maxListedWords)
+            break;
+        if (m_unknownOnly->isChecked() && entry.known)
+            continue;
+
+        auto item = new QTreeWidgetItem({entry.word, entry.language, QString::number(entry.occurrences), QString::number(entry.files)});
+        item->setTextAlignment(2, Qt::AlignRight);
+        item->setTextAlignment(3, Qt::AlignRight);
+        items.append(item);
+    }
+    m_words->addTopLevelItems(items);
+}
+
+bool CorpusStatisticsDialog::saveWordList(const QString& fileName)
+{
+    if (!CorpusStatistics::writeWordList(m_entries, fileName, m_minimumCount->value())) {
+        m_status->setText("Couldn't write " + fileName);
+        return false;
+    }
+    m_status->setText("Saved " + QDir::toNativeSeparators(fileName));
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "corpusstatistics.h"
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTreeWidget>
+
+/**
+ * @class CorpusStatisticsDialog
+ * @brief Counts the words of a folder of transcripts in the background and lists the unknown ones.
+ *
+ * The unknown words can be saved as a word list, or saved and used as the
+ * editor's custom dictionary right away.
+ */
+class CorpusStatisticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CorpusStatisticsDialog(QWidget* parent = nullptr);
+    ~CorpusStatisticsDialog() override;
+
+signals:
+    void customDictionaryRequested(const QString& fileName);
+
+private slots:
+    void chooseFolder();
+    void analyze();
+    void showResults();
+    void updateList();
+
+private:
+    /// What the dialog keeps of a finished analysis, ranked off the GUI thread.
+    struct Results
+    {
+        int files{0};
+        int failedFiles{0};
+        qint64 tokens{0};
+        QVector<CorpusStatistics::Entry> entries;
+    };
+
+    bool saveWordList(const QString& fileName);
+
+    QLineEdit* m_folder;
+    QLineEdit* m_language;
+    QCheckBox* m_recursive;
+    QPushButton* m_analyze;
+    QProgressBar* m_progress;
+    QCheckBox* m_unknownOnly;
+    QSpinBox* m_minimumCount;
+    QTreeWidget* m_words;
+    QLabel* m_status;
+    QPushButton* m_save;
+    QPushButton* m_useAsDictionary;
+
+    QFutureWatcher<CorpusStatistics::Table> m_watcher; ///< Counting, for its progress.
+    QFutureWatcher<Results> m_rankWatcher;              ///< Counting followed by ranking.
+    QVector<CorpusStatistics::Entry> m_entries;
+
+    static constexpr int maxListedWords = 5000;
+};
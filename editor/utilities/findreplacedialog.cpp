@@ -1,7 +1,8 @@
 #include "findreplacedialog.h"
 #include "ui_findreplacedialog.h"
+#include "editor/texteditor.h"
 
-FindReplaceDialog::FindReplaceDialog(QPlainTextEdit *parentEditor)
+FindReplaceDialog::FindReplaceDialog(TextEditor *parentEditor)
     : QDialog (parentEditor),
     m_Editor(parentEditor),
     ui (new Ui::FindReplaceDialog)
@@ -14,6 +15,7 @@ FindReplaceDialog::FindReplaceDialog(QPlainTextEdit *parentEditor)
 
     connect(ui->whole_words, &QCheckBox::toggled, this, &FindReplaceDialog::updateFlags);
     connect(ui->case_sensitive, &QCheckBox::toggled, this, &FindReplaceDialog::updateFlags);
+    connect(ui->scope, &QComboBox::currentIndexChanged, this, &FindReplaceDialog::updateScope);
 
     flags = flags | QTextDocument::FindCaseSensitively;
 
@@ -22,6 +24,8 @@ FindReplaceDialog::FindReplaceDialog(QPlainTextEdit *parentEditor)
         ui->text_find->setText(textCursor.selectedText());
     textCursor.movePosition(QTextCursor::Start, QTextCursor::MoveAnchor, 1);
     m_Editor->setTextCursor(textCursor);
+
+    updateScope();
 }
 
 FindReplaceDialog::~FindReplaceDialog()
@@ -41,6 +45,60 @@ void FindReplaceDialog::updateFlags()
     flags = tmp;
 }
 
+void FindReplaceDialog::updateScope()
+{
+    int lineCount = m_Editor->totalBlockCount();
+    ui->scope_from->setMaximum(lineCount);
+    ui->scope_to->setMaximum(lineCount);
+    if (ui->scope_to->value() < ui->scope_from->value())
+        ui->scope_to->setValue(lineCount);
+
+    ui->scope_speaker->setVisible(ui->scope->currentIndex() == 1);
+    ui->scope_from->setVisible(ui->scope->currentIndex() == 2);
+    ui->scope_to->setVisible(ui->scope->currentIndex() == 2);
+}
+
+FindReplaceQuery FindReplaceDialog::currentQuery() const
+{
+    FindReplaceQuery query;
+    query.pattern = ui->text_find->text();
+    query.regularExpression = ui->regular_expression->isChecked();
+    query.wholeWords = ui->whole_words->isChecked();
+    query.caseSensitive = ui->case_sensitive->isChecked();
+
+    if (ui->scope->currentIndex() == 1)
+        query.speaker = ui->scope_speaker->text().trimmed();
+    else if (ui->scope->currentIndex() == 2) {
+        query.firstBlock = ui->scope_from->value() - 1;
+        query.lastBlock = ui->scope_to->value() - 1;
+    }
+    return query;
+}
+
+bool FindReplaceDialog::findInEditor(QTextDocument::FindFlags findFlags)
+{
+    auto query = currentQuery();
+    FindReplaceEngine engine(query);
+    if (ui->regular_expression->isChecked() && !engine.isValid()) {
+        emit message(engine.errorString());
+        return false;
+    }
+
+    // Matches outside the scope are stepped over, the cursor stays put if none is left
+    auto start = m_Editor->textCursor();
+    bool backward = findFlags & QTextDocument::FindBackward;
+    while (ui->regular_expression->isChecked() ? m_Editor->find(engine.expression(), findFlags & QTextDocument::FindBackward)
+                                               : m_Editor->find(ui->text_find->text(), findFlags)) {
+        int blockIndex = m_Editor->firstBlockIndex() + m_Editor->textCursor().blockNumber();
+        if (m_Editor->inFindScope(blockIndex, query))
+            return true;
+        if (backward ? blockIndex < query.firstBlock : query.lastBlock >= 0 && blockIndex > query.lastBlock)
+            break;
+    }
+    m_Editor->setTextCursor(start);
+    return false;
+}
+
 void FindReplaceDialog::findNext()
 {
     if (!m_Editor->textCursor().hasSelection()) {
@@ -50,8 +108,7 @@ void FindReplaceDialog::findNext()
     }
 
     QString query = ui->text_find->text();
-    m_Editor->find(query, flags);
-    if (m_Editor->textCursor().hasSelection() && m_Editor->textCursor().selectedText() == query)
+    if (findInEditor(flags))
         emit message("Found word " + query + ".");
 }
 
@@ -64,8 +121,7 @@ void FindReplaceDialog::findPrevious()
     }
 
     QString query = ui->text_find->text();
-    m_Editor->find(query, QTextDocument::FindBackward | flags);
-    if (m_Editor->textCursor().hasSelection() && m_Editor->textCursor().selectedText() == query)
+    if (findInEditor(QTextDocument::FindBackward | flags))
         emit message("Found word " + query + ".");
 }
 
@@ -76,11 +132,20 @@ void FindReplaceDialog::replace()
         emit message("No selected words");
     else if (replacementString != "")
     {
-        if (m_Editor->textCursor().selectedText() == ui->text_find->text())
+        QString selectedText = m_Editor->textCursor().selectedText();
+        if (ui->regular_expression->isChecked()) {
+            FindReplaceEngine engine(currentQuery());
+            auto match = engine.expression().match(selectedText);
+            if (!match.hasMatch() || match.capturedStart() != 0 || match.capturedLength() != selectedText.size())
+                return;
+            // The same text Replace All would put there
+            m_Editor->textCursor().insertText(engine.expandReplacement(match, replacementString));
+        }
+        else if (selectedText == ui->text_find->text())
             m_Editor->textCursor().insertText(replacementString);
         //if case sensitive is off
         else if (!ui->case_sensitive->isChecked()
-                 && m_Editor->textCursor().selectedText().toLower() == ui->text_find->text().toLower())
+                 && selectedText.toLower() == ui->text_find->text().toLower())
             m_Editor->textCursor().insertText(replacementString);
         else
             return;
@@ -91,18 +156,14 @@ void FindReplaceDialog::replace()
 
 void FindReplaceDialog::replaceAll()
 {
-    QTextCursor textCursor = m_Editor->textCursor();
-    textCursor.movePosition(QTextCursor::Start, QTextCursor::MoveAnchor,1);
-    m_Editor->setTextCursor(textCursor);
-
-    QString query = ui->text_find->text();
-    QString replacementString = ui->text_replace->text();
-    short replacementCount{0};
-
-    while (m_Editor->find(query, flags)) {
-        m_Editor->textCursor().insertText(replacementString);
-        ++replacementCount;
+    auto query = currentQuery();
+    FindReplaceEngine engine(query);
+    if (!engine.isValid()) {
+        emit message(engine.errorString());
+        return;
     }
 
+    int replacementCount = m_Editor->replaceAll(query, ui->text_replace->text());
+
     emit message("Replaced " + QString::number(replacementCount) + " occurences.");
 }
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "findreplaceengine.h"
+
 #include <QDialog>
-#include <QPlainTextEdit>
+#include <QTextDocument>
+
+class TextEditor;
 
 namespace Ui {
 class FindReplaceDialog;
@@ -11,7 +15,7 @@ class FindReplaceDialog : public QDialog
 {
     Q_OBJECT
 public:
-    explicit FindReplaceDialog(QPlainTextEdit *parentEditor);
+    explicit FindReplaceDialog(TextEditor *parentEditor);
     ~FindReplaceDialog();
 
 private slots:
@@ -20,11 +24,15 @@ private slots:
     void findNext();
     void replace();
     void replaceAll();
+    void updateScope();
 signals:
     void message(const QString& text, int timeout = 2000);
 
 private:
-    QPlainTextEdit *m_Editor = nullptr;
+    FindReplaceQuery currentQuery() const;
+    bool findInEditor(QTextDocument::FindFlags findFlags);
+
+    TextEditor *m_Editor = nullptr;
     Ui::FindReplaceDialog *ui;
     QTextDocument::FindFlags flags;
 };
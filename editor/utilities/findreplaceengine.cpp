@@ -0,0 +1,231 @@
+#include "findreplaceengine.h"
+
+namespace {
+
+QString joinedText(const block& a_block)
+{
+    if (a_block.words.isEmpty())
+        return a_block.text;
+
+    QStringList texts;
+    texts.reserve(a_block.words.size());
+    for (auto& a_word: a_block.words)
+        texts.append(a_word.text);
+    return texts.join(" ");
+}
+
+struct Region
+{
+    int firstWord;
+    int lastWord;
+    QVector<int> matches;
+};
+
+}
+
+FindReplaceEngine::FindReplaceEngine(const FindReplaceQuery& query)
+    : m_query(query)
+{
+    QString pattern = m_query.regularExpression ? m_query.pattern
+                                                : QRegularExpression::escape(m_query.pattern);
+
+    // \b does not treat combining marks as word characters, which breaks most Indic scripts
+    if (m_query.wholeWords)
+        pattern = R"((?<![\p{L}\p{M}\p{N}_])(?:)" + pattern + R"()(?![\p{L}\p{M}\p{N}_]))";
+
+    QRegularExpression::PatternOptions options = QRegularExpression::UseUnicodePropertiesOption;
+    if (!m_query.caseSensitive)
+        options |= QRegularExpression::CaseInsensitiveOption;
+
+    m_expression = QRegularExpression(pattern, options);
+}
+
+bool FindReplaceEngine::isValid() const
+{
+    return !m_query.pattern.isEmpty() && m_expression.isValid();
+}
+
+QString FindReplaceEngine::errorString() const
+{
+    if (m_query.pattern.isEmpty())
+        return "Nothing to find";
+    return m_expression.errorString();
+}
+
+bool FindReplaceEngine::inScope(const QVector<block>& blocks, int blockNumber) const
+{
+    if (blockNumber < m_query.firstBlock)
+        return false;
+    if (m_query.lastBlock >= 0 && blockNumber > m_query.lastBlock)
+        return false;
+    return m_query.speaker.isEmpty() || blocks[blockNumber].speaker == m_query.speaker;
+}
+
+QVector<int> FindReplaceEngine::replaceAll(QVector<block>& blocks, const QString& replacement, int* replacementCount) const
+{
+    QVector<int> changedBlocks;
+    int count = 0;
+
+    if (isValid()) {
+        for (int i = qMax(0, m_query.firstBlock); i < blocks.size(); i++) {
+            if (!inScope(blocks, i))
+                continue;
+
+            QVector<QRegularExpressionMatch> matches;
+            QVector<QString> replacements;
+            auto it = m_expression.globalMatch(joinedText(blocks[i]));
+            while (it.hasNext()) {
+                auto match = it.next();
+                if (!match.capturedLength())
+                    continue;
+                replacements.append(expandReplacement(match, replacement));
+                matches.append(match);
+            }
+            if (matches.isEmpty())
+                continue;
+
+            int applied = replaceInBlock(blocks[i], matches, replacements);
+            if (!applied)
+                continue;
+            changedBlocks.append(i);
+            count += applied;
+        }
+    }
+
+    if (replacementCount)
+        *replacementCount = count;
+    return changedBlocks;
+}
+
+QString FindReplaceEngine::expandReplacement(const QRegularExpressionMatch& match, const QString& replacement) const
+{
+    if (!m_query.regularExpression || !replacement.contains('\\'))
+        return replacement;
+
+    QString expanded;
+    expanded.reserve(replacement.size());
+    for (int i = 0; i < replacement.size(); i++) {
+        if (replacement[i] == '\\' && i + 1 < replacement.size()) {
+            auto next = replacement[i + 1];
+            if (next.isDigit()) {
+                expanded.append(match.captured(next.digitValue()));
+                i++;
+                continue;
+            }
+            if (next == '\\') {
+                expanded.append('\\');
+                i++;
+                continue;
+            }
+        }
+        expanded.append(replacement[i]);
+    }
+    return expanded;
+}
+
+int FindReplaceEngine::replaceInBlock(block& a_block, const QVector<QRegularExpressionMatch>& matches,
+                                      const QVector<QString>& replacements)
+{
+    if (a_block.words.isEmpty()) {
+        for (auto& token: a_block.text.split(" "))
+            a_block.words.append(word(QTime(), token, QStringList()));
+    }
+
+    auto text = joinedText(a_block);
+    auto& words = a_block.words;
+
+    QVector<int> wordStart(words.size()), wordEnd(words.size());
+    for (int i = 0, position = 0; i < words.size(); i++) {
+        wordStart[i] = position;
+        wordEnd[i] = position + words[i].text.size();
+        position = wordEnd[i] + 1;
+    }
+
+    // Group matches into runs of whole words, merging runs that share a word. A match
+    // starting on a separator belongs to the word before it, one ending on a separator
+    // to the word after it, so the separator is inside the region's text.
+    QVector<Region> regions;
+    for (int m = 0; m < matches.size(); m++) {
+        int start = matches[m].capturedStart(), end = matches[m].capturedEnd();
+        if (start < 0 || end > text.size())
+            continue;
+
+        int first = 0;
+        while (first < words.size() - 1 && wordStart[first + 1] <= start)
+            first++;
+        int last = first;
+        while (last < words.size() - 1 && wordEnd[last] < end)
+            last++;
+
+        if (!regions.isEmpty() && first <= regions.last().lastWord) {
+            regions.last().lastWord = qMax(regions.last().lastWord, last);
+            regions.last().matches.append(m);
+        }
+        else {
+            regions.append({first, last, {m}});
+        }
+    }
+
+    QVector<word> newWords;
+    newWords.reserve(words.size());
+    int nextWord = 0;
+    int applied = 0;
+
+    for (auto& region: std::as_const(regions)) {
+        for (; nextWord < region.firstWord; nextWord++)
+            newWords.append(words[nextWord]);
+
+        int regionStart = wordStart[region.firstWord];
+        auto regionText = text.mid(regionStart, wordEnd[region.lastWord] - regionStart);
+        for (int k = region.matches.size() - 1; k >= 0; k--) {
+            auto& match = matches[region.matches[k]];
+            int offset = match.capturedStart() - regionStart;
+            if (offset < 0 || offset + match.capturedLength() > regionText.size())
+                continue;
+            regionText.replace(offset, match.capturedLength(), replacements[region.matches[k]]);
+            applied++;
+        }
+
+        auto tokens = regionText.split(" ", Qt::SkipEmptyParts);
+        int oldCount = region.lastWord - region.firstWord + 1;
+
+        if (tokens.size() == oldCount) {
+            for (int k = 0; k < oldCount; k++) {
+                word a_word = words[region.firstWord + k];
+                if (a_word.text != tokens[k]) {
+                    a_word.text = tokens[k];
+                    a_word.isEdited = "true";
+                }
+                newWords.append(a_word);
+            }
+        }
+        else if (!tokens.isEmpty()) {
+            QStringList tagList;
+            for (int k = region.firstWord; k <= region.lastWord; k++)
+                for (auto& tag: words[k].tagList)
+                    if (!tagList.contains(tag))
+                        tagList.append(tag);
+
+            for (int k = 0; k < tokens.size(); k++)
+                newWords.append(word(QTime(), tokens[k], k ? QStringList() : tagList, "true"));
+            newWords.last().timeStamp = words[region.lastWord].timeStamp;
+        }
+        else if (!newWords.isEmpty() && !newWords.last().timeStamp.isValid()) {
+            // Words were deleted, keep their end time on the preceding word
+            newWords.last().timeStamp = words[region.lastWord].timeStamp;
+        }
+
+        nextWord = region.lastWord + 1;
+    }
+    for (; nextWord < words.size(); nextWord++)
+        newWords.append(words[nextWord]);
+
+    QStringList texts;
+    texts.reserve(newWords.size());
+    for (auto& a_word: std::as_const(newWords))
+        texts.append(a_word.text);
+
+    a_block.words = newWords;
+    a_block.text = texts.join(" ");
+    return applied;
+}
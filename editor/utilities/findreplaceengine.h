@@ -0,0 +1,58 @@
+#pragma once
+
+#include "editor/blockandword.h"
+
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+struct FindReplaceQuery
+{
+    QString pattern;
+    bool regularExpression{false};
+    bool wholeWords{false};
+    bool caseSensitive{true};
+
+    QString speaker;    ///< Only search blocks of this speaker, empty for all speakers.
+    int firstBlock{0};  ///< First block of the search scope.
+    int lastBlock{-1};  ///< Last block of the search scope (inclusive), -1 for the last block.
+};
+
+/**
+ * @class FindReplaceEngine
+ * @brief Find and replace over the block/word model instead of the rendered document.
+ *
+ * All matches are collected first and then applied block by block, so a replace
+ * all is a single model mutation. Words that are not touched by a match keep
+ * their timestamps, tags and edited state.
+ */
+class FindReplaceEngine
+{
+public:
+    explicit FindReplaceEngine(const FindReplaceQuery& query);
+
+    bool isValid() const;
+    QString errorString() const;
+    const QRegularExpression& expression() const { return m_expression; }
+
+    /**
+     * @brief Replaces every match in scope.
+     * @param blocks The model to modify.
+     * @param replacement Replacement text, "\1".."\9" refer to capture groups in regex mode.
+     * @param replacementCount Receives the number of replaced matches.
+     * @return Indices of the blocks that were changed, in ascending order.
+     */
+    QVector<int> replaceAll(QVector<block>& blocks, const QString& replacement, int* replacementCount = nullptr) const;
+
+    /// Text that replaces \a match, with capture group references expanded in regex mode.
+    QString expandReplacement(const QRegularExpressionMatch& match, const QString& replacement) const;
+
+private:
+    bool inScope(const QVector<block>& blocks, int blockNumber) const;
+    /// Applies \a matches of the joined word texts to \a a_block, returns how many were applied.
+    static int replaceInBlock(block& a_block, const QVector<QRegularExpressionMatch>& matches,
+                              const QVector<QString>& replacements);
+
+    FindReplaceQuery m_query;
+    QRegularExpression m_expression;
+};
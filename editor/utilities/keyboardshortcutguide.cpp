@@ -45,6 +45,7 @@ void KeyboardShortcutGuide::fillDialog() {
     QStringList copy({"Copy", QKeySequence(Qt::CTRL | Qt::Key_C).toString()});
     QStringList paste({"Paste", QKeySequence(Qt::CTRL | Qt::Key_V).toString()});
     QStringList findReplace({"Find / Replace", QKeySequence(Qt::CTRL | Qt::Key_F).toString()});
+    QStringList searchTranscript({"Search Transcript", QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F).toString()});
     QStringList zoomIn({"Increase Font Size", QKeySequence(Qt::CTRL | Qt::Key_Equal).toString()});
     QStringList zoomOut({"Decrease Font Size", QKeySequence(Qt::CTRL | Qt::Key_Minus).toString()});
     QStringList saveTranscript({"Save Transcript", QKeySequence(Qt::CTRL | Qt::Key_S).toString()});
@@ -55,6 +56,8 @@ void KeyboardShortcutGuide::fillDialog() {
     QStringList toggleWordEditor({"Toggle Word Editor", QKeySequence(Qt::CTRL | Qt::Key_W).toString()});
     QStringList changeSpeaker({"Change Speaker", QKeySequence(Qt::CTRL | Qt::Key_R).toString()});
     QStringList propagateTime({"Propagate Time", QKeySequence(Qt::CTRL | Qt::Key_T).toString()});
+    QStringList nudgeTimeBack({"Shift Time of Following Lines Back", QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_Left).toString()});
+    QStringList nudgeTimeForward({"Shift Time of Following Lines Forward", QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_Right).toString()});
     QStringList editTags({"Edit Tags", QKeySequence(Qt::CTRL | Qt::Key_Apostrophe).toString()});
     QStringList markAsCorrect({"Mark word as correct", QKeySequence(Qt::CTRL | Qt::Key_M).toString()});
     QStringList markAsDoubtful({"Mark word as Doubtful", QKeySequence(Qt::CTRL | Qt::Key_I).toString()});
@@ -65,6 +68,7 @@ void KeyboardShortcutGuide::fillDialog() {
     editing->addChild(new QTreeWidgetItem(copy));
     editing->addChild(new QTreeWidgetItem(paste));
     editing->addChild(new QTreeWidgetItem(findReplace));
+    editing->addChild(new QTreeWidgetItem(searchTranscript));
     editing->addChild(new QTreeWidgetItem(zoomIn));
     editing->addChild(new QTreeWidgetItem(zoomOut));
     editing->addChild(new QTreeWidgetItem(saveTranscript));
@@ -75,6 +79,8 @@ void KeyboardShortcutGuide::fillDialog() {
     editing->addChild(new QTreeWidgetItem(toggleWordEditor));
     editing->addChild(new QTreeWidgetItem(changeSpeaker));
     editing->addChild(new QTreeWidgetItem(propagateTime));
+    editing->addChild(new QTreeWidgetItem(nudgeTimeBack));
+    editing->addChild(new QTreeWidgetItem(nudgeTimeForward));
     editing->addChild(new QTreeWidgetItem(editTags));
     editing->addChild(new QTreeWidgetItem(markAsCorrect));
     editing->addChild(new QTreeWidgetItem(markAsDoubtful));
@@ -0,0 +1,137 @@
+#include "pdfexporter.h"
+
+#include <QFile>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QTextLayout>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+
+const QColor speakerColor(0x1f, 0x4e, 0x8c);
+const QColor timeStampColor(0x80, 0x80, 0x80);
+
+}
+
+bool PdfExporter::write(const QVector<block>& blocks, const QString& fileName, const Options& options,
+                        QPromise<bool>* promise)
+{
+    QPdfWriter writer(fileName);
+    writer.setPageSize(options.pageSize);
+    writer.setResolution(options.resolution);
+    writer.setPageMargins(QMarginsF(18, 18, 18, 18), QPageLayout::Millimeter);
+    writer.setTitle(options.title);
+    writer.setCreator("Vagyojaka");
+
+    QPainter painter;
+    if (!painter.begin(&writer))
+        return false;
+
+    // Fonts have to be resolved against the writer for the layout to match the page
+    QFont bodyFont(options.font, &writer);
+    QFont speakerFont(bodyFont);
+    speakerFont.setBold(true);
+    QFont smallFont(bodyFont);
+    smallFont.setPointSizeF(bodyFont.pointSizeF() * 0.8);
+
+    QFontMetricsF bodyMetrics(bodyFont, &writer);
+    QFontMetricsF smallMetrics(smallFont, &writer);
+
+    // The painter's origin is the top left of the area inside the margins
+    const QRectF page(QPointF(0, 0), writer.pageLayout().paintRectPixels(writer.resolution()).size());
+    const qreal gutter = options.withTimeStamps ? smallMetrics.horizontalAdvance("00:00:00.000") + bodyMetrics.averageCharWidth() * 2 : 0;
+    const qreal paragraphSpacing = bodyMetrics.lineSpacing() * 0.5;
+    const qreal header = options.title.isEmpty() ? 0 : smallMetrics.lineSpacing() * 2;
+    const qreal footer = smallMetrics.lineSpacing() * 2;
+    const qreal textWidth = page.width() - gutter;
+
+    int pageNumber = 1;
+    qreal y = 0;
+
+    auto startPage = [&]() {
+        painter.setFont(smallFont);
+        painter.setPen(timeStampColor);
+        if (!options.title.isEmpty())
+            painter.drawText(QRectF(0, 0, page.width(), smallMetrics.lineSpacing()), Qt::AlignLeft | Qt::AlignTop, options.title);
+        painter.drawText(QRectF(0, page.height() - smallMetrics.lineSpacing(), page.width(), smallMetrics.lineSpacing()),
+                         Qt::AlignHCenter | Qt::AlignBottom, QString::number(pageNumber));
+        y = header;
+    };
+    auto nextPage = [&]() {
+        writer.newPage();
+        pageNumber++;
+        startPage();
+    };
+
+    if (promise)
+        promise->setProgressRange(0, blocks.size());
+    startPage();
+
+    for (int i = 0; i < blocks.size(); i++) {
+        if (promise && promise->isCanceled()) {
+            painter.end();
+            QFile::remove(fileName);
+            return false;
+        }
+
+        auto& a_block = blocks[i];
+        QString speaker = a_block.speaker.isEmpty() ? QString() : a_block.speaker + ": ";
+
+        QTextLayout layout(speaker + a_block.text, bodyFont, &writer);
+        QTextLayout::FormatRange speakerRange;
+        speakerRange.start = 0;
+        speakerRange.length = speaker.size();
+        speakerRange.format.setFont(speakerFont);
+        speakerRange.format.setForeground(speakerColor);
+        layout.setFormats({speakerRange});
+
+        QTextOption textOption;
+        textOption.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+        layout.setTextOption(textOption);
+
+        layout.beginLayout();
+        qreal height = 0;
+        for (auto line = layout.createLine(); line.isValid(); line = layout.createLine()) {
+            line.setLineWidth(textWidth);
+            line.setPosition(QPointF(0, height));
+            height += line.height();
+        }
+        layout.endLayout();
+
+        // Keep short lines in one piece, longer ones continue on the next page
+        const qreal bottom = page.height() - footer;
+        if (y + height > bottom && height <= bottom - header && y > header)
+            nextPage();
+
+        qreal top = y;
+        for (int j = 0; j < layout.lineCount(); j++) {
+            auto line = layout.lineAt(j);
+            if (y + line.height() > bottom) {
+                nextPage();
+                top = y - line.y();
+            }
+            painter.setPen(Qt::black);
+            line.draw(&painter, QPointF(gutter, top));
+            y = top + line.y() + line.height();
+
+            if (j == 0 && options.withTimeStamps && a_block.timeStamp.isValid()) {
+                painter.setFont(smallFont);
+                painter.setPen(timeStampColor);
+                painter.drawText(QPointF(0, top + line.y() + line.ascent()), a_block.timeStamp.toString("hh:mm:ss.zzz"));
+            }
+        }
+        y += paragraphSpacing;
+
+        if (promise && (i % 64 == 0 || i == blocks.size() - 1))
+            promise->setProgressValue(i + 1);
+    }
+
+    return painter.end();
+}
+
+QFuture<bool> PdfExporter::writeAsync(const QVector<block>& blocks, const QString& fileName, const Options& options)
+{
+    return QtConcurrent::run([blocks, fileName, options](QPromise<bool>& promise) {
+        promise.addResult(write(blocks, fileName, options, &promise));
+    });
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "editor/blockandword.h"
+
+#include <QFont>
+#include <QFuture>
+#include <QPageSize>
+#include <QPromise>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class PdfExporter
+ * @brief Paints transcript lines straight onto \c QPdfWriter pages.
+ *
+ * Lines are laid out and painted one at a time, so memory stays flat however
+ * long the transcript is, and nothing here needs the GUI thread. Each line is
+ * its speaker in bold followed by the text, with the line's timestamp in a
+ * gutter on the left.
+ */
+class PdfExporter
+{
+public:
+    struct Options
+    {
+        QString title;               ///< Printed at the top of every page, none if empty.
+        QFont font{"Sans Serif", 11};
+        QPageSize pageSize{QPageSize::A4};
+        bool withTimeStamps{true};
+        int resolution{300};
+    };
+
+    /**
+     * @brief Writes \a blocks as a PDF to \a fileName.
+     *
+     * With a \a promise, progress is reported in lines and the export stops
+     * (returning false) once the promise is cancelled.
+     */
+    static bool write(const QVector<block>& blocks, const QString& fileName, const Options& options,
+                      QPromise<bool>* promise = nullptr);
+
+    /// Runs write() on the global thread pool; cancelling the future stops the export.
+    static QFuture<bool> writeAsync(const QVector<block>& blocks, const QString& fileName, const Options& options);
+};
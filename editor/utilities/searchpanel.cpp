@@ -0,0 +1,95 @@
+#include "searchpanel.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+SearchPanel::SearchPanel(QWidget* parent)
+    : QWidget(parent),
+    m_query(new QLineEdit(this)), m_speaker(new QLineEdit(this)), m_tag(new QLineEdit(this)),
+    m_editedOnly(new QCheckBox("Edited only", this)), m_results(new QTreeWidget(this)), m_status(new QLabel(this))
+{
+    m_query->setPlaceholderText("Search words (use * for prefix)");
+    m_query->setClearButtonEnabled(true);
+    m_speaker->setPlaceholderText("Speaker");
+    m_tag->setPlaceholderText("Tag");
+
+    m_results->setColumnCount(4);
+    m_results->setHeaderLabels({"Line", "Speaker", "Time", "Context"});
+    m_results->setRootIsDecorated(false);
+    m_results->setUniformRowHeights(true);
+    m_results->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_results->header()->setStretchLastSection(true);
+
+    auto filters = new QHBoxLayout;
+    filters->addWidget(m_speaker);
+    filters->addWidget(m_tag);
+    filters->addWidget(m_editedOnly);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(m_query);
+    layout->addLayout(filters);
+    layout->addWidget(m_results);
+    layout->addWidget(m_status);
+
+    // Coalesce keystrokes, the query itself is cheap but repopulating the list is not
+    m_queryTimer.setSingleShot(true);
+    m_queryTimer.setInterval(120);
+    connect(&m_queryTimer, &QTimer::timeout, this, [this]() { emit queryChanged(currentQuery()); });
+
+    connect(m_query, &QLineEdit::textChanged, &m_queryTimer, qOverload<>(&QTimer::start));
+    connect(m_speaker, &QLineEdit::textChanged, &m_queryTimer, qOverload<>(&QTimer::start));
+    connect(m_tag, &QLineEdit::textChanged, &m_queryTimer, qOverload<>(&QTimer::start));
+    connect(m_editedOnly, &QCheckBox::toggled, &m_queryTimer, qOverload<>(&QTimer::start));
+
+    connect(m_results, &QTreeWidget::itemActivated, this, [this](QTreeWidgetItem* item) {
+        emit resultActivated(item->data(0, Qt::UserRole).toInt(), item->data(1, Qt::UserRole).toInt());
+    });
+}
+
+WordQuery SearchPanel::currentQuery() const
+{
+    auto query = WordQuery::fromString(m_query->text());
+    query.speaker = m_speaker->text().trimmed();
+    query.tag = m_tag->text().trimmed();
+    query.editedOnly = m_editedOnly->isChecked();
+    return query;
+}
+
+void SearchPanel::showResults(const QVector<WordPosition>& hits, const QVector<block>& blocks)
+{
+    m_results->clear();
+
+    QList<QTreeWidgetItem*> items;
+    int listed = qMin(int(hits.size()), maxListedResults);
+    items.reserve(listed);
+
+    for (int i = 0; i < listed; i++) {
+        auto& hit = hits[i];
+        auto& a_block = blocks[hit.blockNumber];
+        auto& a_word = a_block.words[hit.wordNumber];
+
+        QStringList context;
+        for (int j = qMax(0, hit.wordNumber - 4); j < qMin(int(a_block.words.size()), hit.wordNumber + 5); j++)
+            context.append(j == hit.wordNumber ? "[" + a_block.words[j].text + "]" : a_block.words[j].text);
+
+        auto item = new QTreeWidgetItem({QString::number(hit.blockNumber + 1), a_block.speaker,
+                                         a_word.timeStamp.isValid() ? a_word.timeStamp.toString("hh:mm:ss.zzz") : "",
+                                         context.join(" ")});
+        item->setData(0, Qt::UserRole, hit.blockNumber);
+        item->setData(1, Qt::UserRole, hit.wordNumber);
+        items.append(item);
+    }
+    m_results->addTopLevelItems(items);
+
+    if (hits.size() > listed)
+        m_status->setText(QString("%1 matches, showing the first %2").arg(hits.size()).arg(listed));
+    else
+        m_status->setText(QString("%1 matches").arg(hits.size()));
+}
+
+void SearchPanel::focusQuery()
+{
+    m_query->setFocus();
+    m_query->selectAll();
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "wordindex.h"
+
+#include <QCheckBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QWidget>
+
+/**
+ * @class SearchPanel
+ * @brief Transcript-wide word search with speaker, tag and edited filters.
+ *
+ * The panel only builds queries and lists results; the owner runs the query
+ * against an editor and routes activated results back to it.
+ */
+class SearchPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SearchPanel(QWidget* parent = nullptr);
+
+    WordQuery currentQuery() const;
+
+public slots:
+    void showResults(const QVector<WordPosition>& hits, const QVector<block>& blocks);
+    void focusQuery();
+
+signals:
+    void queryChanged(const WordQuery& query);
+    void resultActivated(int blockNumber, int wordNumber);
+
+private:
+    QLineEdit* m_query;
+    QLineEdit* m_speaker;
+    QLineEdit* m_tag;
+    QCheckBox* m_editedOnly;
+    QTreeWidget* m_results;
+    QLabel* m_status;
+    QTimer m_queryTimer;
+
+    static constexpr int maxListedResults = 2000;
+};
@@ -0,0 +1,79 @@
+#include "timeoffsettree.h"
+
+void TimeOffsetTree::reset(int size)
+{
+    m_tree.fill(0, size + 1);
+    m_differences.fill(0, size);
+    m_pending = false;
+}
+
+void TimeOffsetTree::add(int index, qint64 msecs)
+{
+    if (index >= m_differences.size())
+        return;
+
+    m_differences[index] += msecs;
+    for (int i = index + 1; i < m_tree.size(); i += i & -i)
+        m_tree[i] += msecs;
+}
+
+void TimeOffsetTree::addRange(int first, int last, qint64 msecs)
+{
+    first = qMax(0, first);
+    last = qMin(last, size() - 1);
+    if (first > last || !msecs)
+        return;
+
+    add(first, msecs);
+    add(last + 1, -msecs);
+    m_pending = true;
+}
+
+qint64 TimeOffsetTree::offsetAt(int index) const
+{
+    if (!m_pending || index < 0 || index >= size())
+        return 0;
+
+    qint64 offset = 0;
+    for (int i = index + 1; i > 0; i -= i & -i)
+        offset += m_tree[i];
+    return offset;
+}
+
+qint64 TimeOffsetTree::takeOffset(int index)
+{
+    auto offset = offsetAt(index);
+    if (offset) {
+        add(index, -offset);
+        add(index + 1, offset);
+    }
+    return offset;
+}
+
+QVector<qint64> TimeOffsetTree::takeOffsets()
+{
+    QVector<qint64> offsets(size(), 0);
+    if (m_pending) {
+        qint64 offset = 0;
+        for (int i = 0; i < size(); i++) {
+            offset += m_differences[i];
+            offsets[i] = offset;
+        }
+    }
+    reset(size());
+    return offsets;
+}
+
+void TimeOffsetTree::apply(block& a_block, qint64 msecs)
+{
+    if (!msecs)
+        return;
+
+    if (a_block.timeStamp.isNull())
+        a_block.timeStamp = QTime(0, 0, 0, 0);
+    a_block.timeStamp = a_block.timeStamp.addMSecs(int(msecs));
+
+    for (auto& a_word: a_block.words)
+        if (a_word.timeStamp.isValid())
+            a_word.timeStamp = a_word.timeStamp.addMSecs(int(msecs));
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "editor/blockandword.h"
+
+#include <QVector>
+
+/**
+ * @class TimeOffsetTree
+ * @brief Pending time shifts over ranges of blocks.
+ *
+ * A Fenwick tree over the differences of the per-block offsets, so shifting a
+ * range and reading the offset of one block are both O(log n). The offsets are
+ * folded into the blocks only when they are read: one block at a time with
+ * takeOffset(), or all at once with takeOffsets().
+ */
+class TimeOffsetTree
+{
+public:
+    void reset(int size);
+    int size() const { return m_differences.size(); }
+    bool hasPending() const { return m_pending; }
+
+    void addRange(int first, int last, qint64 msecs);
+    qint64 offsetAt(int index) const;
+    /// offsetAt(index) - offsetAt(index - 1) in O(1), for scans over the blocks in order.
+    qint64 differenceAt(int index) const { return m_pending && index >= 0 && index < size() ? m_differences[index] : 0; }
+
+    /// Returns the offset of one block and clears it.
+    qint64 takeOffset(int index);
+    /// Returns the offsets of all blocks and clears them.
+    QVector<qint64> takeOffsets();
+
+    /// Shifts a block and its timed words. Untimed blocks are shifted from zero, as propagation always did.
+    static void apply(block& a_block, qint64 msecs);
+
+private:
+    void add(int index, qint64 msecs);
+
+    QVector<qint64> m_tree;        ///< 1-based Fenwick tree over m_differences.
+    QVector<qint64> m_differences; ///< offset[i] - offset[i - 1], to materialise every block in O(n).
+    bool m_pending{false};
+};
@@ -0,0 +1,56 @@
+#include "timestampindex.h"
+
+void TimeStampIndex::invalidate(int blockNumber)
+{
+    m_firstDirty = qMin(m_firstDirty, qMax(0, blockNumber));
+}
+
+void TimeStampIndex::update(const QVector<block>& blocks)
+{
+    int first = qMin(m_firstDirty, int(qMin(m_lastTimedBlock.size(), blocks.size())));
+    if (first == blocks.size() && m_lastTimedBlock.size() == blocks.size())
+        return;
+
+    m_lastTimedBlock.resize(blocks.size());
+    m_lastTimedWord.resize(blocks.size());
+
+    int lastTimed = first > 0 ? m_lastTimedBlock[first - 1] : -1;
+    for (int i = first; i < blocks.size(); i++) {
+        if (blocks[i].timeStamp.isValid())
+            lastTimed = i;
+        m_lastTimedBlock[i] = lastTimed;
+
+        auto& words = blocks[i].words;
+        auto& lastTimedWords = m_lastTimedWord[i];
+        lastTimedWords.resize(words.size());
+        int lastTimedWord = -1;
+        for (int j = 0; j < words.size(); j++) {
+            if (words[j].timeStamp.isValid())
+                lastTimedWord = j;
+            lastTimedWords[j] = lastTimedWord;
+        }
+    }
+
+    m_firstDirty = blocks.size();
+}
+
+QTime TimeStampIndex::timeBeforeBlock(const QVector<block>& blocks, int blockNumber)
+{
+    update(blocks);
+    if (blockNumber <= 0 || blockNumber > blocks.size())
+        return QTime();
+
+    int timed = m_lastTimedBlock[blockNumber - 1];
+    return timed == -1 ? QTime() : blocks[timed].timeStamp;
+}
+
+QTime TimeStampIndex::timeBeforeWord(const QVector<block>& blocks, int blockNumber, int wordNumber)
+{
+    update(blocks);
+    if (blockNumber < 0 || blockNumber >= blocks.size()
+        || wordNumber <= 0 || wordNumber > blocks[blockNumber].words.size())
+        return QTime();
+
+    int timed = m_lastTimedWord[blockNumber][wordNumber - 1];
+    return timed == -1 ? QTime() : blocks[blockNumber].words[timed].timeStamp;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "editor/blockandword.h"
+
+#include <QVector>
+
+/**
+ * @class TimeStampIndex
+ * @brief Prefix index of the nearest preceding valid timestamp of blocks and words.
+ *
+ * Lookups are O(1). Edits only mark the index dirty from the first changed
+ * block; the entries from there on are recomputed on the next lookup.
+ */
+class TimeStampIndex
+{
+public:
+    void invalidate(int blockNumber = 0);
+
+    /// Timestamp of the nearest timed block before blockNumber, null if there is none.
+    QTime timeBeforeBlock(const QVector<block>& blocks, int blockNumber);
+
+    /// Timestamp of the nearest timed word before wordNumber in its block, null if there is none.
+    QTime timeBeforeWord(const QVector<block>& blocks, int blockNumber, int wordNumber);
+
+private:
+    void update(const QVector<block>& blocks);
+
+    QVector<int> m_lastTimedBlock;         ///< Last block at or before each block with a valid timestamp, -1 for none.
+    QVector<QVector<int>> m_lastTimedWord; ///< Same per word, within each block.
+    int m_firstDirty{0};
+};
@@ -0,0 +1,86 @@
+#include "transcriptdictionary.h"
+
+#include "transcriptio.h"
+
+#include <QFile>
+#include <QPair>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+TranscriptDictionary::TranscriptDictionary(const QString& language)
+    : m_language(language.isEmpty() ? "english" : language)
+{
+    auto combinedFileName = "Dictonaries/" + m_language + "/" + m_language + "combined.txt";
+    if (QFile::exists(combinedFileName))
+        m_dictionary = TranscriptIO::readWordList(combinedFileName);
+    else
+        m_dictionary = TranscriptIO::readWordList(QString(":/wordlists/%1.txt").arg(m_language));
+
+    m_dictionary.append(TranscriptIO::readWordList(QString("corrected_words_%1.txt").arg(m_language)));
+    m_dictionary.sort();
+
+    m_englishDictionary = TranscriptIO::readWordList(":/wordlists/english.txt");
+    m_englishDictionary.sort();
+}
+
+bool TranscriptDictionary::isKnown(const QString& wordText) const
+{
+    auto normalized = normalizeWord(wordText);
+    return isTimeStamp(normalized) || contains(normalized);
+}
+
+bool TranscriptDictionary::contains(const QString& normalizedWord) const
+{
+    return isWordValid(normalizedWord, m_dictionary, m_englishDictionary, m_language);
+}
+
+QString TranscriptDictionary::normalizeWord(const QString& wordText)
+{
+    static const QString punctuation(",.!;:?");
+    static const QList<QPair<QChar, QChar>> enclosing = {
+        {'"', '"'}, {'(', ')'}, {'[', ']'}, {'{', '}'}, {'\'', '\''}, {'<', '>'}
+    };
+
+    auto text = wordText.toLower();
+    if (!text.isEmpty() && punctuation.contains(text.back()))
+        text.chop(1);
+
+    for (auto& pair: enclosing) {
+        if (!text.isEmpty() && text.front() == pair.first)
+            text.remove(0, 1);
+        if (!text.isEmpty() && text.back() == pair.second)
+            text.chop(1);
+    }
+
+    for (QChar trailing: {QChar('?'), QChar('!'), QChar(',')})
+        if (!text.isEmpty() && text.back() == trailing)
+            text.chop(1);
+
+    return text;
+}
+
+bool TranscriptDictionary::isTimeStamp(const QString& wordText)
+{
+    static const QRegularExpression regex("([0-1][0-9]|2[0-3]):([0-5][0-9]):([0-5][0-9])(\\.[0-9]+)?");
+    return regex.match(wordText).hasMatch();
+}
+
+bool TranscriptDictionary::isWordValid(const QString& wordText,
+                                       const QStringList& primaryDict,
+                                       const QStringList& englishDict,
+                                       const QString& transcriptLang)
+{
+    bool inPrimaryDict = std::binary_search(primaryDict.begin(),
+                                            primaryDict.end(),
+                                            wordText);
+    if (inPrimaryDict) return true;
+
+    if (transcriptLang != "english") {
+        return std::binary_search(englishDict.begin(),
+                                  englishDict.end(),
+                                  wordText);
+    }
+
+    return false;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @class TranscriptDictionary
+ * @brief Word lists of a transcript language and the check unknown words are highlighted with.
+ *
+ * Loads the same lists as \c Editor::loadDictionary (bundled or combined list,
+ * plus corrected words) but holds no widget state, so the batch tools can use
+ * one per worker thread.
+ */
+class TranscriptDictionary
+{
+public:
+    explicit TranscriptDictionary(const QString& language = "english");
+
+    const QString& language() const { return m_language; }
+    bool isEmpty() const { return m_dictionary.isEmpty(); }
+
+    /// True if the word is in the dictionaries, or is a timestamp rather than a word.
+    bool isKnown(const QString& wordText) const;
+    /// Dictionary lookup of a word that is already normalized.
+    bool contains(const QString& normalizedWord) const;
+
+    /// Lower case, without trailing punctuation and the quotes or brackets around the word.
+    static QString normalizeWord(const QString& wordText);
+    /// True for "hh:mm:ss[.z]" times written into the text.
+    static bool isTimeStamp(const QString& wordText);
+
+    static bool isWordValid(const QString& wordText,
+                            const QStringList& primaryDict,
+                            const QStringList& englishDict,
+                            const QString& transcriptLang);
+
+private:
+    QString m_language;
+    QStringList m_dictionary;        ///< Sorted words of the transcript language.
+    QStringList m_englishDictionary; ///< Sorted English words, accepted in every language.
+};
@@ -0,0 +1,435 @@
+#include "transcriptexporter.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+struct TimedLine
+{
+    const block* source;
+    bool timed;      ///< False for lines without a timestamp, start and end are 0 then.
+    qint64 startMs;
+    qint64 endMs;
+};
+
+struct TimedWord
+{
+    QString text;
+    qint64 startMs;
+    qint64 endMs;
+    const word* source; ///< Null for words split out of a line without word timestamps.
+};
+
+qint64 toMs(const QTime& time)
+{
+    return QTime(0, 0).msecsTo(time);
+}
+
+/// Calls \a visit for every line in order, with the span it covers.
+void forEachLine(const QVector<block>& blocks, const std::function<void(const TimedLine&)>& visit)
+{
+    qint64 previousEnd = 0;
+    for (auto& a_block: blocks) {
+        if (!a_block.timeStamp.isValid()) {
+            visit({&a_block, false, 0, 0});
+            continue;
+        }
+        auto end = toMs(a_block.timeStamp);
+        // Out of order timestamps give an empty line rather than one running backwards
+        visit({&a_block, true, qMin(previousEnd, end), end});
+        previousEnd = end;
+    }
+}
+
+QVector<TimedWord> timedWords(const TimedLine& line)
+{
+    QVector<TimedWord> words;
+    auto& source = line.source->words;
+
+    bool wordsTimed = !source.isEmpty()
+                      && std::all_of(source.cbegin(), source.cend(), [](const word& a_word) { return a_word.timeStamp.isValid(); });
+    if (wordsTimed) {
+        auto cursor = line.startMs;
+        for (auto& a_word: source) {
+            if (a_word.text.trimmed().isEmpty())
+                continue;
+            auto end = qBound(cursor, toMs(a_word.timeStamp), line.endMs);
+            words.append({a_word.text, cursor, end, &a_word});
+            cursor = end;
+        }
+        return words;
+    }
+
+    static const QRegularExpression whitespace("\\s+");
+    QVector<std::pair<QString, const word*>> texts;
+    if (source.isEmpty()) {
+        for (const auto& text: line.source->text.split(whitespace, Qt::SkipEmptyParts))
+            texts.append({text, nullptr});
+    }
+    else {
+        for (auto& a_word: source)
+            if (!a_word.text.trimmed().isEmpty())
+                texts.append({a_word.text, &a_word});
+    }
+
+    auto span = line.endMs - line.startMs;
+    for (int i = 0; i < texts.size(); i++) {
+        words.append({texts[i].first,
+                      line.startMs + span * i / texts.size(),
+                      line.startMs + span * (i + 1) / texts.size(),
+                      texts[i].second});
+    }
+    return words;
+}
+
+/// "hh:mm:ss<separator>zzz", hours are not wrapped at 24.
+QString clockTime(qint64 ms, QChar separator)
+{
+    return QString("%1:%2:%3%4%5")
+        .arg(ms / 3600000, 2, 10, QChar('0'))
+        .arg(ms / 60000 % 60, 2, 10, QChar('0'))
+        .arg(ms / 1000 % 60, 2, 10, QChar('0'))
+        .arg(separator)
+        .arg(ms % 1000, 3, 10, QChar('0'));
+}
+
+QString seconds(qint64 ms)
+{
+    return QString::number(ms / 1000.0, 'f', 3);
+}
+
+/// Subtitles and scoring files want every line on one text line.
+QString singleLine(const QString& text)
+{
+    return text.simplified();
+}
+
+bool finish(QTextStream& out)
+{
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+class TextExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "txt"; }
+    QString description() const override { return "Plain text"; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString&) const override
+    {
+        QTextStream out(device);
+        for (auto& a_block: transcript.blocks)
+            out << "{" << a_block.speaker << "}: " << a_block.text
+                << " {" << a_block.timeStamp.toString("hh:mm:ss.zzz") << "}\n\n";
+        return finish(out);
+    }
+};
+
+class XmlExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "xml"; }
+    QString description() const override { return "Vagyojaka transcript"; }
+    bool isText() const override { return false; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString&) const override
+    {
+        TranscriptIO::writeXml(device, transcript);
+        return true;
+    }
+};
+
+class SrtExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "srt"; }
+    QString description() const override { return "SubRip subtitles"; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString&) const override
+    {
+        QTextStream out(device);
+        int cue = 1;
+        forEachLine(transcript.blocks, [&](const TimedLine& line) {
+            if (!line.timed)
+                return;
+            out << cue++ << "\n"
+                << clockTime(line.startMs, ',') << " --> " << clockTime(line.endMs, ',') << "\n"
+                << singleLine(line.source->text) << "\n\n";
+        });
+        return finish(out);
+    }
+};
+
+class VttExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "vtt"; }
+    QString description() const override { return "WebVTT subtitles"; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString&) const override
+    {
+        QTextStream out(device);
+        out << "WEBVTT\n\n";
+        forEachLine(transcript.blocks, [&](const TimedLine& line) {
+            if (!line.timed)
+                return;
+            out << clockTime(line.startMs, '.') << " --> " << clockTime(line.endMs, '.') << "\n";
+            if (!line.source->speaker.isEmpty())
+                out << "<v " << escaped(line.source->speaker) << ">";
+            out << escaped(singleLine(line.source->text)) << "\n\n";
+        });
+        return finish(out);
+    }
+
+private:
+    static QString escaped(QString text)
+    {
+        return text.replace('&', "&amp;").replace('<', "&lt;").replace('>', "&gt;");
+    }
+};
+
+/// NIST time marked conversation, one word per line for ASR scoring.
+class CtmExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "ctm"; }
+    QString description() const override { return "NIST CTM word alignment"; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString& name) const override
+    {
+        QTextStream out(device);
+        forEachLine(transcript.blocks, [&](const TimedLine& line) {
+            if (!line.timed)
+                return;
+            for (auto& a_word: timedWords(line))
+                out << name << " 1 " << seconds(a_word.startMs) << " " << seconds(a_word.endMs - a_word.startMs)
+                    << " " << a_word.text << "\n";
+        });
+        return finish(out);
+    }
+};
+
+/// NIST segment time mark, one speaker turn per line for ASR scoring.
+class StmExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "stm"; }
+    QString description() const override { return "NIST STM segments"; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString& name) const override
+    {
+        QTextStream out(device);
+        forEachLine(transcript.blocks, [&](const TimedLine& line) {
+            if (!line.timed)
+                return;
+            auto speaker = singleLine(line.source->speaker).replace(' ', '_');
+            out << name << " 1 " << (speaker.isEmpty() ? QString("unknown") : speaker) << " "
+                << seconds(line.startMs) << " " << seconds(line.endMs) << " " << singleLine(line.source->text) << "\n";
+        });
+        return finish(out);
+    }
+};
+
+/// Praat TextGrid in the long text format, with speaker, line and word tiers.
+class TextGridExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "TextGrid"; }
+    QString description() const override { return "Praat TextGrid"; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString&) const override
+    {
+        qint64 duration = 0;
+        forEachLine(transcript.blocks, [&](const TimedLine& line) {
+            if (line.timed)
+                duration = qMax(duration, line.endMs);
+        });
+
+        QTextStream out(device);
+        out << "File type = \"ooTextFile\"\n"
+            << "Object class = \"TextGrid\"\n\n"
+            << "xmin = 0\n"
+            << "xmax = " << seconds(duration) << "\n"
+            << "tiers? <exists>\n"
+            << "size = 3\n"
+            << "item []:\n";
+
+        const QList<std::pair<QString, bool>> tiers{{"speaker", false}, {"line", false}, {"word", true}};
+        for (int i = 0; i < tiers.size(); i++) {
+            auto& [tierName, wordTier] = tiers[i];
+            // Praat wants the interval count up front, so each tier is walked twice
+            int intervals = writeTier(nullptr, transcript, tierName, wordTier, duration);
+            out << "    item [" << i + 1 << "]:\n"
+                << "        class = \"IntervalTier\"\n"
+                << "        name = \"" << tierName << "\"\n"
+                << "        xmin = 0\n"
+                << "        xmax = " << seconds(duration) << "\n"
+                << "        intervals: size = " << intervals << "\n";
+            writeTier(&out, transcript, tierName, wordTier, duration);
+        }
+        return finish(out);
+    }
+
+private:
+    static QString quoted(QString text)
+    {
+        return "\"" + text.replace('"', "\"\"") + "\"";
+    }
+
+    /// Writes the intervals of one tier to \a out, or only counts them if \a out is null.
+    static int writeTier(QTextStream* out, const Transcript& transcript, const QString& tierName,
+                         bool wordTier, qint64 duration)
+    {
+        // Intervals have to tile the whole tier, gaps become empty intervals
+        int count = 0;
+        qint64 cursor = 0;
+        auto interval = [&](qint64 startMs, qint64 endMs, const QString& text) {
+            if (endMs <= startMs)
+                return;
+            count++;
+            if (out) {
+                *out << "        intervals [" << count << "]:\n"
+                     << "            xmin = " << seconds(startMs) << "\n"
+                     << "            xmax = " << seconds(endMs) << "\n"
+                     << "            text = " << quoted(singleLine(text)) << "\n";
+            }
+            cursor = endMs;
+        };
+        auto gapTo = [&](qint64 startMs) {
+            if (startMs > cursor)
+                interval(cursor, startMs, {});
+        };
+
+        forEachLine(transcript.blocks, [&](const TimedLine& line) {
+            if (!line.timed || line.startMs < cursor)
+                return;
+            if (!wordTier) {
+                gapTo(line.startMs);
+                interval(line.startMs, line.endMs, tierName == "speaker" ? line.source->speaker : line.source->text);
+                return;
+            }
+            for (auto& a_word: timedWords(line)) {
+                gapTo(a_word.startMs);
+                interval(a_word.startMs, a_word.endMs, a_word.text);
+            }
+        });
+        gapTo(duration);
+        return count;
+    }
+};
+
+/// One JSON object per line, with the derived line and word spans in seconds.
+class JsonLinesExporter : public TranscriptExporter
+{
+public:
+    QString format() const override { return "jsonl"; }
+    QString description() const override { return "JSON Lines"; }
+    bool isText() const override { return false; }
+
+    bool write(QIODevice* device, const Transcript& transcript, const QString&) const override
+    {
+        bool ok = true;
+        forEachLine(transcript.blocks, [&](const TimedLine& line) {
+            QJsonObject object{
+                {"speaker", line.source->speaker},
+                {"text", line.source->text},
+                {"tags", QJsonArray::fromStringList(line.source->tagList)},
+            };
+            if (line.timed) {
+                object.insert("start", line.startMs / 1000.0);
+                object.insert("end", line.endMs / 1000.0);
+
+                QJsonArray words;
+                for (auto& a_word: timedWords(line)) {
+                    QJsonObject wordObject{
+                        {"text", a_word.text},
+                        {"start", a_word.startMs / 1000.0},
+                        {"end", a_word.endMs / 1000.0},
+                    };
+                    if (a_word.source) {
+                        wordObject.insert("tags", QJsonArray::fromStringList(a_word.source->tagList));
+                        wordObject.insert("edited", a_word.source->isEdited == "true");
+                    }
+                    words.append(wordObject);
+                }
+                object.insert("words", words);
+            }
+            ok = ok && device->write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n') != -1;
+        });
+        return ok;
+    }
+};
+
+using Factory = std::unique_ptr<TranscriptExporter> (*)();
+
+template<typename T>
+std::unique_ptr<TranscriptExporter> make()
+{
+    return std::make_unique<T>();
+}
+
+const QList<std::pair<QString, Factory>> exporters{
+    {"txt", &make<TextExporter>},
+    {"xml", &make<XmlExporter>},
+    {"srt", &make<SrtExporter>},
+    {"vtt", &make<VttExporter>},
+    {"ctm", &make<CtmExporter>},
+    {"stm", &make<StmExporter>},
+    {"TextGrid", &make<TextGridExporter>},
+    {"jsonl", &make<JsonLinesExporter>},
+};
+
+}
+
+QStringList TranscriptExporter::formats()
+{
+    QStringList names;
+    for (auto& exporter: exporters)
+        names.append(exporter.first);
+    return names;
+}
+
+std::unique_ptr<TranscriptExporter> TranscriptExporter::create(const QString& format)
+{
+    for (auto& exporter: exporters)
+        if (exporter.first.compare(format, Qt::CaseInsensitive) == 0)
+            return exporter.second();
+    return nullptr;
+}
+
+bool TranscriptExporter::exportFile(const Transcript& transcript, const QString& format, const QString& fileName,
+                                    QString* error)
+{
+    auto exporter = create(format);
+    if (!exporter) {
+        if (error)
+            *error = "unknown export format " + format;
+        return false;
+    }
+
+    QIODevice::OpenMode mode = QIODevice::WriteOnly;
+    if (exporter->isText())
+        mode |= QIODevice::Text;
+    QSaveFile file(fileName);
+    if (!file.open(mode)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    if (!exporter->write(&file, transcript, QFileInfo(fileName).completeBaseName()) || !file.commit()) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "editor/utilities/transcriptio.h"
+
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+/**
+ * @class TranscriptExporter
+ * @brief Streaming writer for one export format (txt, xml, srt, vtt, ctm, stm, TextGrid, jsonl).
+ *
+ * Writers walk the transcript line by line and write each line as soon as it is
+ * formatted, so no whole-file string is ever built. A writer keeps no state between
+ * calls, which lets vagyojaka-cli export many transcripts at once.
+ *
+ * A line's timestamp is the end of that line, so a line is taken to start where the
+ * previous timed line ended. Words are timed the same way inside their line; lines
+ * without word timestamps have their span shared evenly between their words. Lines
+ * without a timestamp are left out of the timed formats.
+ */
+class TranscriptExporter
+{
+public:
+    virtual ~TranscriptExporter() = default;
+
+    /// Short format name, also used as the file suffix (e.g. "srt").
+    virtual QString format() const = 0;
+    /// Human readable name for file dialogs (e.g. "SubRip subtitles").
+    virtual QString description() const = 0;
+    /// Whether the file is opened in text mode, i.e. with native line endings.
+    virtual bool isText() const { return true; }
+
+    /**
+     * @brief Writes \a transcript to \a device.
+     * @param name Identifies the recording in formats that carry one (CTM, STM).
+     * @return false if the device failed while writing.
+     */
+    virtual bool write(QIODevice* device, const Transcript& transcript, const QString& name) const = 0;
+
+    /// Format names in the order they are offered to the user.
+    static QStringList formats();
+    /// Writer for \a format, null for an unknown format.
+    static std::unique_ptr<TranscriptExporter> create(const QString& format);
+
+    /**
+     * @brief Writes \a transcript in \a format to \a fileName.
+     *
+     * The file is written aside and renamed when complete, so a failed export never
+     * leaves half a file behind. Safe to call from worker threads.
+     */
+    static bool exportFile(const Transcript& transcript, const QString& format, const QString& fileName,
+                           QString* error = nullptr);
+};
@@ -0,0 +1,154 @@
+#include "transcriptio.h"
+
+#include <QFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+QTime TranscriptIO::parseTime(const QString& text)
+{
+    if (text.contains(".")) {
+        if (text.count(":") == 2) return QTime::fromString(text, "h:m:s.z");
+        return QTime::fromString(text, "m:s.z");
+    }
+    else {
+        if (text.count(":") == 2) return QTime::fromString(text, "h:m:s");
+        return QTime::fromString(text, "m:s");
+    }
+}
+
+QTime TranscriptIO::parseLineTime(const QString& text)
+{
+    auto time = parseTime(text);
+    if (time.isValid())
+        return time;
+
+    int separators = text.count(":");
+    if (separators != 1 && separators != 2)
+        return time;
+
+    // Carry minutes past 59 into the hours
+    QStringList parts = text.split(":");
+    int minutesPart = separators - 1;
+    QString carried;
+
+    int hours = parts[minutesPart].toInt() / 60 + (minutesPart ? parts[0].toInt() : 0);
+    if (hours < 10)
+        carried += "0";
+    carried += QString::number(hours);
+    carried += ":";
+    carried += QString::number(parts[minutesPart].toInt() % 60);
+    carried += ":";
+    carried += parts[minutesPart + 1];
+
+    return parseTime(carried);
+}
+
+bool TranscriptIO::readXml(QIODevice* device, Transcript& transcript, QString* error)
+{
+    QXmlStreamReader reader(device);
+    transcript.language = "";
+    transcript.blocks.clear();
+
+    if (reader.readNextStartElement()) {
+        if (reader.name() == QString("transcript")) {
+            transcript.language = reader.attributes().value("lang").toString();
+
+            while (reader.readNextStartElement()) {
+                if (reader.name() == QString("line")) {
+                    auto blockTimeStamp = parseLineTime(reader.attributes().value("timestamp").toString());
+                    auto blockSpeaker = reader.attributes().value("speaker").toString();
+                    auto tagString = reader.attributes().value("tags").toString();
+                    QStringList tagList;
+                    if (tagString != "")
+                        tagList = tagString.split(",");
+
+                    QString blockText;
+                    block line = {blockTimeStamp, "", blockSpeaker, tagList, QVector<word>()};
+                    while (reader.readNextStartElement()) {
+                        if (reader.name() == QString("word")) {
+                            QString isEditedStr = reader.attributes().value("isEdited").toString();
+                            auto wordTimeStamp  = parseTime(reader.attributes().value("timestamp").toString());
+                            auto wordTagString  = reader.attributes().value("tags").toString();
+                            auto wordText       = reader.readElementText();
+                            QStringList wordTagList;
+                            if (wordTagString != "")
+                                wordTagList = wordTagString.split(",");
+
+                            blockText += (wordText + " ");
+                            line.words.append(word(wordTimeStamp, wordText, wordTagList, isEditedStr.toLower()));
+                        }
+                        else
+                            reader.skipCurrentElement();
+                    }
+                    line.text = blockText.trimmed();
+                    transcript.blocks.append(line);
+                }
+                else
+                    reader.skipCurrentElement();
+            }
+        }
+        else
+            reader.raiseError(QObject::tr("Incorrect file"));
+    }
+
+    if (!reader.hasError())
+        return true;
+
+    if (error)
+        *error = QString("%1 (line %2)").arg(reader.errorString()).arg(reader.lineNumber());
+    return false;
+}
+
+void TranscriptIO::writeXml(QIODevice* device, const Transcript& transcript)
+{
+    QXmlStreamWriter writer(device);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeStartElement("transcript");
+
+    if (transcript.language != "")
+        writer.writeAttribute("lang", transcript.language);
+
+    for (auto& a_block: std::as_const(transcript.blocks)) {
+        if (a_block.text == "")
+            continue;
+
+        writer.writeStartElement("line");
+        writer.writeAttribute("timestamp", a_block.timeStamp.toString("hh:mm:ss.zzz"));
+        writer.writeAttribute("speaker", a_block.speaker);
+
+        if (!a_block.tagList.isEmpty())
+            writer.writeAttribute("tags", a_block.tagList.join(","));
+
+        for (auto& a_word: std::as_const(a_block.words)) {
+            writer.writeStartElement("word");
+            writer.writeAttribute("timestamp", a_word.timeStamp.toString("hh:mm:ss.zzz"));
+            writer.writeAttribute("isEdited", (a_word.isEdited == "true") ? "true": "false");
+
+            if (!a_word.tagList.isEmpty())
+                writer.writeAttribute("tags", a_word.tagList.join(","));
+
+            writer.writeCharacters(a_word.text);
+            writer.writeEndElement();
+        }
+        writer.writeEndElement();
+    }
+    writer.writeEndElement();
+}
+
+QStringList TranscriptIO::readWordList(const QString& fileName)
+{
+    QStringList words;
+
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly))
+        return {};
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (!line.isEmpty()) {
+            words << QString::fromUtf8(line.trimmed());
+        }
+    }
+    return words;
+}
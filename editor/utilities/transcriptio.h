@@ -0,0 +1,42 @@
+#pragma once
+
+#include "editor/blockandword.h"
+
+#include <QIODevice>
+#include <QStringList>
+#include <QVector>
+
+/// A transcript as it is stored on disk, without any editor state.
+struct Transcript
+{
+    QString language;
+    QVector<block> blocks;
+};
+
+/**
+ * @class TranscriptIO
+ * @brief Widget free reading and writing of transcripts, shared by \c Editor and vagyojaka-cli.
+ *
+ * Nothing here touches a widget or the editor settings, so it is safe to call
+ * from worker threads on separate transcripts.
+ */
+class TranscriptIO
+{
+public:
+    /// Parses "h:m:s[.z]" and "m:s[.z]", null if the text is neither.
+    static QTime parseTime(const QString& text);
+
+    /// Like parseTime, but also accepts line timestamps whose minutes run past 59 ("75:12.5").
+    static QTime parseLineTime(const QString& text);
+
+    /**
+     * @brief Reads a transcript XML.
+     * @return false with \a error set if the XML is malformed or isn't a transcript; the
+     *         lines read up to the error are kept.
+     */
+    static bool readXml(QIODevice* device, Transcript& transcript, QString* error = nullptr);
+    static void writeXml(QIODevice* device, const Transcript& transcript);
+
+    /// Trimmed lines of a UTF-8 word list, empty if the file can't be read.
+    static QStringList readWordList(const QString& fileName);
+};
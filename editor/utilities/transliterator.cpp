@@ -0,0 +1,338 @@
+#include "transliterator.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+
+const QString InputToolsBackend::DefaultUrl = "http://inputtools.google.com/request";
+
+InputToolsBackend::InputToolsBackend(const QString& baseUrl, QObject* parent)
+    : TransliterationBackend(parent), m_baseUrl(baseUrl.isEmpty() ? DefaultUrl : baseUrl)
+{
+    m_manager.setTransferTimeout(3000);
+}
+
+void InputToolsBackend::request(quint64 id, const QString& input, const QString& langCode)
+{
+    QUrl url(m_baseUrl);
+    QUrlQuery query;
+    query.addQueryItem("text", input);
+    query.addQueryItem("itc", QString("%1-t-i0-und").arg(langCode));
+    query.addQueryItem("num", "10");
+    query.addQueryItem("cp", "0");
+    query.addQueryItem("cs", "1");
+    query.addQueryItem("ie", "utf-8");
+    query.addQueryItem("oe", "utf-8");
+    query.addQueryItem("app", "test");
+    url.setQuery(query);
+
+    QNetworkReply* reply = m_manager.get(QNetworkRequest(url));
+    m_replies.insert(id, reply);
+
+    connect(reply, &QNetworkReply::finished, this, [this, id, reply]() {
+        m_replies.remove(id);
+        reply->deleteLater();
+
+        if (reply->error() == QNetworkReply::OperationCanceledError)
+            return;
+        if (reply->error() != QNetworkReply::NoError) {
+            emit failed(id, reply->errorString());
+            return;
+        }
+        emit finished(id, parseReply(reply->readAll()));
+    });
+}
+
+void InputToolsBackend::cancel(quint64 id)
+{
+    QPointer<QNetworkReply> reply = m_replies.take(id);
+    if (reply)
+        reply->abort();
+}
+
+// Reply format: ["SUCCESS",[["input",["cand1","cand2",...],[],{...}]]]
+QStringList InputToolsBackend::parseReply(const QByteArray& replyData)
+{
+    QStringList suggestions;
+
+    auto document = QJsonDocument::fromJson(replyData);
+    if (!document.isArray())
+        return suggestions;
+
+    auto root = document.array();
+    if (root.size() < 2 || root.at(0).toString() != "SUCCESS")
+        return suggestions;
+
+    for (const auto& entry : root.at(1).toArray()) {
+        auto entryArray = entry.toArray();
+        if (entryArray.size() < 2)
+            continue;
+        for (const auto& candidate : entryArray.at(1).toArray())
+            suggestions.append(candidate.toString());
+    }
+
+    return suggestions;
+}
+
+OfflineTableBackend::OfflineTableBackend(const QString& tablePath, QObject* parent)
+    : TransliterationBackend(parent)
+{
+    QFile file(tablePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        auto line = in.readLine();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        auto fields = line.split('\t');
+        if (fields.size() < 3)
+            continue;
+
+        m_table[fields[0]][fields[1]] = fields[2].split('|', Qt::SkipEmptyParts);
+    }
+}
+
+void OfflineTableBackend::request(quint64 id, const QString& input, const QString& langCode)
+{
+    auto suggestions = lookup(input, langCode);
+
+    // Answer from the event loop so callers see the same ordering as a network backend
+    QTimer::singleShot(0, this, [this, id, suggestions]() {
+        if (m_cancelled.remove(id))
+            return;
+        emit finished(id, suggestions);
+    });
+}
+
+void OfflineTableBackend::cancel(quint64 id)
+{
+    m_cancelled.insert(id);
+}
+
+int OfflineTableBackend::entryCount() const
+{
+    int count = 0;
+    for (const auto& entries : m_table)
+        count += entries.size();
+    return count;
+}
+
+QStringList OfflineTableBackend::lookup(const QString& input, const QString& langCode) const
+{
+    auto langIt = m_table.constFind(langCode);
+    if (langIt == m_table.constEnd())
+        return {};
+
+    const auto& entries = langIt.value();
+    if (auto it = entries.constFind(input); it != entries.constEnd())
+        return it.value();
+
+    QStringList suggestions;
+    for (auto it = entries.lowerBound(input); it != entries.constEnd() && it.key().startsWith(input); ++it) {
+        for (const auto& candidate : it.value())
+            if (!suggestions.contains(candidate))
+                suggestions.append(candidate);
+        if (suggestions.size() >= 10)
+            break;
+    }
+    return suggestions;
+}
+
+Transliterator::Transliterator(QObject* parent)
+    : QObject(parent)
+{
+    loadCache(defaultCachePath());
+}
+
+Transliterator::~Transliterator()
+{
+    cancelAll();
+    saveCache(defaultCachePath());
+}
+
+void Transliterator::setBackend(TransliterationBackend* backend)
+{
+    if (m_backend == backend)
+        return;
+
+    cancelAll();
+    if (m_backend && m_backend->parent() == this)
+        m_backend->deleteLater();
+
+    m_backend = backend;
+    if (!m_backend)
+        return;
+
+    if (!m_backend->parent())
+        m_backend->setParent(this);
+    connect(m_backend, &TransliterationBackend::finished, this, &Transliterator::backendFinished);
+    connect(m_backend, &TransliterationBackend::failed, this, &Transliterator::backendFailed);
+}
+
+void Transliterator::request(const QString& input, const QString& langCode)
+{
+    auto key = cacheKey(input, langCode);
+    m_latestKey = key;
+
+    if (auto entry = cached(key)) {
+        cancelAll();
+        emit suggestionsReady(input, langCode, *entry);
+        return;
+    }
+
+    if (!m_backend)
+        return;
+
+    // Drop everything that has been superseded, but keep an identical request alive
+    bool alreadyInFlight = false;
+    for (auto it = m_inFlight.begin(); it != m_inFlight.end();) {
+        if (it.value() == key) {
+            alreadyInFlight = true;
+            ++it;
+            continue;
+        }
+        m_backend->cancel(it.key());
+        it = m_inFlight.erase(it);
+    }
+    if (alreadyInFlight)
+        return;
+
+    auto id = m_nextId++;
+    m_inFlight.insert(id, key);
+    m_backend->request(id, input, langCode);
+}
+
+void Transliterator::cancelAll()
+{
+    if (m_backend)
+        for (auto it = m_inFlight.constBegin(); it != m_inFlight.constEnd(); ++it)
+            m_backend->cancel(it.key());
+    m_inFlight.clear();
+}
+
+void Transliterator::backendFinished(quint64 id, const QStringList& suggestions)
+{
+    auto key = m_inFlight.take(id);
+    if (key.isEmpty())
+        return;
+
+    if (!suggestions.isEmpty())
+        cacheInsert(key, suggestions);
+
+    if (key != m_latestKey)
+        return;
+
+    auto separator = key.indexOf('\t');
+    emit suggestionsReady(key.mid(separator + 1), key.left(separator), suggestions);
+}
+
+void Transliterator::backendFailed(quint64 id, const QString& error)
+{
+    auto key = m_inFlight.take(id);
+    if (!key.isEmpty() && key == m_latestKey)
+        emit message(error);
+}
+
+QString Transliterator::cacheKey(const QString& input, const QString& langCode)
+{
+    return langCode + '\t' + input;
+}
+
+void Transliterator::setCacheCapacity(int capacity)
+{
+    m_cacheCapacity = qMax(0, capacity);
+    while (int(m_cache.size()) > m_cacheCapacity) {
+        m_cacheIndex.remove(m_cache.back().first);
+        m_cache.pop_back();
+    }
+}
+
+const QStringList* Transliterator::cached(const QString& key)
+{
+    auto it = m_cacheIndex.constFind(key);
+    if (it == m_cacheIndex.constEnd())
+        return nullptr;
+
+    m_cache.splice(m_cache.begin(), m_cache, it.value());
+    return &m_cache.front().second;
+}
+
+void Transliterator::cacheInsert(const QString& key, const QStringList& suggestions)
+{
+    if (m_cacheCapacity == 0)
+        return;
+
+    auto it = m_cacheIndex.constFind(key);
+    if (it != m_cacheIndex.constEnd())
+        m_cache.erase(it.value());
+    m_cache.emplace_front(key, suggestions);
+    m_cacheIndex.insert(key, m_cache.begin());
+    setCacheCapacity(m_cacheCapacity);
+}
+
+bool Transliterator::loadCache(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    auto suggestionsOf = [](const QJsonValue& value) {
+        QStringList suggestions;
+        for (const auto& candidate : value.toArray())
+            suggestions.append(candidate.toString());
+        return suggestions;
+    };
+
+    // Entries are stored least recently used first, inserting them in order restores the recency
+    auto document = QJsonDocument::fromJson(file.readAll());
+    for (const auto& entry : document.array()) {
+        auto pair = entry.toArray();
+        auto suggestions = suggestionsOf(pair.at(1));
+        if (pair.size() == 2 && !suggestions.isEmpty())
+            cacheInsert(pair.at(0).toString(), suggestions);
+    }
+
+    // Files written before the order was kept are a plain object
+    auto root = document.object();
+    for (auto it = root.constBegin(); it != root.constEnd(); ++it) {
+        auto suggestions = suggestionsOf(it.value());
+        if (!suggestions.isEmpty())
+            cacheInsert(it.key(), suggestions);
+    }
+    return true;
+}
+
+bool Transliterator::saveCache(const QString& filePath) const
+{
+    if (m_cache.empty())
+        return false;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QJsonArray root;
+    for (auto it = m_cache.crbegin(); it != m_cache.crend(); ++it)
+        root.append(QJsonArray{it->first, QJsonArray::fromStringList(it->second)});
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+QString Transliterator::defaultCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/transliteration-cache.json";
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+
+#include <list>
+
+/**
+ * @class TransliterationBackend
+ * @brief Source of transliteration suggestions used by \c Transliterator.
+ *
+ * A backend answers asynchronously: every call to request() is eventually
+ * followed by finished() or failed() carrying the same id, unless the request
+ * was cancelled first.
+ */
+class TransliterationBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TransliterationBackend(QObject* parent = nullptr) : QObject(parent) {}
+
+    virtual void request(quint64 id, const QString& input, const QString& langCode) = 0;
+    virtual void cancel(quint64 id) = 0;
+
+signals:
+    void finished(quint64 id, const QStringList& suggestions);
+    void failed(quint64 id, const QString& error);
+};
+
+/**
+ * @class InputToolsBackend
+ * @brief Queries a Google Input Tools compatible HTTP endpoint.
+ *
+ * The base URL is configurable so that a local stand-in server can be used
+ * instead of \c inputtools.google.com.
+ */
+class InputToolsBackend : public TransliterationBackend
+{
+    Q_OBJECT
+
+public:
+    static const QString DefaultUrl;
+
+    explicit InputToolsBackend(const QString& baseUrl = DefaultUrl, QObject* parent = nullptr);
+
+    void request(quint64 id, const QString& input, const QString& langCode) override;
+    void cancel(quint64 id) override;
+
+    static QStringList parseReply(const QByteArray& replyData);
+
+private:
+    QString m_baseUrl;
+    QNetworkAccessManager m_manager;
+    QHash<quint64, QPointer<QNetworkReply>> m_replies;
+};
+
+/**
+ * @class OfflineTableBackend
+ * @brief Answers from a local mapping table, for tests and machines without network.
+ *
+ * Each line of the table is "langCode<TAB>input<TAB>candidate1|candidate2|...".
+ * Inputs without an exact entry get the candidates of the entries they prefix.
+ */
+class OfflineTableBackend : public TransliterationBackend
+{
+    Q_OBJECT
+
+public:
+    explicit OfflineTableBackend(const QString& tablePath, QObject* parent = nullptr);
+
+    void request(quint64 id, const QString& input, const QString& langCode) override;
+    void cancel(quint64 id) override;
+
+    int entryCount() const;
+
+private:
+    QStringList lookup(const QString& input, const QString& langCode) const;
+
+    QHash<QString, QMap<QString, QStringList>> m_table;
+    QSet<quint64> m_cancelled;
+};
+
+/**
+ * @class Transliterator
+ * @brief Non-blocking transliteration with an LRU cache in front of a backend.
+ *
+ * Requests are keyed by (input, langCode). Cached keys are answered at once,
+ * a key already in flight is not requested twice, and in-flight requests for
+ * other keys are cancelled when a newer request supersedes them. The cache is
+ * persisted to the user cache directory between sessions.
+ */
+class Transliterator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Transliterator(QObject* parent = nullptr);
+    ~Transliterator();
+
+    void setBackend(TransliterationBackend* backend);
+    TransliterationBackend* backend() const { return m_backend; }
+
+    void setCacheCapacity(int capacity);
+
+    void request(const QString& input, const QString& langCode);
+    void cancelAll();
+
+    bool loadCache(const QString& filePath);
+    bool saveCache(const QString& filePath) const;
+    static QString defaultCachePath();
+
+signals:
+    void suggestionsReady(const QString& input, const QString& langCode, const QStringList& suggestions);
+    void message(const QString& text, int timeout = 2000);
+
+private slots:
+    void backendFinished(quint64 id, const QStringList& suggestions);
+    void backendFailed(quint64 id, const QString& error);
+
+private:
+    static QString cacheKey(const QString& input, const QString& langCode);
+    /// Cached suggestions for \a key, marked as most recently used, or nullptr.
+    const QStringList* cached(const QString& key);
+    void cacheInsert(const QString& key, const QStringList& suggestions);
+
+    using CacheEntry = std::pair<QString, QStringList>;
+
+    TransliterationBackend* m_backend = nullptr;
+    /// Most recently used first, so the file keeps the order evictions follow.
+    std::list<CacheEntry> m_cache;
+    QHash<QString, std::list<CacheEntry>::iterator> m_cacheIndex;
+    int m_cacheCapacity = 2000;
+    QHash<quint64, QString> m_inFlight; ///< Request id -> cache key.
+    QString m_latestKey;
+    quint64 m_nextId = 1;
+};
@@ -0,0 +1,169 @@
+#include "wordindex.h"
+
+#include <QSet>
+#include <algorithm>
+
+WordQuery WordQuery::fromString(const QString& text)
+{
+    WordQuery query;
+    for (auto& token: text.split(' ', Qt::SkipEmptyParts)) {
+        bool prefix = token.endsWith('*');
+        auto term = WordIndex::normalize(prefix ? token.chopped(1) : token);
+        if (!term.isEmpty())
+            query.terms.append(prefix ? term + '*' : term);
+    }
+    return query;
+}
+
+QString WordIndex::normalize(const QString& text)
+{
+    auto isWordChar = [](QChar c) { return c.isLetterOrNumber() || c.isMark(); };
+
+    int start = 0, end = text.size();
+    while (start < end && !isWordChar(text[start]))
+        start++;
+    while (end > start && !isWordChar(text[end - 1]))
+        end--;
+
+    return text.mid(start, end - start).toLower();
+}
+
+void WordIndex::clear()
+{
+    m_postings.clear();
+    m_blockTokens.clear();
+}
+
+void WordIndex::rebuild(const QVector<block>& blocks)
+{
+    clear();
+    m_blockTokens.resize(blocks.size());
+
+    // Blocks are visited in order, so appending keeps every posting list sorted
+    for (int i = 0; i < blocks.size(); i++)
+        addBlock(i, blocks[i]);
+}
+
+void WordIndex::updateBlock(int blockNumber, const block& a_block)
+{
+    if (blockNumber < 0 || blockNumber >= m_blockTokens.size())
+        return;
+
+    removeBlock(blockNumber);
+    addBlock(blockNumber, a_block);
+}
+
+void WordIndex::removeBlock(int blockNumber)
+{
+    auto& tokens = m_blockTokens[blockNumber];
+    for (auto& token: QSet<QString>(tokens.begin(), tokens.end())) {
+        auto it = m_postings.find(token);
+        if (it == m_postings.end())
+            continue;
+
+        auto& postings = it.value();
+        auto first = std::lower_bound(postings.begin(), postings.end(), WordPosition{blockNumber, 0});
+        auto last = std::lower_bound(first, postings.end(), WordPosition{blockNumber + 1, 0});
+        postings.erase(first, last);
+
+        if (postings.isEmpty())
+            m_postings.erase(it);
+    }
+    tokens.clear();
+}
+
+void WordIndex::addBlock(int blockNumber, const block& a_block)
+{
+    auto& tokens = m_blockTokens[blockNumber];
+    tokens.reserve(a_block.words.size());
+
+    for (int j = 0; j < a_block.words.size(); j++) {
+        auto token = normalize(a_block.words[j].text);
+        tokens.append(token);
+        if (token.isEmpty())
+            continue;
+
+        auto& postings = m_postings[token];
+        WordPosition position{blockNumber, j};
+        if (postings.isEmpty() || postings.last() < position)
+            postings.append(position);
+        else
+            postings.insert(std::lower_bound(postings.begin(), postings.end(), position), position);
+    }
+}
+
+QVector<WordPosition> WordIndex::postingsFor(const QString& term) const
+{
+    if (!term.endsWith('*'))
+        return m_postings.value(term);
+
+    auto prefix = term.chopped(1);
+    QVector<WordPosition> merged;
+    for (auto it = m_postings.lowerBound(prefix); it != m_postings.constEnd() && it.key().startsWith(prefix); ++it) {
+        auto middle = merged.size();
+        merged.append(it.value());
+        std::inplace_merge(merged.begin(), merged.begin() + middle, merged.end());
+    }
+    return merged;
+}
+
+QVector<WordPosition> WordIndex::search(const WordQuery& query, const QVector<block>& blocks) const
+{
+    QVector<WordPosition> hits;
+    if (query.isEmpty())
+        return hits;
+
+    QVector<QVector<WordPosition>> termPostings;
+    termPostings.reserve(query.terms.size());
+    for (auto& term: query.terms) {
+        termPostings.append(postingsFor(term));
+        if (termPostings.last().isEmpty())
+            return hits;
+    }
+
+    // Blocks containing every term, starting from the rarest one
+    std::sort(termPostings.begin(), termPostings.end(),
+              [](const auto& a, const auto& b) { return a.size() < b.size(); });
+
+    QVector<int> candidateBlocks;
+    for (auto& position: std::as_const(termPostings.first()))
+        if (candidateBlocks.isEmpty() || candidateBlocks.last() != position.blockNumber)
+            candidateBlocks.append(position.blockNumber);
+
+    for (int t = 1; t < termPostings.size() && !candidateBlocks.isEmpty(); t++) {
+        QVector<int> remaining;
+        auto& postings = termPostings[t];
+        for (int blockNumber: std::as_const(candidateBlocks)) {
+            auto it = std::lower_bound(postings.begin(), postings.end(), WordPosition{blockNumber, 0});
+            if (it != postings.end() && it->blockNumber == blockNumber)
+                remaining.append(blockNumber);
+        }
+        candidateBlocks = remaining;
+    }
+
+    for (auto& postings: std::as_const(termPostings)) {
+        for (int blockNumber: std::as_const(candidateBlocks)) {
+            if (blockNumber >= blocks.size())
+                continue;
+            auto& a_block = blocks[blockNumber];
+            if (!query.speaker.isEmpty() && a_block.speaker != query.speaker)
+                continue;
+
+            auto it = std::lower_bound(postings.begin(), postings.end(), WordPosition{blockNumber, 0});
+            for (; it != postings.end() && it->blockNumber == blockNumber; ++it) {
+                if (it->wordNumber >= a_block.words.size())
+                    continue;
+                auto& a_word = a_block.words[it->wordNumber];
+                if (query.editedOnly && a_word.isEdited != "true")
+                    continue;
+                if (!query.tag.isEmpty() && !a_word.tagList.contains(query.tag) && !a_block.tagList.contains(query.tag))
+                    continue;
+                hits.append(*it);
+            }
+        }
+    }
+
+    std::sort(hits.begin(), hits.end());
+    hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+    return hits;
+}
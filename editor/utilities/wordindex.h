@@ -0,0 +1,65 @@
+#pragma once
+
+#include "editor/blockandword.h"
+
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+
+struct WordPosition
+{
+    int blockNumber;
+    int wordNumber;
+
+    bool operator<(const WordPosition& other) const
+    {
+        return blockNumber < other.blockNumber
+               || (blockNumber == other.blockNumber && wordNumber < other.wordNumber);
+    }
+    bool operator==(const WordPosition& other) const
+    {
+        return blockNumber == other.blockNumber && wordNumber == other.wordNumber;
+    }
+};
+
+struct WordQuery
+{
+    QStringList terms;      ///< Normalized terms, a trailing '*' makes a term a prefix.
+    QString speaker;        ///< Only blocks of this speaker, empty for all.
+    QString tag;            ///< Only words carrying this tag (on the word or its block), empty for all.
+    bool editedOnly{false}; ///< Only words marked as edited.
+
+    static WordQuery fromString(const QString& text);
+    bool isEmpty() const { return terms.isEmpty(); }
+};
+
+/**
+ * @class WordIndex
+ * @brief Inverted index from normalized tokens to the words of a transcript.
+ *
+ * Posting lists are kept sorted by block and word, so a line can be re-indexed
+ * in place after an edit. Queries match all terms within the same block; the
+ * speaker, tag and edited filters are evaluated against the current blocks.
+ */
+class WordIndex
+{
+public:
+    void clear();
+    void rebuild(const QVector<block>& blocks);
+    void updateBlock(int blockNumber, const block& a_block);
+
+    int blockCount() const { return m_blockTokens.size(); }
+    int termCount() const { return m_postings.size(); }
+
+    QVector<WordPosition> search(const WordQuery& query, const QVector<block>& blocks) const;
+
+    static QString normalize(const QString& text);
+
+private:
+    QVector<WordPosition> postingsFor(const QString& term) const;
+    void removeBlock(int blockNumber);
+    void addBlock(int blockNumber, const block& a_block);
+
+    QMap<QString, QVector<WordPosition>> m_postings;
+    QVector<QStringList> m_blockTokens; ///< Tokens per block, to undo a block's postings.
+};
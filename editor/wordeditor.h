@@ -1,21 +1,21 @@
 #pragma once
 
-#include <QTableWidget>
+#include <QTableView>
 #include "blockandword.h"
+#include "wordtablemodel.h"
 
-class WordEditor: public QTableWidget
+class WordEditor: public QTableView
 {
     Q_OBJECT
 
 public:
     explicit WordEditor(QWidget* parent = nullptr);
-    QVector<word> currentWords() const;
+    WordTableModel* wordModel() const { return m_model; }
     void fitTableContents();
 
 public slots:
-    void refreshWords(const QVector<word>& words);
     void insertTimeStamp(const QTime& timeToInsert);
 
 private:
-    static QTime getTime(const QString& text);
+    WordTableModel* m_model;
 };
@@ -0,0 +1,165 @@
+#include "wordtablemodel.h"
+
+WordTableModel::WordTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void WordTableModel::setBlocks(QVector<block>* blocks)
+{
+    beginResetModel();
+    m_blocks = blocks;
+    m_blockNumber = -1;
+    endResetModel();
+}
+
+void WordTableModel::setBlockNumber(int blockNumber)
+{
+    if (blockNumber == m_blockNumber)
+        return;
+
+    beginResetModel();
+    m_blockNumber = blockNumber;
+    endResetModel();
+}
+
+void WordTableModel::refresh()
+{
+    beginResetModel();
+    endResetModel();
+}
+
+const QVector<word>* WordTableModel::words() const
+{
+    if (!m_blocks || m_blockNumber < 0 || m_blockNumber >= m_blocks->size())
+        return nullptr;
+    return &m_blocks->at(m_blockNumber).words;
+}
+
+QVector<word>* WordTableModel::words()
+{
+    if (!m_blocks || m_blockNumber < 0 || m_blockNumber >= m_blocks->size())
+        return nullptr;
+    return &(*m_blocks)[m_blockNumber].words;
+}
+
+QString WordTableModel::tagForColumn(int column)
+{
+    return column == InvalidColumn ? "InvW" : "Slacked";
+}
+
+int WordTableModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+    auto blockWords = words();
+    return blockWords ? blockWords->size() : 0;
+}
+
+int WordTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant WordTableModel::data(const QModelIndex& index, int role) const
+{
+    auto blockWords = words();
+    if (!blockWords || !index.isValid() || index.row() >= blockWords->size())
+        return QVariant();
+
+    auto& a_word = blockWords->at(index.row());
+    switch (index.column()) {
+    case TextColumn:
+        if (role == Qt::DisplayRole || role == Qt::EditRole)
+            return a_word.text;
+        break;
+    case TimeColumn:
+        if (role == Qt::DisplayRole || role == Qt::EditRole)
+            return a_word.timeStamp.toString("hh:mm:ss.zzz");
+        break;
+    case InvalidColumn:
+    case SlackedColumn:
+        if (role == Qt::CheckStateRole)
+            return a_word.tagList.contains(tagForColumn(index.column())) ? Qt::Checked : Qt::Unchecked;
+        break;
+    }
+    return QVariant();
+}
+
+bool WordTableModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    auto blockWords = words();
+    if (!blockWords || !index.isValid() || index.row() >= blockWords->size())
+        return false;
+
+    auto& a_word = (*blockWords)[index.row()];
+    switch (index.column()) {
+    case TextColumn:
+        if (role != Qt::EditRole || value.toString() == a_word.text)
+            return false;
+        a_word.text = value.toString();
+        a_word.isEdited = "true";
+        break;
+    case TimeColumn:
+        if (role != Qt::EditRole)
+            return false;
+        a_word.timeStamp = value.userType() == QMetaType::QTime ? value.toTime() : parseTime(value.toString());
+        break;
+    case InvalidColumn:
+    case SlackedColumn: {
+        if (role != Qt::CheckStateRole)
+            return false;
+        auto tag = tagForColumn(index.column());
+        if (value.toInt() == Qt::Checked) {
+            if (!a_word.tagList.contains(tag))
+                a_word.tagList.append(tag);
+        }
+        else
+            a_word.tagList.removeAll(tag);
+        break;
+    }
+    default:
+        return false;
+    }
+
+    emit dataChanged(index, index, {role});
+    emit wordChanged(m_blockNumber, index.row(), index.column());
+    return true;
+}
+
+QVariant WordTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    if (orientation == Qt::Vertical)
+        return section + 1;
+
+    switch (section) {
+    case TextColumn: return "Text";
+    case TimeColumn: return "End Time";
+    case InvalidColumn: return "InvW";
+    case SlackedColumn: return "Slacked";
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags WordTableModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    if (index.column() == InvalidColumn || index.column() == SlackedColumn)
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
+
+QTime WordTableModel::parseTime(const QString& text)
+{
+    if (text.contains(".")) {
+        if (text.count(":") == 2) return QTime::fromString(text, "h:m:s.z");
+        return QTime::fromString(text, "m:s.z");
+    }
+    else {
+        if (text.count(":") == 2) return QTime::fromString(text, "h:m:s");
+        return QTime::fromString(text, "m:s");
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include "blockandword.h"
+
+/**
+ * @class WordTableModel
+ * @brief Table model over the words of one block of a transcript.
+ *
+ * The model reads and writes the words in place in the editor's blocks, so
+ * switching lines is a model reset and editing a cell updates a single word.
+ */
+class WordTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { TextColumn, TimeColumn, InvalidColumn, SlackedColumn, ColumnCount };
+
+    explicit WordTableModel(QObject* parent = nullptr);
+
+    void setBlocks(QVector<block>* blocks);
+    void setBlockNumber(int blockNumber);
+    int blockNumber() const { return m_blockNumber; }
+    void refresh();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    static QTime parseTime(const QString& text);
+
+signals:
+    void wordChanged(int blockNumber, int wordNumber, int column);
+
+private:
+    const QVector<word>* words() const;
+    QVector<word>* words();
+    static QString tagForColumn(int column);
+
+    QVector<block>* m_blocks = nullptr;
+    int m_blockNumber = -1;
+};
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <qdir.h>
 #include <git/git_util.h>
+#include "profiling/profiler.h"
 #include <cstring>
 #ifndef _WIN32
 # include <unistd.h>
@@ -41,6 +42,7 @@ Git::Git(QWidget *parent)
 
 void Git::init()
 {
+    PROFILE_SCOPE("Git::init");
     QDir repoDir(repoPath);
     if(!repoDir.exists()) {
         qDebug() << "Initialing" << Qt::endl;
@@ -77,6 +79,7 @@ void Git::init()
 
 void Git::add()
 {
+    PROFILE_SCOPE("Git::add");
     // git_index *index = nullptr;
     // int error = git_repository_index(&index, repo);
     // if (error < 0) {
@@ -118,6 +121,7 @@ void Git::add()
 
 void Git::commit()
 {
+    PROFILE_SCOPE("Git::commit");
 
     git_oid *treeId, commitId, *parentId;
 
@@ -272,6 +276,7 @@ void Git::addRemoteUrl()
 
 void Git::push()
 {
+    PROFILE_SCOPE("Git::push");
     git_push_options options;
     git_remote_callbacks callbacks;
     git_remote* remote = nullptr;
@@ -325,6 +330,7 @@ void Git::push()
 
 void Git::pull()
 {
+    PROFILE_SCOPE("Git::pull");
 
     git_remote *remote = NULL;
     const git_indexer_progress *stats;
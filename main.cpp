@@ -1,4 +1,6 @@
 #include "tool.h"
+#include "profiling/profiler.h"
+#include "profiling/keyrecorder.h"
 #include <QApplication>
 #include<QSettings>
 
@@ -64,9 +66,39 @@ int main(int argc, char *argv[])
     app.setApplicationName("Vagyojaka");
     // app.setApplicationDisplayName("Vagyojaka: ASR Post Editor");
     app.setOrganizationName("IIT Bombay");
+
+    // Scope timings are recorded from startup with VAGYOJAKA_PROFILE set, or after enabling them in View > Performance
+    Profiler::setEnabled(qEnvironmentVariableIsSet("VAGYOJAKA_PROFILE"));
+
+    // "--trace <file>" or VAGYOJAKA_TRACE=<file> records a trace that is written on exit
+    QString traceFile = qEnvironmentVariable("VAGYOJAKA_TRACE");
+    auto arguments = app.arguments();
+    int traceArgument = arguments.indexOf("--trace");
+    if (traceArgument != -1 && traceArgument + 1 < arguments.size())
+        traceFile = arguments[traceArgument + 1];
+    if (!traceFile.isEmpty())
+        Profiler::setTracing(true);
+
+    // "--record-keys <file>" or VAGYOJAKA_RECORD_KEYS=<file> logs editor key presses for the latency harness
+    QString keyLog = qEnvironmentVariable("VAGYOJAKA_RECORD_KEYS");
+    int keyLogArgument = arguments.indexOf("--record-keys");
+    if (keyLogArgument != -1 && keyLogArgument + 1 < arguments.size())
+        keyLog = arguments[keyLogArgument + 1];
+    if (!keyLog.isEmpty()) {
+        auto recorder = new KeyRecorder(keyLog, &app);
+        if (recorder->isOpen())
+            app.installEventFilter(recorder);
+        else
+            qWarning() << "Couldn't open key log" << keyLog;
+    }
     Tool w;
     w.show();
 
-    return app.exec();
+    int result = app.exec();
+
+    if (!traceFile.isEmpty() && !Profiler::exportTrace(traceFile))
+        qWarning() << "Couldn't write trace to" << traceFile;
+
+    return result;
 }
 
@@ -0,0 +1,274 @@
+#include "audiodecoder.h"
+#include "samplekernels.h"
+
+#include <QScopeGuard>
+
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/samplefmt.h>
+#include <libswresample/swresample.h>
+}
+
+AudioDecoder::AudioDecoder(const QString& fileName)
+    : m_fileName(fileName)
+{
+}
+
+AudioDecoder::~AudioDecoder()
+{
+    close();
+}
+
+bool AudioDecoder::fail(const QString& what, int error)
+{
+    m_error = what;
+    if (error < 0) {
+        char message[AV_ERROR_MAX_STRING_SIZE] = {};
+        av_strerror(error, message, sizeof(message));
+        m_error += QString(": ") + message;
+    }
+    return false;
+}
+
+void AudioDecoder::close()
+{
+    swr_free(&m_resampler);
+    avcodec_free_context(&m_codec);
+    avformat_close_input(&m_format);
+    m_streamIndex = -1;
+    m_directInt16 = false;
+}
+
+bool AudioDecoder::open()
+{
+    close();
+    m_info = {};
+
+    int result = avformat_open_input(&m_format, m_fileName.toUtf8().constData(), nullptr, nullptr);
+    if (result < 0)
+        return fail("Couldn't open " + m_fileName, result);
+
+    result = avformat_find_stream_info(m_format, nullptr);
+    if (result < 0)
+        return fail("Couldn't read stream information", result);
+
+    const AVCodec* codec = nullptr;
+    m_streamIndex = av_find_best_stream(m_format, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+    if (m_streamIndex < 0)
+        return fail("No audio stream found", m_streamIndex);
+
+    AVStream* stream = m_format->streams[m_streamIndex];
+    m_codec = avcodec_alloc_context3(codec);
+    if (!m_codec)
+        return fail("Couldn't allocate the audio decoder", AVERROR(ENOMEM));
+    result = avcodec_parameters_to_context(m_codec, stream->codecpar);
+    if (result < 0)
+        return fail("Couldn't configure the audio decoder", result);
+    result = avcodec_open2(m_codec, codec, nullptr);
+    if (result < 0)
+        return fail("Couldn't open the audio decoder", result);
+
+    // Plain WAV and some raw formats only give a channel count
+    if (m_codec->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC) {
+        int channels = m_codec->ch_layout.nb_channels;
+        av_channel_layout_uninit(&m_codec->ch_layout);
+        av_channel_layout_default(&m_codec->ch_layout, channels);
+    }
+
+    AVChannelLayout mono = AV_CHANNEL_LAYOUT_MONO;
+    result = swr_alloc_set_opts2(&m_resampler,
+                                 &mono, AV_SAMPLE_FMT_FLT, m_codec->sample_rate,
+                                 &m_codec->ch_layout, m_codec->sample_fmt, m_codec->sample_rate,
+                                 0, nullptr);
+    if (result < 0 || (result = swr_init(m_resampler)) < 0)
+        return fail("Couldn't set up the sample converter", result);
+
+    // Mono 16 bit, the usual speech recording, is converted without the resampler
+    m_directInt16 = m_codec->ch_layout.nb_channels == 1
+                    && (m_codec->sample_fmt == AV_SAMPLE_FMT_S16 || m_codec->sample_fmt == AV_SAMPLE_FMT_S16P);
+
+    m_info.sampleRate = m_codec->sample_rate;
+    m_info.channels = m_codec->ch_layout.nb_channels;
+    if (stream->duration != AV_NOPTS_VALUE)
+        m_info.durationMs = av_rescale_q(stream->duration, stream->time_base, {1, 1000});
+    else if (m_format->duration != AV_NOPTS_VALUE)
+        m_info.durationMs = av_rescale(m_format->duration, 1000, AV_TIME_BASE);
+    m_info.estimatedSamples = m_info.durationMs * m_info.sampleRate / 1000;
+
+    return true;
+}
+
+int AudioDecoder::convertFrame(const AVFrame* frame)
+{
+    if (m_directInt16) {
+        if (!frame)
+            return 0;
+        if (m_converted.size() < size_t(frame->nb_samples))
+            m_converted.resize(frame->nb_samples);
+        SampleKernels::int16ToFloat(reinterpret_cast<const qint16*>(frame->data[0]), frame->nb_samples, m_converted.data());
+        return frame->nb_samples;
+    }
+
+    int inputSamples = frame ? frame->nb_samples : 0;
+    int capacity = swr_get_out_samples(m_resampler, inputSamples);
+    if (capacity <= 0)
+        return 0;
+    if (m_converted.size() < size_t(capacity))
+        m_converted.resize(capacity);
+
+    auto output = reinterpret_cast<uint8_t*>(m_converted.data());
+    return swr_convert(m_resampler, &output, capacity,
+                       frame ? const_cast<const uint8_t**>(frame->extended_data) : nullptr, inputSamples);
+}
+
+bool AudioDecoder::decode(const ChunkHandler& handler, int chunkSamples)
+{
+    if (!m_codec && !open())
+        return false;
+
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    auto cleanup = qScopeGuard([&]() {
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+    });
+    if (!packet || !frame)
+        return fail("Couldn't allocate decoding buffers", AVERROR(ENOMEM));
+
+    std::vector<float> chunk(chunkSamples);
+    int filled = 0;
+    bool stopped = false;
+
+    // Converts one frame (or, for a null frame, what the converter still holds) into chunks
+    auto convert = [&](const AVFrame* input) -> bool {
+        int count = convertFrame(input);
+        if (count < 0)
+            return fail("Couldn't convert samples", count);
+
+        for (int offset = 0; offset < count;) {
+            int taken = qMin(count - offset, chunkSamples - filled);
+            std::copy_n(m_converted.data() + offset, taken, chunk.data() + filled);
+            filled += taken;
+            offset += taken;
+            if (filled == chunkSamples) {
+                filled = 0;
+                if (!handler(chunk.data(), chunkSamples)) {
+                    stopped = true;
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    auto receive = [&]() -> bool {
+        int result;
+        while ((result = avcodec_receive_frame(m_codec, frame)) >= 0) {
+            bool ok = convert(frame);
+            av_frame_unref(frame);
+            if (!ok)
+                return false;
+        }
+        if (result != AVERROR(EAGAIN) && result != AVERROR_EOF)
+            return fail("Couldn't decode audio", result);
+        return true;
+    };
+
+    while (av_read_frame(m_format, packet) >= 0) {
+        if (packet->stream_index != m_streamIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+        int result = avcodec_send_packet(m_codec, packet);
+        av_packet_unref(packet);
+        // A damaged packet costs a few milliseconds of audio, not the whole waveform
+        if (result < 0 && result != AVERROR_INVALIDDATA)
+            return fail("Couldn't decode audio", result);
+        if (!receive())
+            return false;
+    }
+
+    // Drain the decoder, then the converter
+    avcodec_send_packet(m_codec, nullptr);
+    if (!receive() || !convert(nullptr))
+        return false;
+
+    if (filled > 0 && !stopped)
+        return handler(chunk.data(), filled);
+    return true;
+}
+
+bool AudioDecoder::decodeRange(qint64 firstSample, int count, float* output)
+{
+    std::fill_n(output, count, 0.0f);
+    if (!m_codec && !open())
+        return false;
+
+    AVStream* stream = m_format->streams[m_streamIndex];
+    const AVRational sampleBase{1, m_info.sampleRate};
+    // Sample 0 is the first sample decode() hands out, whatever the stream's start time
+    const int64_t startTime = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+    int64_t target = startTime + av_rescale_q(qMax<qint64>(0, firstSample), sampleBase, stream->time_base);
+    int result = av_seek_frame(m_format, m_streamIndex, target, AVSEEK_FLAG_BACKWARD);
+    if (result < 0)
+        return fail("Couldn't seek", result);
+    avcodec_flush_buffers(m_codec);
+
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    auto cleanup = qScopeGuard([&]() {
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+    });
+    if (!packet || !frame)
+        return fail("Couldn't allocate decoding buffers", AVERROR(ENOMEM));
+
+    const qint64 lastSample = firstSample + count;
+    qint64 position = -1;
+
+    // Copies the part of a decoded frame that overlaps the requested range
+    auto take = [&]() -> bool {
+        if (frame->best_effort_timestamp != AV_NOPTS_VALUE)
+            position = av_rescale_q(frame->best_effort_timestamp - startTime, stream->time_base, sampleBase);
+        else if (position < 0)
+            position = qMax<qint64>(0, firstSample);
+
+        int converted = convertFrame(frame);
+        if (converted < 0)
+            return fail("Couldn't convert samples", converted);
+
+        qint64 from = qMax(position, firstSample);
+        qint64 to = qMin(position + converted, lastSample);
+        if (to > from)
+            std::copy_n(m_converted.data() + (from - position), to - from, output + (from - firstSample));
+        position += converted;
+        return true;
+    };
+
+    while (position < lastSample && av_read_frame(m_format, packet) >= 0) {
+        if (packet->stream_index != m_streamIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+        result = avcodec_send_packet(m_codec, packet);
+        av_packet_unref(packet);
+        if (result < 0 && result != AVERROR_INVALIDDATA)
+            return fail("Couldn't decode audio", result);
+
+        while ((result = avcodec_receive_frame(m_codec, frame)) >= 0) {
+            bool ok = take();
+            av_frame_unref(frame);
+            if (!ok)
+                return false;
+        }
+        if (result != AVERROR(EAGAIN) && result != AVERROR_EOF)
+            return fail("Couldn't decode audio", result);
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QString>
+
+#include <functional>
+#include <vector>
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct SwrContext;
+
+/**
+ * @class AudioDecoder
+ * @brief Decodes the first audio stream of any file libavformat can open to mono float.
+ *
+ * Audio is decoded packet by packet, downmixed and converted by libswresample, and
+ * handed out in chunks of a fixed number of samples, so memory does not grow with
+ * the length of the recording. The native sample rate is kept. An instance is meant
+ * to be used on one thread, typically a worker.
+ */
+class AudioDecoder
+{
+public:
+    struct Info
+    {
+        int sampleRate{0};
+        int channels{0};           ///< Channels in the source, the output is always mono.
+        qint64 durationMs{0};      ///< From the container, 0 if it doesn't say.
+        qint64 estimatedSamples{0};///< Output samples expected from durationMs.
+    };
+
+    /// Receives \a count samples in [-1, 1]; returning false stops decoding.
+    using ChunkHandler = std::function<bool(const float* samples, int count)>;
+
+    static constexpr int defaultChunkSamples = 1 << 16;
+
+    explicit AudioDecoder(const QString& fileName);
+    ~AudioDecoder();
+
+    AudioDecoder(const AudioDecoder&) = delete;
+    AudioDecoder& operator=(const AudioDecoder&) = delete;
+
+    /// Opens the file and its audio decoder, false with errorString() set on failure.
+    bool open();
+    const Info& info() const { return m_info; }
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief Decodes the whole stream, calling \a handler with every full chunk and the last partial one.
+     * @return false on a decoding error or when the handler stopped early.
+     */
+    bool decode(const ChunkHandler& handler, int chunkSamples = defaultChunkSamples);
+
+    /**
+     * @brief Seeks to and decodes \a count samples from \a firstSample into \a output.
+     *
+     * Samples outside the recording are zero. Meant for short windows such as
+     * spectrogram tiles, not for reading whole files.
+     */
+    bool decodeRange(qint64 firstSample, int count, float* output);
+
+private:
+    bool fail(const QString& what, int error);
+    void close();
+    /// Converts \a frame (null drains the converter) into m_converted, returns the sample count or an error.
+    int convertFrame(const AVFrame* frame);
+
+    QString m_fileName;
+    QString m_error;
+    Info m_info;
+    int m_streamIndex{-1};
+
+    AVFormatContext* m_format{nullptr};
+    AVCodecContext* m_codec{nullptr};
+    SwrContext* m_resampler{nullptr};
+    std::vector<float> m_converted;
+    bool m_directInt16{false};  ///< Mono S16 source, see convertFrame().
+};
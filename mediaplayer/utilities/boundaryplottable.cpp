@@ -0,0 +1,221 @@
+#include "boundaryplottable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int labelPadding = 4; ///< Pixels an utterance needs beside its number to show it.
+
+}
+
+BoundaryPlottable::BoundaryPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis)
+    : QCPAbstractPlottable(keyAxis, valueAxis)
+{
+    setSelectable(QCP::stNone);
+}
+
+void BoundaryPlottable::setBoundaries(const QVector<double>& ends)
+{
+    m_ends = ends;
+    m_firstAdded = m_ends.size();
+    m_dragged = -1;
+
+    // Stable, so equal boundaries stay in transcript order
+    m_order.clear();
+    m_order.reserve(m_ends.size());
+    for (int i = 0; i < m_ends.size(); i++)
+        if (!std::isnan(m_ends[i]))
+            m_order.append(i);
+    std::stable_sort(m_order.begin(), m_order.end(), [this](int a, int b) { return m_ends[a] < m_ends[b]; });
+}
+
+void BoundaryPlottable::append(double end)
+{
+    m_ends.append(end);
+    insertOrdered(m_ends.size() - 1);
+}
+
+void BoundaryPlottable::setBoundary(int index, double end)
+{
+    if (index < 0 || index >= m_ends.size())
+        return;
+
+    if (!std::isnan(m_ends[index]))
+        m_order.removeAt(std::find(m_order.cbegin(), m_order.cend(), index) - m_order.cbegin());
+    m_ends[index] = end;
+    insertOrdered(index);
+}
+
+void BoundaryPlottable::insertOrdered(int index)
+{
+    if (std::isnan(m_ends[index]))
+        return;
+
+    // After the boundaries at the same time that come before it in the transcript
+    auto position = std::upper_bound(m_order.cbegin(), m_order.cend(), index, [this](int a, int b) {
+        return m_ends[a] < m_ends[b] || (m_ends[a] == m_ends[b] && a < b);
+    });
+    m_order.insert(position - m_order.cbegin(), index);
+}
+
+int BoundaryPlottable::lowerBound(double key) const
+{
+    return std::lower_bound(m_order.cbegin(), m_order.cend(), key, [this](int index, double value) {
+        return m_ends[index] < value;
+    }) - m_order.cbegin();
+}
+
+int BoundaryPlottable::boundaryAt(double pixelX, double tolerance) const
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    if (!keyAxis || m_order.isEmpty())
+        return -1;
+
+    // Of a run of equal boundaries, the last one left of the cursor can move right
+    // and the first one right of it can move left
+    const double key = keyAxis->pixelToCoord(pixelX);
+    const int next = lowerBound(key);
+
+    int found = -1;
+    double nearest = tolerance;
+    for (int position: {next - 1, next}) {
+        if (position < 0 || position >= m_order.size())
+            continue;
+        const int index = m_order[position];
+        const double distance = std::abs(keyAxis->coordToPixel(m_ends[index]) - pixelX);
+        if (distance <= nearest) {
+            nearest = distance;
+            found = index;
+        }
+    }
+    return found;
+}
+
+double BoundaryPlottable::selectTest(const QPointF& pos, bool onlySelectable, QVariant* details) const
+{
+    Q_UNUSED(pos)
+    Q_UNUSED(onlySelectable)
+    Q_UNUSED(details)
+    return -1;
+}
+
+QCPRange BoundaryPlottable::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const
+{
+    // Rescaling follows the audio, not boundaries past its end
+    Q_UNUSED(inSignDomain)
+    foundRange = false;
+    return QCPRange();
+}
+
+QCPRange BoundaryPlottable::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const
+{
+    Q_UNUSED(inSignDomain)
+    Q_UNUSED(inKeyRange)
+    foundRange = false;
+    return QCPRange();
+}
+
+void BoundaryPlottable::draw(QCPPainter* painter)
+{
+    if (m_source) {
+        drawPreview(painter);
+        return;
+    }
+
+    QCPAxis* keyAxis = mKeyAxis.data();
+    if (!keyAxis || !mValueAxis || m_order.isEmpty())
+        return;
+
+    const QCPRange visible = keyAxis->range();
+    const QRect area = keyAxis->axisRect()->rect();
+
+    QVector<QLineF> lines;
+    QVector<QLineF> added;
+    QVector<int> labels;
+    int lastColumn = std::numeric_limits<int>::min();
+    int position = lowerBound(visible.lower);
+    for (; position < m_order.size() && m_ends[m_order[position]] <= visible.upper; position++) {
+        const int i = m_order[position];
+        if (m_dragged < 0 || (i != m_dragged && i != m_dragged + 1))
+            labels.append(i);
+        if (i == m_dragged)
+            continue;
+
+        // Boundaries closer than a pixel would only overdraw each other
+        const double x = keyAxis->coordToPixel(m_ends[i]);
+        if (int(x) == lastColumn)
+            continue;
+        lastColumn = int(x);
+        (i >= m_firstAdded ? added : lines).append(QLineF(x, area.top(), x, area.bottom()));
+    }
+    // The utterance running past the right edge is numbered too
+    if (position < m_order.size()) {
+        const int i = m_order[position];
+        if (m_dragged < 0 || (i != m_dragged && i != m_dragged + 1))
+            labels.append(i);
+    }
+
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->drawLines(lines);
+    painter->setPen(m_addedPen);
+    painter->drawLines(added);
+
+    const QFontMetrics metrics(m_labelFont);
+    painter->setFont(m_labelFont);
+    painter->setPen(m_labelColor);
+    for (int i: std::as_const(labels))
+        drawLabel(painter, m_ends, i, metrics);
+}
+
+void BoundaryPlottable::drawPreview(QCPPainter* painter)
+{
+    const int index = m_source->m_dragged;
+    const auto& ends = m_source->m_ends;
+    QCPAxis* keyAxis = mKeyAxis.data();
+    if (!keyAxis || !mValueAxis || index < 0 || index >= ends.size() || std::isnan(ends[index]))
+        return;
+
+    const QRect area = keyAxis->axisRect()->rect();
+    const double x = keyAxis->coordToPixel(ends[index]);
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(m_draggedPen);
+    painter->drawLine(QLineF(x, area.top(), x, area.bottom()));
+
+    const QFontMetrics metrics(m_labelFont);
+    painter->setFont(m_labelFont);
+    painter->setPen(m_labelColor);
+    drawLabel(painter, ends, index, metrics);
+    if (index + 1 < ends.size())
+        drawLabel(painter, ends, index + 1, metrics);
+}
+
+void BoundaryPlottable::drawLabel(QCPPainter* painter, const QVector<double>& ends, int index, const QFontMetrics& metrics) const
+{
+    if (std::isnan(ends[index]))
+        return;
+
+    int previous = index - 1;
+    while (previous >= 0 && std::isnan(ends[previous]))
+        previous--;
+
+    // Lines out of time order have no extent to number
+    const double left = mKeyAxis->coordToPixel(previous < 0 ? 0 : ends[previous]);
+    const double right = mKeyAxis->coordToPixel(ends[index]);
+    const QString text = QString::number(index + 1);
+    const int width = metrics.horizontalAdvance(text);
+    if (right - left < width + labelPadding)
+        return;
+
+    // Centred in the utterance, hanging from the middle of the waveform
+    const double top = mValueAxis->coordToPixel(0);
+    painter->drawText(QPointF((left + right - width) / 2, top + metrics.ascent()), text);
+}
+
+void BoundaryPlottable::drawLegendIcon(QCPPainter* painter, const QRectF& rect) const
+{
+    painter->setPen(mPen);
+    painter->drawLine(QLineF(rect.center().x(), rect.top(), rect.center().x(), rect.bottom()));
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "mediaplayer/qcustomplot.h"
+
+/**
+ * @class BoundaryPlottable
+ * @brief Draws utterance end boundaries and utterance numbers.
+ *
+ * Boundaries are end times in seconds, in transcript order; NaN marks an untimed
+ * utterance, which has no boundary. Transcripts aren't always in time order, so the
+ * boundaries are also kept as a permutation sorted by time. A replot binary searches
+ * it for the visible key range and draws only what falls inside it, at most one line
+ * per pixel column and a number only where the utterance is wide enough for it, so
+ * the cost follows the view rather than the length of the transcript. Hit testing is
+ * a binary search in pixel space.
+ *
+ * While a boundary is dragged it can be drawn by a second instance on a faster layer,
+ * see setPreviewOf(); this one then leaves it and its two numbers out.
+ */
+class BoundaryPlottable : public QCPAbstractPlottable
+{
+    Q_OBJECT
+
+public:
+    BoundaryPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis);
+
+    /// Replaces all boundaries, NaN for untimed utterances.
+    void setBoundaries(const QVector<double>& ends);
+    /// Adds a boundary for a new last utterance, drawn with the added pen until the next setBoundaries().
+    void append(double end);
+    void setBoundary(int index, double end);
+
+    const QVector<double>& boundaries() const { return m_ends; }
+    int count() const { return m_ends.size(); }
+    double boundary(int index) const { return m_ends[index]; }
+
+    /// Index of the boundary within \a tolerance pixels of \a pixelX, -1 if none.
+    int boundaryAt(double pixelX, double tolerance) const;
+
+    void setDragged(int index) { m_dragged = index; }
+    int dragged() const { return m_dragged; }
+
+    /// Makes this instance draw only the boundary \a source is dragging.
+    void setPreviewOf(const BoundaryPlottable* source) { m_source = source; }
+
+    void setAddedPen(const QPen& pen) { m_addedPen = pen; }
+    void setDraggedPen(const QPen& pen) { m_draggedPen = pen; }
+    void setLabelFont(const QFont& font) { m_labelFont = font; }
+    void setLabelColor(const QColor& color) { m_labelColor = color; }
+
+    double selectTest(const QPointF& pos, bool onlySelectable, QVariant* details = nullptr) const override;
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+    void drawLegendIcon(QCPPainter* painter, const QRectF& rect) const override;
+
+private:
+    void drawPreview(QCPPainter* painter);
+    /// Position in m_order of the first boundary at or after \a key.
+    int lowerBound(double key) const;
+    void insertOrdered(int index);
+    /// Numbers utterance \a index of \a ends, which runs from the previous timed boundary (or 0) to its own.
+    void drawLabel(QCPPainter* painter, const QVector<double>& ends, int index, const QFontMetrics& metrics) const;
+
+    QVector<double> m_ends;
+    QVector<int> m_order;   ///< Indices of the timed boundaries, sorted by time.
+    int m_firstAdded{0};
+    int m_dragged{-1};
+    const BoundaryPlottable* m_source{nullptr};
+
+    QPen m_addedPen;
+    QPen m_draggedPen;
+    QFont m_labelFont;
+    QColor m_labelColor;
+};
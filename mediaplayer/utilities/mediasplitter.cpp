@@ -1,4 +1,5 @@
 #include "mediasplitter.h"
+#include "profiling/profiler.h"
 #include "qdir.h"
 #include "qfileinfo.h"
 #include "qurl.h"
@@ -90,6 +91,7 @@ void MediaSplitter::splitMedia() {
 
 bool MediaSplitter::splitMediaUtil(uint64_t startSeconds = 0, uint64_t endSeconds = 0)
 {
+    PROFILE_SCOPE("MediaSplitter::splitMediaUtil");
 
     int operationResult;
 
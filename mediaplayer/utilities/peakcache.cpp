@@ -0,0 +1,176 @@
+#include "peakcache.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+
+namespace {
+
+constexpr char magic[8] = {'V', 'G', 'Y', 'P', 'E', 'A', 'K', 'S'};
+constexpr quint32 byteOrderMark = 0x01020304;
+constexpr quint32 formatVersion = 1;
+constexpr quint32 maxLevels = 48;
+
+constexpr int fingerprintChunks = 16;
+constexpr qint64 fingerprintChunkSize = 64 * 1024;
+
+/// Fixed layout at the start of every entry, followed by the bin count of every
+/// level and then the bins of every level, finest first.
+struct Header
+{
+    char magic[8];
+    quint32 byteOrder;
+    quint32 version;
+    quint32 baseShift;
+    quint32 levelCount;
+    qint32 sampleRate;
+    qint32 channels;
+    qint64 sampleCount;
+    qint64 durationMs;
+    float peak;
+    quint32 reserved;
+};
+static_assert(sizeof(Header) == 56, "the cache header layout is part of the file format");
+static_assert(sizeof(PeakPyramid::Bin) == 6, "the bin layout is part of the file format");
+
+}
+
+QString PeakCache::fingerprint(const QString& mediaFile)
+{
+    QFileInfo info(mediaFile);
+    QFile file(mediaFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const qint64 size = file.size();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(&size), sizeof(size)));
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(&modified), sizeof(modified)));
+
+    // Chunks spread evenly over the file, so the cost doesn't grow with its length
+    if (size <= fingerprintChunks * fingerprintChunkSize) {
+        hash.addData(&file);
+    }
+    else {
+        const qint64 stride = (size - fingerprintChunkSize) / (fingerprintChunks - 1);
+        for (int i = 0; i < fingerprintChunks; i++) {
+            if (!file.seek(i * stride))
+                return {};
+            hash.addData(file.read(fingerprintChunkSize));
+        }
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString PeakCache::directory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/waveform";
+}
+
+QString PeakCache::entryPath(const QString& key)
+{
+    return directory() + "/" + key + ".peaks";
+}
+
+bool PeakCache::load(const QString& key, PeakPyramid& peaks, AudioDecoder::Info& info)
+{
+    if (key.isEmpty())
+        return false;
+
+    auto file = std::make_shared<QFile>(entryPath(key));
+    if (!file->open(QIODevice::ReadOnly) || file->size() < qint64(sizeof(Header)))
+        return false;
+
+    const uchar* data = file->map(0, file->size());
+    if (!data)
+        return false;
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0 || header.byteOrder != byteOrderMark
+        || header.version != formatVersion || header.baseShift != quint32(PeakPyramid::baseShift)
+        || header.levelCount > maxLevels || header.sampleRate <= 0)
+        return false;
+
+    QVector<qint64> counts(header.levelCount);
+    qint64 offset = sizeof(Header);
+    if (file->size() < offset + qint64(header.levelCount * sizeof(qint64)))
+        return false;
+    memcpy(counts.data(), data + offset, header.levelCount * sizeof(qint64));
+    offset += header.levelCount * sizeof(qint64);
+
+    QVector<PeakPyramid::LevelView> levels;
+    for (auto count: std::as_const(counts)) {
+        if (count < 0 || file->size() < offset + count * qint64(sizeof(PeakPyramid::Bin)))
+            return false;
+        levels.append({reinterpret_cast<const PeakPyramid::Bin*>(data + offset), count});
+        offset += count * sizeof(PeakPyramid::Bin);
+    }
+    if (offset != file->size())
+        return false;
+
+    // The mapping lives as long as the file object, which the pyramid now keeps
+    peaks.adopt(header.sampleRate, header.sampleCount, header.peak, levels, file);
+
+    info.sampleRate = header.sampleRate;
+    info.channels = header.channels;
+    info.durationMs = header.durationMs;
+    info.estimatedSamples = header.sampleCount;
+    return true;
+}
+
+bool PeakCache::save(const QString& key, const PeakPyramid& peaks, const AudioDecoder::Info& info)
+{
+    if (key.isEmpty() || peaks.levelCount() == 0 || !QDir().mkpath(directory()))
+        return false;
+
+    Header header{};
+    memcpy(header.magic, magic, sizeof(magic));
+    header.byteOrder = byteOrderMark;
+    header.version = formatVersion;
+    header.baseShift = PeakPyramid::baseShift;
+    header.levelCount = peaks.levelCount();
+    header.sampleRate = peaks.sampleRate();
+    header.channels = info.channels;
+    header.sampleCount = peaks.sampleCount();
+    header.durationMs = info.durationMs;
+    header.peak = peaks.peak();
+
+    QSaveFile file(entryPath(key));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (int level = 0; level < peaks.levelCount(); level++) {
+        qint64 count = peaks.binCount(level);
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    for (int level = 0; level < peaks.levelCount(); level++)
+        file.write(reinterpret_cast<const char*>(peaks.bins(level)), peaks.binCount(level) * sizeof(PeakPyramid::Bin));
+
+    if (!file.commit())
+        return false;
+
+    prune();
+    return true;
+}
+
+void PeakCache::prune()
+{
+    QDir cache(directory());
+    auto entries = cache.entryInfoList({"*.peaks"}, QDir::Files, QDir::Time);
+
+    // Newest first, everything past the budget goes
+    qint64 total = 0;
+    for (auto& entry: std::as_const(entries)) {
+        total += entry.size();
+        if (total > maxBytes)
+            QFile::remove(entry.filePath());
+    }
+}
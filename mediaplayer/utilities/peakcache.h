@@ -0,0 +1,38 @@
+#pragma once
+
+#include "audiodecoder.h"
+#include "peakpyramid.h"
+
+#include <QString>
+
+/**
+ * @class PeakCache
+ * @brief Keeps finished peak pyramids on disk so a media file is decoded only once.
+ *
+ * Entries live in the user cache directory, one binary file per media file, keyed
+ * by fingerprint(). A cached pyramid is memory mapped rather than read, so opening
+ * a long recording again costs a few page faults. The oldest entries are removed
+ * once the cache grows past maxBytes.
+ */
+class PeakCache
+{
+public:
+    static constexpr qint64 maxBytes = qint64(512) << 20;
+
+    /**
+     * @brief Cheap content key for \a mediaFile: size, modification time and a hash of sampled chunks.
+     * @return empty if the file can't be read.
+     */
+    static QString fingerprint(const QString& mediaFile);
+
+    static QString directory();
+
+    /// Maps the entry for \a key into \a peaks and fills \a info, false if there is no usable entry.
+    static bool load(const QString& key, PeakPyramid& peaks, AudioDecoder::Info& info);
+    /// Writes a finished pyramid; safe to call from worker threads.
+    static bool save(const QString& key, const PeakPyramid& peaks, const AudioDecoder::Info& info);
+
+private:
+    static QString entryPath(const QString& key);
+    static void prune();
+};
@@ -0,0 +1,102 @@
+#include "peakpyramid.h"
+#include "samplekernels.h"
+
+#include <cmath>
+
+namespace {
+
+qint16 quantize(float value)
+{
+    return qint16(qBound(-32767L, std::lround(value * 32767.0f), 32767L));
+}
+
+quint16 quantizeRms(double value)
+{
+    return quint16(qBound(0L, std::lround(value * 65535.0), 65535L));
+}
+
+}
+
+void PeakPyramid::reset(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+    m_sampleCount = 0;
+    m_peak = 0;
+    m_levels.clear();
+    m_views.clear();
+    m_storage.reset();
+}
+
+void PeakPyramid::adopt(int sampleRate, qint64 sampleCount, float peak, const QVector<LevelView>& levels,
+                        std::shared_ptr<const void> storage)
+{
+    reset(sampleRate);
+    m_sampleCount = sampleCount;
+    m_peak = peak;
+    m_views = levels;
+    m_storage = std::move(storage);
+}
+
+PeakPyramid::Bin PeakPyramid::combine(const Bin& a, const Bin& b)
+{
+    float rmsA = rmsToFloat(a.rms);
+    float rmsB = rmsToFloat(b.rms);
+    return {qMin(a.min, b.min), qMax(a.max, b.max), quantizeRms(std::sqrt((rmsA * rmsA + rmsB * rmsB) / 2))};
+}
+
+void PeakPyramid::pushBin(int level, Bin bin)
+{
+    Q_ASSERT_X(!m_storage, "PeakPyramid", "adopted pyramids are read only");
+    if (level == m_levels.size())
+        m_levels.append(QVector<Bin>());
+
+    auto& bins = m_levels[level];
+    bins.append(bin);
+    // Every second bin completes one bin of the level above
+    if (bins.size() % 2 == 0)
+        pushBin(level + 1, combine(bins[bins.size() - 2], bins.last()));
+}
+
+void PeakPyramid::summarize(const float* samples, int count, Bin* bins)
+{
+    for (int first = 0, bin = 0; first < count; first += binSamples, bin++) {
+        const int length = qMin(count - first, binSamples);
+        const auto summary = SampleKernels::reduce(samples + first, length);
+        bins[bin] = {quantize(summary.min), quantize(summary.max), quantizeRms(std::sqrt(double(summary.energy) / length))};
+    }
+}
+
+void PeakPyramid::appendBins(const Bin* bins, int count, qint64 samples)
+{
+    for (int i = 0; i < count; i++) {
+        m_peak = qMax(m_peak, qMax(std::abs(toFloat(bins[i].min)), std::abs(toFloat(bins[i].max))));
+        pushBin(0, bins[i]);
+    }
+    m_sampleCount += samples;
+}
+
+void PeakPyramid::finish()
+{
+    // A trailing bin without a partner still has to show up on the coarser levels
+    for (int level = 0; level < m_levels.size() && m_levels[level].size() > 1; level++) {
+        if (m_levels[level].size() % 2 == 1)
+            pushBin(level + 1, m_levels[level].last());
+    }
+}
+
+int PeakPyramid::levelFor(double samplesPerPixel) const
+{
+    if (levelCount() == 0 || samplesPerPixel < samplesPerBin(0))
+        return 0;
+    int level = int(std::floor(std::log2(samplesPerPixel))) - baseShift;
+    return qBound(0, level, levelCount() - 1);
+}
+
+qint64 PeakPyramid::memoryUsage() const
+{
+    // Adopted levels are paged in by the OS as they are drawn
+    qint64 bytes = 0;
+    for (auto& bins: m_levels)
+        bytes += bins.capacity() * qint64(sizeof(Bin));
+    return bytes;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+#include <memory>
+
+/**
+ * @class PeakPyramid
+ * @brief Min/max/RMS summaries of a recording at 2^k samples per bin.
+ *
+ * The finest level holds one bin per 2^baseShift samples and every level above
+ * halves the bin count, so the whole pyramid costs about twice its finest level:
+ * a few MB for an hour of audio instead of the samples themselves. Decoded samples
+ * are summarised into finest level bins with summarize(), usually on the decoder
+ * thread, and appendBins() builds the levels above in the same pass. A view picks
+ * the level that gives about one bin per pixel column. A finished pyramid can also be adopted read only from
+ * memory it doesn't own, such as a mapped \c PeakCache file.
+ */
+class PeakPyramid
+{
+public:
+    /// Values are stored at 16 bit, min and max as signed full scale, rms as unsigned full scale.
+    struct Bin
+    {
+        qint16 min{0};
+        qint16 max{0};
+        quint16 rms{0};
+    };
+
+    static constexpr int baseShift = 8; ///< 256 samples per bin on the finest level.
+
+    void reset(int sampleRate);
+
+    /// Finest first bin arrays of a finished pyramid, with their bin counts.
+    using LevelView = std::pair<const Bin*, qint64>;
+    /**
+     * @brief Shows \a levels without copying them; \a storage keeps their memory alive.
+     *
+     * The pyramid is read only until the next reset().
+     */
+    void adopt(int sampleRate, qint64 sampleCount, float peak, const QVector<LevelView>& levels,
+               std::shared_ptr<const void> storage);
+
+    static constexpr int binSamples = 1 << baseShift;
+
+    /**
+     * @brief Summarises \a count samples in [-1, 1] into binsFor(count) finest level bins.
+     *
+     * Every bin but the last covers binSamples samples, so chunks that are a multiple
+     * of binSamples long can be summarised independently. Each bin is one
+     * SampleKernels::reduce() call.
+     */
+    static void summarize(const float* samples, int count, Bin* bins);
+    static int binsFor(int count) { return (count + binSamples - 1) / binSamples; }
+
+    /// Appends finest level bins from summarize() covering \a samples samples.
+    void appendBins(const Bin* bins, int count, qint64 samples);
+    /// Carries the trailing bins of the recording up into every level.
+    void finish();
+
+    int sampleRate() const { return m_sampleRate; }
+    qint64 sampleCount() const { return m_sampleCount; }
+    double duration() const { return m_sampleRate > 0 ? double(m_sampleCount) / m_sampleRate : 0; }
+    /// Largest absolute sample value, for normalising the view.
+    float peak() const { return m_peak; }
+
+    int levelCount() const { return m_storage ? m_views.size() : m_levels.size(); }
+    static qint64 samplesPerBin(int level) { return qint64(1) << (baseShift + level); }
+    const Bin* bins(int level) const { return m_storage ? m_views[level].first : m_levels[level].constData(); }
+    qint64 binCount(int level) const { return m_storage ? m_views[level].second : m_levels[level].size(); }
+    /// Coarsest level whose bins are no wider than \a samplesPerPixel.
+    int levelFor(double samplesPerPixel) const;
+
+    qint64 memoryUsage() const;
+
+    static Bin combine(const Bin& a, const Bin& b);
+    static float toFloat(qint16 value) { return value / 32767.0f; }
+    static float rmsToFloat(quint16 value) { return value / 65535.0f; }
+
+private:
+    void pushBin(int level, Bin bin);
+
+    int m_sampleRate{0};
+    qint64 m_sampleCount{0};
+    float m_peak{0};
+
+    QVector<QVector<Bin>> m_levels;
+
+    // Adopted levels, see adopt()
+    QVector<LevelView> m_views;
+    std::shared_ptr<const void> m_storage;
+};
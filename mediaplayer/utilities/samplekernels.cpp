@@ -0,0 +1,270 @@
+#include "samplekernels.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SAMPLE_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit instructions a function is marked for, MSVC emits any intrinsic
+#if defined(SAMPLE_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+namespace {
+
+constexpr float int16Scale = 1.0f / 32768.0f;
+
+using Int16ToFloat = void (*)(const qint16*, int, float*);
+using Reduce = SampleKernels::Summary (*)(const float*, int);
+
+struct Kernels
+{
+    Int16ToFloat int16ToFloat;
+    Reduce reduce;
+};
+
+// Scalar ------------------------------------------------------------------------
+
+void int16ToFloatScalar(const qint16* samples, int count, float* output)
+{
+    for (int i = 0; i < count; i++)
+        output[i] = samples[i] * int16Scale;
+}
+
+/// Finishes a reduction over the samples a vector loop left over.
+SampleKernels::Summary reduceTail(const float* samples, int first, int count, SampleKernels::Summary summary)
+{
+    for (int i = first; i < count; i++) {
+        summary.min = std::min(summary.min, samples[i]);
+        summary.max = std::max(summary.max, samples[i]);
+        summary.energy += samples[i] * samples[i];
+    }
+    return summary;
+}
+
+SampleKernels::Summary reduceScalar(const float* samples, int count)
+{
+    return reduceTail(samples, 0, count, {samples[0], samples[0], 0});
+}
+
+#ifdef SAMPLE_KERNELS_X86
+
+// SSE2 --------------------------------------------------------------------------
+
+TARGET_SSE2 float horizontalMin(__m128 v)
+{
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+TARGET_SSE2 float horizontalMax(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+TARGET_SSE2 float horizontalSum(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+TARGET_SSE2 void int16ToFloatSse2(const qint16* samples, int count, float* output)
+{
+    const __m128 scale = _mm_set1_ps(int16Scale);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        // Duplicating each sample into both halves of a 32 bit lane and shifting back sign extends it
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    int16ToFloatScalar(samples + i, count - i, output + i);
+}
+
+TARGET_SSE2 SampleKernels::Summary reduceSse2(const float* samples, int count)
+{
+    if (count < 8)
+        return reduceScalar(samples, count);
+
+    __m128 low = _mm_loadu_ps(samples);
+    __m128 high = low;
+    // Two accumulators hide the latency of the adds
+    __m128 energy0 = _mm_setzero_ps();
+    __m128 energy1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128 a = _mm_loadu_ps(samples + i);
+        const __m128 b = _mm_loadu_ps(samples + i + 4);
+        low = _mm_min_ps(low, _mm_min_ps(a, b));
+        high = _mm_max_ps(high, _mm_max_ps(a, b));
+        energy0 = _mm_add_ps(energy0, _mm_mul_ps(a, a));
+        energy1 = _mm_add_ps(energy1, _mm_mul_ps(b, b));
+    }
+    SampleKernels::Summary summary{horizontalMin(low), horizontalMax(high), horizontalSum(_mm_add_ps(energy0, energy1))};
+    return reduceTail(samples, i, count, summary);
+}
+
+// AVX2 --------------------------------------------------------------------------
+
+TARGET_AVX2 void int16ToFloatAvx2(const qint16* samples, int count, float* output)
+{
+    const __m256 scale = _mm256_set1_ps(int16Scale);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i low = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)));
+        const __m256i high = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i + 8)));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(low), scale));
+        _mm256_storeu_ps(output + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(high), scale));
+    }
+    int16ToFloatScalar(samples + i, count - i, output + i);
+}
+
+TARGET_AVX2 SampleKernels::Summary reduceAvx2(const float* samples, int count)
+{
+    if (count < 16)
+        return reduceScalar(samples, count);
+
+    __m256 low = _mm256_loadu_ps(samples);
+    __m256 high = low;
+    __m256 energy0 = _mm256_setzero_ps();
+    __m256 energy1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256 a = _mm256_loadu_ps(samples + i);
+        const __m256 b = _mm256_loadu_ps(samples + i + 8);
+        low = _mm256_min_ps(low, _mm256_min_ps(a, b));
+        high = _mm256_max_ps(high, _mm256_max_ps(a, b));
+        energy0 = _mm256_add_ps(energy0, _mm256_mul_ps(a, a));
+        energy1 = _mm256_add_ps(energy1, _mm256_mul_ps(b, b));
+    }
+    const __m256 energy = _mm256_add_ps(energy0, energy1);
+    SampleKernels::Summary summary{
+        horizontalMin(_mm_min_ps(_mm256_castps256_ps128(low), _mm256_extractf128_ps(low, 1))),
+        horizontalMax(_mm_max_ps(_mm256_castps256_ps128(high), _mm256_extractf128_ps(high, 1))),
+        horizontalSum(_mm_add_ps(_mm256_castps256_ps128(energy), _mm256_extractf128_ps(energy, 1)))
+    };
+    return reduceTail(samples, i, count, summary);
+}
+
+bool cpuSupports(SampleKernels::InstructionSet set)
+{
+    using Set = SampleKernels::InstructionSet;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = info[3] & (1 << 26);
+    if (set == Set::Sse2)
+        return sse2;
+    // AVX2 also needs the OS to save the upper halves of the registers
+    const bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    if (maxLeaf < 7 || !osSavesAvx)
+        return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    if (set == Set::Sse2)
+        return __builtin_cpu_supports("sse2");
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+const Kernels& kernelsFor(SampleKernels::InstructionSet set)
+{
+    static const Kernels scalar{int16ToFloatScalar, reduceScalar};
+#ifdef SAMPLE_KERNELS_X86
+    static const Kernels sse2{int16ToFloatSse2, reduceSse2};
+    static const Kernels avx2{int16ToFloatAvx2, reduceAvx2};
+    if (set == SampleKernels::InstructionSet::Avx2)
+        return avx2;
+    if (set == SampleKernels::InstructionSet::Sse2)
+        return sse2;
+#endif
+    Q_UNUSED(set)
+    return scalar;
+}
+
+std::atomic<const Kernels*>& activeKernels()
+{
+    static std::atomic<const Kernels*> active{&kernelsFor(SampleKernels::supportedInstructionSets().last())};
+    return active;
+}
+
+std::atomic<SampleKernels::InstructionSet>& activeSet()
+{
+    static std::atomic<SampleKernels::InstructionSet> set{SampleKernels::supportedInstructionSets().last()};
+    return set;
+}
+
+}
+
+QList<SampleKernels::InstructionSet> SampleKernels::supportedInstructionSets()
+{
+    static const QList<InstructionSet> supported = []() {
+        QList<InstructionSet> sets{InstructionSet::Scalar};
+#ifdef SAMPLE_KERNELS_X86
+        if (cpuSupports(InstructionSet::Sse2))
+            sets.append(InstructionSet::Sse2);
+        if (cpuSupports(InstructionSet::Avx2))
+            sets.append(InstructionSet::Avx2);
+#endif
+        return sets;
+    }();
+    return supported;
+}
+
+SampleKernels::InstructionSet SampleKernels::instructionSet()
+{
+    return activeSet().load(std::memory_order_relaxed);
+}
+
+void SampleKernels::setInstructionSet(InstructionSet set)
+{
+    if (!supportedInstructionSets().contains(set))
+        set = supportedInstructionSets().last();
+    activeSet().store(set, std::memory_order_relaxed);
+    activeKernels().store(&kernelsFor(set), std::memory_order_release);
+}
+
+const char* SampleKernels::name(InstructionSet set)
+{
+    switch (set) {
+    case InstructionSet::Sse2:
+        return "sse2";
+    case InstructionSet::Avx2:
+        return "avx2";
+    case InstructionSet::Scalar:
+        break;
+    }
+    return "scalar";
+}
+
+void SampleKernels::int16ToFloat(const qint16* samples, int count, float* output)
+{
+    activeKernels().load(std::memory_order_acquire)->int16ToFloat(samples, count, output);
+}
+
+SampleKernels::Summary SampleKernels::reduce(const float* samples, int count)
+{
+    return activeKernels().load(std::memory_order_acquire)->reduce(samples, count);
+}
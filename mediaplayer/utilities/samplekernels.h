@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @class SampleKernels
+ * @brief Vectorised inner loops over decoded audio, picked for the CPU at run time.
+ *
+ * Every kernel has a scalar version and, on x86, SSE2 and AVX2 versions. The best
+ * one the CPU supports is used unless setInstructionSet() says otherwise, which is
+ * meant for benchmarks. The kernels work on caller owned buffers and never allocate.
+ */
+class SampleKernels
+{
+public:
+    enum class InstructionSet { Scalar, Sse2, Avx2 };
+
+    /// Minimum, maximum and sum of squares of a run of samples.
+    struct Summary
+    {
+        float min{0};
+        float max{0};
+        float energy{0};
+    };
+
+    static InstructionSet instructionSet();
+    /// Falls back to the best supported set if \a set isn't available.
+    static void setInstructionSet(InstructionSet set);
+    static QList<InstructionSet> supportedInstructionSets();
+    static const char* name(InstructionSet set);
+
+    /// Converts signed 16 bit samples to floats in [-1, 1).
+    static void int16ToFloat(const qint16* samples, int count, float* output);
+    /// Reduces \a count samples, count > 0.
+    static Summary reduce(const float* samples, int count);
+};
@@ -0,0 +1,137 @@
+#include "spectrogram.h"
+
+#include "audiodecoder.h"
+#include "profiling/profiler.h"
+
+#include <QColor>
+#include <QHash>
+#include <QMutex>
+#include <QScopeGuard>
+
+#include <fftw3.h>
+
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+constexpr double floorDb = -90;   // drawn black
+constexpr double ceilingDb = -10; // drawn white
+constexpr double pi = 3.14159265358979323846;
+
+/// Planning isn't thread safe, so plans are made once under a lock and then only
+/// executed, on buffers from fftw_alloc_real() that share the planning alignment.
+fftw_plan planFor(int frameSize)
+{
+    static QMutex mutex;
+    static QHash<int, fftw_plan> plans;
+
+    QMutexLocker locker(&mutex);
+    auto& plan = plans[frameSize];
+    if (!plan) {
+        double* in = fftw_alloc_real(frameSize);
+        double* out = fftw_alloc_real(frameSize);
+        plan = fftw_plan_r2r_1d(frameSize, in, out, FFTW_R2HC, FFTW_ESTIMATE);
+        fftw_free(in);
+        fftw_free(out);
+    }
+    return plan;
+}
+
+/// Black through blue and red to yellow and white.
+const std::array<QRgb, 256>& palette()
+{
+    static const auto colors = []() {
+        const QColor stops[] = {Qt::black, QColor(32, 0, 128), QColor(192, 0, 64), QColor(255, 192, 0), Qt::white};
+        constexpr int segments = std::size(stops) - 1;
+
+        std::array<QRgb, 256> table;
+        for (int i = 0; i < 256; i++) {
+            double position = i / 255.0 * segments;
+            int segment = qMin(int(position), segments - 1);
+            double t = position - segment;
+            const QColor& a = stops[segment];
+            const QColor& b = stops[segment + 1];
+            table[i] = qRgb(a.red() + t * (b.red() - a.red()),
+                            a.green() + t * (b.green() - a.green()),
+                            a.blue() + t * (b.blue() - a.blue()));
+        }
+        return table;
+    }();
+    return colors;
+}
+
+}
+
+int Spectrogram::validFrameSize(int frameSize)
+{
+    return int(qNextPowerOfTwo(quint32(qBound(minFrameSize, frameSize, maxFrameSize) - 1)));
+}
+
+int Spectrogram::hopShiftFor(int frameSize, double samplesPerPixel)
+{
+    if (samplesPerPixel > 2 * (1 << maxHopShift))
+        return -1;
+
+    const int minShift = int(std::log2(frameSize)) - 2;
+    const int shift = samplesPerPixel > 1 ? int(std::floor(std::log2(samplesPerPixel))) : 0;
+    return qBound(minShift, shift, maxHopShift);
+}
+
+QImage Spectrogram::renderTile(const QString& fileName, int frameSize, int hopShift, qint64 index)
+{
+    PROFILE_SCOPE("Spectrogram::renderTile");
+
+    AudioDecoder decoder(fileName);
+    if (!decoder.open())
+        return {};
+
+    const int sampleRate = decoder.info().sampleRate;
+    const qint64 hop = qint64(1) << hopShift;
+    const int bins = qBound(1, int(maxFrequency * frameSize / sampleRate), frameSize / 2);
+
+    // Column c analyses the frame centred on the middle of its hop
+    const qint64 first = index * tileSamples(hopShift) + hop / 2 - frameSize / 2;
+    const qint64 span = (tileColumns - 1) * hop + frameSize;
+    std::vector<float> samples(span);
+    if (!decoder.decodeRange(first, int(span), samples.data()))
+        return {};
+
+    std::vector<double> window(frameSize);
+    double windowSum = 0;
+    for (int n = 0; n < frameSize; n++) {
+        window[n] = 0.5 - 0.5 * std::cos(2 * pi * n / (frameSize - 1));
+        windowSum += window[n];
+    }
+    // A full scale sine comes out at 0 dB
+    const double scale = 2.0 / windowSum;
+
+    double* in = fftw_alloc_real(frameSize);
+    double* out = fftw_alloc_real(frameSize);
+    auto cleanup = qScopeGuard([&]() {
+        fftw_free(in);
+        fftw_free(out);
+    });
+    const fftw_plan plan = planFor(frameSize);
+    const auto& colors = palette();
+
+    QImage image(tileColumns, bins, QImage::Format_RGB32);
+    for (int column = 0; column < tileColumns; column++) {
+        const float* frame = samples.data() + column * hop;
+        for (int n = 0; n < frameSize; n++)
+            in[n] = frame[n] * window[n];
+        fftw_execute_r2r(plan, in, out);
+
+        // Half complex output: real parts from the front, imaginary parts mirrored from the back
+        for (int k = 0; k < bins; k++) {
+            const double re = out[k];
+            const double im = k > 0 ? out[frameSize - k] : 0;
+            const double db = 20 * std::log10(std::sqrt(re * re + im * im) * scale + 1e-12);
+            const int level = qBound(0, int((db - floorDb) / (ceilingDb - floorDb) * 255), 255);
+            reinterpret_cast<QRgb*>(image.scanLine(bins - 1 - k))[column] = colors[level];
+        }
+    }
+    return image;
+}
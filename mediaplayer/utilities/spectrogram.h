@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+/**
+ * @class Spectrogram
+ * @brief Short-time FFT of a recording, rendered as image tiles.
+ *
+ * A tile is tileColumns analysis frames of frameSize samples, Hann windowed and
+ * 2^hopShift samples apart, so its width in samples depends only on the hop and
+ * a view can pick the hop that gives about one column per pixel. Each tile decodes
+ * just the audio it covers, which keeps the cost independent of the recording's
+ * length. FFTW plans are made once per frame size and shared between threads.
+ */
+class Spectrogram
+{
+public:
+    static constexpr int minFrameSize = 256;
+    static constexpr int maxFrameSize = 2048;
+    static constexpr int tileColumns = 256;
+    static constexpr int maxHopShift = 11;  ///< 2048 samples between columns.
+    static constexpr double maxFrequency = 8000; ///< Speech sits below this, higher bins are not drawn.
+
+    /// \a frameSize clamped to the supported range and rounded up to a power of two.
+    static int validFrameSize(int frameSize);
+    /// Hop between columns for a view showing \a samplesPerPixel, at least a quarter frame;
+    /// -1 when the view is too wide for a spectrogram to be worth decoding.
+    static int hopShiftFor(int frameSize, double samplesPerPixel);
+    static qint64 tileSamples(int hopShift) { return qint64(tileColumns) << hopShift; }
+
+    /**
+     * @brief Renders tile \a index of \a fileName, one column per frame with low frequencies at the bottom.
+     * @return A null image if the file can't be decoded.
+     *
+     * Safe to call from several threads at once.
+     */
+    static QImage renderTile(const QString& fileName, int frameSize, int hopShift, qint64 index);
+};
@@ -0,0 +1,181 @@
+#include "spectrogramplottable.h"
+#include "spectrogram.h"
+
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cmath>
+
+SpectrogramPlottable::SpectrogramPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis)
+    : QCPAbstractPlottable(keyAxis, valueAxis)
+    , m_tiles(cacheKilobytes)
+{
+    setSelectable(QCP::stNone);
+    // Leave cores for the waveform decoder and the player
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+SpectrogramPlottable::~SpectrogramPlottable()
+{
+    // Workers post their tiles to this object
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void SpectrogramPlottable::setSource(const QString& fileName, int sampleRate, double duration)
+{
+    m_duration = duration;
+    if (fileName == m_fileName && sampleRate == m_sampleRate)
+        return;
+
+    m_fileName = fileName;
+    m_sampleRate = sampleRate;
+    reset();
+}
+
+void SpectrogramPlottable::setFrameSize(int frameSize)
+{
+    frameSize = Spectrogram::validFrameSize(frameSize);
+    if (frameSize == m_frameSize)
+        return;
+
+    // Tiles of other frame sizes stay cached, the frame size is part of the key
+    m_frameSize = frameSize;
+}
+
+void SpectrogramPlottable::reset()
+{
+    m_generation++;
+    m_pool.clear();
+    m_tiles.clear();
+    m_pending.clear();
+    m_failed.clear();
+
+    QMutexLocker locker(&m_visibleMutex);
+    m_visible.clear();
+}
+
+quint64 SpectrogramPlottable::tileKey(int hopShift, qint64 index) const
+{
+    const int frameShift = int(std::log2(m_frameSize));
+    return (quint64(index) << 16) | (quint64(hopShift) << 8) | quint64(frameShift);
+}
+
+void SpectrogramPlottable::requestTile(int hopShift, qint64 index, quint64 key)
+{
+    if (m_pending.contains(key) || m_failed.contains(key))
+        return;
+    m_pending.insert(key);
+
+    QtConcurrent::run(&m_pool, [this, generation = m_generation, fileName = m_fileName,
+                                frameSize = m_frameSize, hopShift, index, key]() {
+        {
+            QMutexLocker locker(&m_visibleMutex);
+            if (!m_visible.contains(key)) {
+                QMetaObject::invokeMethod(this, [this, generation, key]() {
+                    tileReady(generation, key, false, {});
+                }, Qt::QueuedConnection);
+                return;
+            }
+        }
+
+        QImage image = Spectrogram::renderTile(fileName, frameSize, hopShift, index);
+        QMetaObject::invokeMethod(this, [this, generation, key, image]() {
+            tileReady(generation, key, true, image);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SpectrogramPlottable::tileReady(int generation, quint64 key, bool rendered, const QImage& image)
+{
+    if (generation != m_generation)
+        return;
+
+    m_pending.remove(key);
+    if (!rendered)
+        return;
+    if (image.isNull()) {
+        m_failed.insert(key);
+        return;
+    }
+
+    m_tiles.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    if (mParentPlot)
+        mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+double SpectrogramPlottable::selectTest(const QPointF& pos, bool onlySelectable, QVariant* details) const
+{
+    Q_UNUSED(pos)
+    Q_UNUSED(onlySelectable)
+    Q_UNUSED(details)
+    return -1;
+}
+
+QCPRange SpectrogramPlottable::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const
+{
+    Q_UNUSED(inSignDomain)
+    foundRange = m_duration > 0;
+    return foundRange ? QCPRange(0, m_duration) : QCPRange();
+}
+
+QCPRange SpectrogramPlottable::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const
+{
+    Q_UNUSED(inSignDomain)
+    Q_UNUSED(inKeyRange)
+    foundRange = true;
+    return QCPRange(0, 1);
+}
+
+void SpectrogramPlottable::draw(QCPPainter* painter)
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    if (!keyAxis || m_fileName.isEmpty() || m_sampleRate <= 0 || m_duration <= 0)
+        return;
+
+    const QRect area = keyAxis->axisRect()->rect();
+    painter->fillRect(area, Qt::black);
+
+    const QCPRange visible = keyAxis->range();
+    const double pixels = std::abs(keyAxis->coordToPixel(visible.upper) - keyAxis->coordToPixel(visible.lower));
+    if (pixels < 1)
+        return;
+
+    const int hopShift = Spectrogram::hopShiftFor(m_frameSize, visible.size() * m_sampleRate / pixels);
+    if (hopShift < 0) {
+        painter->setPen(Qt::gray);
+        painter->drawText(area, Qt::AlignCenter, tr("Zoom in to see the spectrogram"));
+        return;
+    }
+
+    const double tileSeconds = double(Spectrogram::tileSamples(hopShift)) / m_sampleRate;
+    const qint64 first = qMax<qint64>(0, std::floor(visible.lower / tileSeconds));
+    const qint64 last = std::floor(qMin(visible.upper, m_duration) / tileSeconds);
+
+    QSet<quint64> needed;
+    QVector<qint64> missing;
+    for (qint64 index = first; index <= last; index++) {
+        const quint64 key = tileKey(hopShift, index);
+        const double left = keyAxis->coordToPixel(index * tileSeconds);
+        const double right = keyAxis->coordToPixel((index + 1) * tileSeconds);
+        if (const QImage* tile = m_tiles.object(key)) {
+            painter->drawImage(QRectF(left, area.top(), right - left, area.height()), *tile);
+            continue;
+        }
+        needed.insert(key);
+        missing.append(index);
+    }
+
+    // Published before requesting, so the workers don't skip what is about to be asked for
+    {
+        QMutexLocker locker(&m_visibleMutex);
+        m_visible = needed;
+    }
+    for (auto index: std::as_const(missing))
+        requestTile(hopShift, index, tileKey(hopShift, index));
+}
+
+void SpectrogramPlottable::drawLegendIcon(QCPPainter* painter, const QRectF& rect) const
+{
+    painter->fillRect(rect, Qt::black);
+}
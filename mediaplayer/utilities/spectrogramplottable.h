@@ -0,0 +1,64 @@
+#pragma once
+
+#include "mediaplayer/qcustomplot.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QSet>
+#include <QThreadPool>
+
+/**
+ * @class SpectrogramPlottable
+ * @brief Draws the \c Spectrogram of a media file from tiles rendered on demand.
+ *
+ * Tiles of the visible key range are rendered on a private thread pool the first
+ * time they are drawn and kept in a cache of images, so panning back and forth
+ * costs nothing after the first pass. Tiles that scroll out of view before their
+ * turn comes are skipped. Keys are seconds; the value axis is not used, the tiles
+ * fill the axis rect from top to bottom.
+ */
+class SpectrogramPlottable : public QCPAbstractPlottable
+{
+    Q_OBJECT
+
+public:
+    SpectrogramPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis);
+    ~SpectrogramPlottable();
+
+    /// Starts over for \a fileName unless it is already shown, in which case only the duration changes.
+    void setSource(const QString& fileName, int sampleRate, double duration);
+    /// Samples per analysis frame, see Spectrogram::validFrameSize().
+    void setFrameSize(int frameSize);
+    int frameSize() const { return m_frameSize; }
+
+    double selectTest(const QPointF& pos, bool onlySelectable, QVariant* details = nullptr) const override;
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+    void drawLegendIcon(QCPPainter* painter, const QRectF& rect) const override;
+
+private:
+    static constexpr int cacheKilobytes = 64 * 1024;
+
+    quint64 tileKey(int hopShift, qint64 index) const;
+    void requestTile(int hopShift, qint64 index, quint64 key);
+    void tileReady(int generation, quint64 key, bool rendered, const QImage& image);
+    void reset();
+
+    QString m_fileName;
+    int m_sampleRate{0};
+    double m_duration{0};
+    int m_frameSize{1024};
+    int m_generation{0};           ///< Tiles rendered for an older source are dropped.
+
+    QCache<quint64, QImage> m_tiles; ///< Cost in KB.
+    QSet<quint64> m_pending;
+    QSet<quint64> m_failed;
+
+    QMutex m_visibleMutex;
+    QSet<quint64> m_visible;       ///< Tiles the last draw() needed, read by the workers.
+    QThreadPool m_pool;
+};
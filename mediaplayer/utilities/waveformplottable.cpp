@@ -0,0 +1,111 @@
+#include "waveformplottable.h"
+
+#include <cmath>
+
+WaveformPlottable::WaveformPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis)
+    : QCPAbstractPlottable(keyAxis, valueAxis)
+{
+    setSelectable(QCP::stNone);
+}
+
+void WaveformPlottable::setPeaks(const PeakPyramid* peaks)
+{
+    m_peaks = peaks;
+}
+
+double WaveformPlottable::selectTest(const QPointF& pos, bool onlySelectable, QVariant* details) const
+{
+    Q_UNUSED(pos)
+    Q_UNUSED(onlySelectable)
+    Q_UNUSED(details)
+    return -1;
+}
+
+QCPRange WaveformPlottable::getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain) const
+{
+    Q_UNUSED(inSignDomain)
+    foundRange = m_peaks && m_peaks->sampleCount() > 0;
+    return foundRange ? QCPRange(0, m_peaks->duration()) : QCPRange();
+}
+
+QCPRange WaveformPlottable::getValueRange(bool& foundRange, QCP::SignDomain inSignDomain, const QCPRange& inKeyRange) const
+{
+    Q_UNUSED(inKeyRange)
+    foundRange = true;
+    if (inSignDomain == QCP::sdPositive)
+        return QCPRange(0, 1);
+    if (inSignDomain == QCP::sdNegative)
+        return QCPRange(-1, 0);
+    return QCPRange(-1, 1);
+}
+
+void WaveformPlottable::draw(QCPPainter* painter)
+{
+    QCPAxis* keyAxis = mKeyAxis.data();
+    QCPAxis* valueAxis = mValueAxis.data();
+    if (!keyAxis || !valueAxis || !m_peaks || m_peaks->levelCount() == 0)
+        return;
+
+    const QCPRange visible = keyAxis->range();
+    const double rate = m_peaks->sampleRate();
+    const double pixels = std::abs(keyAxis->coordToPixel(visible.upper) - keyAxis->coordToPixel(visible.lower));
+    if (pixels < 1 || rate <= 0)
+        return;
+
+    const int level = m_peaks->levelFor(visible.size() * rate / pixels);
+    const PeakPyramid::Bin* bins = m_peaks->bins(level);
+    const qint64 binSamples = PeakPyramid::samplesPerBin(level);
+    const qint64 first = qMax<qint64>(0, std::floor(visible.lower * rate / binSamples));
+    const qint64 last = qMin<qint64>(m_peaks->binCount(level) - 1, std::ceil(visible.upper * rate / binSamples));
+    if (first > last)
+        return;
+
+    const float scale = m_peaks->peak() > 0 ? 1.0f / m_peaks->peak() : 1.0f;
+
+    // Bins that land on the same pixel column are merged into one line
+    QVector<QLineF> envelope;
+    QVector<QLineF> rms;
+    envelope.reserve(int(pixels) + 2);
+    rms.reserve(int(pixels) + 2);
+
+    int column = 0;
+    float low = 0, high = 0, loudness = 0;
+    bool open = false;
+    auto flush = [&]() {
+        if (!open)
+            return;
+        envelope.append(QLineF(column, valueAxis->coordToPixel(low * scale), column, valueAxis->coordToPixel(high * scale)));
+        rms.append(QLineF(column, valueAxis->coordToPixel(-loudness * scale), column, valueAxis->coordToPixel(loudness * scale)));
+    };
+
+    for (qint64 i = first; i <= last; i++) {
+        int x = int(keyAxis->coordToPixel(double(i * binSamples) / rate));
+        const auto& bin = bins[i];
+        if (!open || x != column) {
+            flush();
+            column = x;
+            low = PeakPyramid::toFloat(bin.min);
+            high = PeakPyramid::toFloat(bin.max);
+            loudness = PeakPyramid::rmsToFloat(bin.rms);
+            open = true;
+        }
+        else {
+            low = qMin(low, PeakPyramid::toFloat(bin.min));
+            high = qMax(high, PeakPyramid::toFloat(bin.max));
+            loudness = qMax(loudness, PeakPyramid::rmsToFloat(bin.rms));
+        }
+    }
+    flush();
+
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mPen);
+    painter->drawLines(envelope);
+    painter->setPen(m_rmsPen);
+    painter->drawLines(rms);
+}
+
+void WaveformPlottable::drawLegendIcon(QCPPainter* painter, const QRectF& rect) const
+{
+    painter->setPen(mPen);
+    painter->drawLine(QLineF(rect.left(), rect.center().y(), rect.right(), rect.center().y()));
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "mediaplayer/qcustomplot.h"
+#include "peakpyramid.h"
+
+/**
+ * @class WaveformPlottable
+ * @brief Draws a \c PeakPyramid as one min/max line and one RMS line per pixel column.
+ *
+ * Only the bins of the visible key range are read, from the pyramid level closest
+ * to one bin per pixel, so a replot costs the same for a minute as for three hours.
+ * Keys are seconds and values are normalised to the loudest sample.
+ */
+class WaveformPlottable : public QCPAbstractPlottable
+{
+    Q_OBJECT
+
+public:
+    WaveformPlottable(QCPAxis* keyAxis, QCPAxis* valueAxis);
+
+    /// The pyramid is not owned and has to outlive the plottable or be unset.
+    void setPeaks(const PeakPyramid* peaks);
+    const PeakPyramid* peaks() const { return m_peaks; }
+
+    void setRmsPen(const QPen& pen) { m_rmsPen = pen; }
+
+    double selectTest(const QPointF& pos, bool onlySelectable, QVariant* details = nullptr) const override;
+    QCPRange getKeyRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const override;
+    QCPRange getValueRange(bool& foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth,
+                           const QCPRange& inKeyRange = QCPRange()) const override;
+
+protected:
+    void draw(QCPPainter* painter) override;
+    void drawLegendIcon(QCPPainter* painter, const QRectF& rect) const override;
+
+private:
+    const PeakPyramid* m_peaks{nullptr};
+    QPen m_rmsPen;
+};
@@ -0,0 +1,105 @@
+#include "keyrecorder.h"
+
+#include <QApplication>
+#include <QKeySequence>
+#include <QWidget>
+
+KeyStroke KeyStroke::fromEvent(const QKeyEvent* event)
+{
+    return {event->key(), event->modifiers(), event->text()};
+}
+
+KeyStroke KeyStroke::typed(QChar character)
+{
+    int key = character == ' ' ? int(Qt::Key_Space) : int(character.toUpper().unicode());
+    return {key, character.isUpper() ? Qt::ShiftModifier : Qt::NoModifier, QString(character)};
+}
+
+KeyStroke KeyStroke::pressed(int key, Qt::KeyboardModifiers modifiers)
+{
+    KeyStroke stroke{key, modifiers, QString()};
+    // Keys that still type something, like Return and Tab, carry their text
+    if (modifiers == Qt::NoModifier) {
+        if (key == Qt::Key_Return || key == Qt::Key_Enter)
+            stroke.text = "\r";
+        else if (key == Qt::Key_Tab)
+            stroke.text = "\t";
+        else if (key == Qt::Key_Backspace)
+            stroke.text = "\b";
+    }
+    return stroke;
+}
+
+KeyStroke KeyStroke::fromLine(const QString& line)
+{
+    // The text may be a space, so only the line break is stripped
+    if (line.startsWith("text ") && line.size() > 5)
+        return typed(line.at(5));
+
+    if (line.startsWith("key ")) {
+        QKeySequence sequence = QKeySequence::fromString(line.mid(4).trimmed(), QKeySequence::PortableText);
+        if (sequence.isEmpty())
+            return {};
+
+        return pressed(sequence[0].key(), sequence[0].keyboardModifiers());
+    }
+
+    return {};
+}
+
+QString KeyStroke::toLine() const
+{
+    bool typing = (modifiers & ~(Qt::ShiftModifier | Qt::KeypadModifier)) == Qt::NoModifier;
+    if (typing && text.size() == 1 && text.at(0).isPrint())
+        return "text " + text;
+
+    return "key " + QKeySequence(QKeyCombination(modifiers, Qt::Key(key))).toString(QKeySequence::PortableText);
+}
+
+QList<KeyStroke> KeyStroke::readLog(const QString& fileName)
+{
+    QList<KeyStroke> strokes;
+    QFile log(fileName);
+    if (!log.open(QIODevice::ReadOnly | QIODevice::Text))
+        return strokes;
+
+    while (!log.atEnd()) {
+        auto line = QString::fromUtf8(log.readLine());
+        if (line.endsWith('\n'))
+            line.chop(1);
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        auto stroke = fromLine(line);
+        if (stroke.isValid())
+            strokes.append(stroke);
+    }
+    return strokes;
+}
+
+KeyRecorder::KeyRecorder(const QString& fileName, QObject* parent)
+    : QObject(parent), m_log(fileName)
+{
+    if (m_log.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        m_log.write("# Vagyojaka key log\n");
+}
+
+bool KeyRecorder::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::KeyPress && m_log.isOpen()) {
+        // Application filters see a press again for every parent it propagates to
+        bool intoEditor = watched->inherits("TextEditor");
+        bool intoPopup = watched->isWidgetType() && watched == QApplication::activePopupWidget();
+
+        auto keyEvent = static_cast<QKeyEvent*>(event);
+        if ((intoEditor || intoPopup) && keyEvent->key() != 0 && keyEvent->key() != Qt::Key_unknown) {
+            auto stroke = KeyStroke::fromEvent(keyEvent);
+            // Bare modifier presses only matter as part of a combination
+            if (stroke.key < Qt::Key_Shift || stroke.key > Qt::Key_Alt) {
+                m_log.write(stroke.toLine().toUtf8() + "\n");
+                m_log.flush();
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
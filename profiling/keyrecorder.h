@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QFile>
+#include <QKeyEvent>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+/**
+ * @brief One key press of a key log.
+ *
+ * A log has one press per line: "text <character>" for typed characters and
+ * "key <portable key sequence>" (e.g. "key Ctrl+M") for everything else.
+ * Empty lines and lines starting with '#' are ignored.
+ */
+struct KeyStroke
+{
+    int key{0};
+    Qt::KeyboardModifiers modifiers{Qt::NoModifier};
+    QString text;
+
+    bool isValid() const { return key != 0; }
+
+    static KeyStroke fromEvent(const QKeyEvent* event);
+    static KeyStroke fromLine(const QString& line);
+    static KeyStroke typed(QChar character);
+    static KeyStroke pressed(int key, Qt::KeyboardModifiers modifiers = Qt::NoModifier);
+    QString toLine() const;
+
+    static QList<KeyStroke> readLog(const QString& fileName);
+};
+
+/**
+ * @class KeyRecorder
+ * @brief Application wide event filter that logs the key presses given to the transcript editors.
+ *
+ * Presses into completer popups are logged as well, so a log replays the same
+ * completer navigation. The log is flushed on every press.
+ */
+class KeyRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KeyRecorder(const QString& fileName, QObject* parent = nullptr);
+
+    bool isOpen() const { return m_log.isOpen(); }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    QFile m_log;
+};
@@ -0,0 +1,331 @@
+#include "profiler.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDateTime>
+#include <QCoreApplication>
+#include <QThread>
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+std::atomic<int> Profiler::s_modes{0};
+
+namespace {
+
+// Written only by the owning thread, so relaxed loads and stores are enough
+struct PointHistogram
+{
+    std::atomic<quint64> count{0};
+    std::atomic<std::int64_t> totalNs{0};
+    std::atomic<std::int64_t> maxNs{0};
+    std::array<std::atomic<quint64>, Profiler::BucketCount> buckets{};
+};
+
+struct ThreadHistograms
+{
+    std::array<PointHistogram, Profiler::MaxPoints> points;
+    int id{0};
+};
+
+// A slot is valid when its sequence matches the event number written into it
+struct TraceSlot
+{
+    std::atomic<quint64> sequence{0};
+    std::atomic<int> point{0};
+    std::atomic<int> thread{0};
+    std::atomic<std::int64_t> startNs{0};
+    std::atomic<std::int64_t> durationNs{0};
+};
+
+struct TraceBuffer
+{
+    explicit TraceBuffer(int capacity) : slots(capacity) {}
+
+    std::vector<TraceSlot> slots;
+    std::atomic<quint64> next{0};
+};
+
+struct Registry
+{
+    QMutex mutex;
+    QVector<QString> names;
+    std::vector<std::unique_ptr<ThreadHistograms>> threads; ///< Kept after a thread exits, so its samples still count.
+    QVector<QString> threadNames;
+    std::atomic<TraceBuffer*> trace{nullptr}; ///< Never freed once allocated, recording threads may still hold it.
+};
+
+const auto traceEpoch = std::chrono::steady_clock::now();
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadHistograms& threadHistograms()
+{
+    thread_local ThreadHistograms* histograms = [] {
+        auto& reg = registry();
+        QMutexLocker locker(&reg.mutex);
+        reg.threads.push_back(std::make_unique<ThreadHistograms>());
+        reg.threads.back()->id = int(reg.threads.size());
+
+        auto thread = QThread::currentThread();
+        auto name = thread->objectName();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+            name = "Main";
+        else if (name.isEmpty())
+            name = QString("Thread %1").arg(reg.threads.size());
+        reg.threadNames.append(name);
+
+        return reg.threads.back().get();
+    }();
+    return *histograms;
+}
+
+int bucketFor(std::int64_t nanoseconds)
+{
+    if (nanoseconds <= 1)
+        return 0;
+    int bucket = int(std::log2(double(nanoseconds)) * 4);
+    return qBound(0, bucket, Profiler::BucketCount - 1);
+}
+
+double bucketUpperMs(int bucket)
+{
+    return std::exp2((bucket + 1) / 4.0) / 1e6;
+}
+
+template<typename T>
+void addRelaxed(std::atomic<T>& value, T delta)
+{
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+}
+
+void Profiler::setMode(Mode mode, bool enabled)
+{
+    if (enabled)
+        s_modes.fetch_or(mode, std::memory_order_relaxed);
+    else
+        s_modes.fetch_and(~mode, std::memory_order_relaxed);
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    setMode(Statistics, enabled);
+}
+
+void Profiler::setTracing(bool enabled, int capacity)
+{
+    auto& reg = registry();
+    if (enabled && !reg.trace.load(std::memory_order_acquire)) {
+        QMutexLocker locker(&reg.mutex);
+        if (!reg.trace.load(std::memory_order_relaxed))
+            reg.trace.store(new TraceBuffer(qMax(1024, capacity)), std::memory_order_release);
+    }
+    setMode(Tracing, enabled);
+}
+
+int Profiler::registerPoint(const char* name)
+{
+    auto& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+
+    auto pointName = QString::fromUtf8(name);
+    int point = reg.names.indexOf(pointName);
+    if (point != -1)
+        return point;
+    if (reg.names.size() >= MaxPoints)
+        return -1;
+
+    reg.names.append(pointName);
+    return reg.names.size() - 1;
+}
+
+void Profiler::record(int point, std::int64_t nanoseconds)
+{
+    if (point < 0 || point >= MaxPoints)
+        return;
+
+    auto& histogram = threadHistograms().points[point];
+    addRelaxed<quint64>(histogram.count, 1);
+    addRelaxed<std::int64_t>(histogram.totalNs, nanoseconds);
+    if (nanoseconds > histogram.maxNs.load(std::memory_order_relaxed))
+        histogram.maxNs.store(nanoseconds, std::memory_order_relaxed);
+    addRelaxed<quint64>(histogram.buckets[bucketFor(nanoseconds)], 1);
+}
+
+void Profiler::recordTrace(int point, std::chrono::steady_clock::time_point start, std::int64_t nanoseconds)
+{
+    auto buffer = registry().trace.load(std::memory_order_acquire);
+    if (!buffer || point < 0)
+        return;
+
+    auto sequence = buffer->next.fetch_add(1, std::memory_order_relaxed) + 1;
+    auto& slot = buffer->slots[(sequence - 1) % buffer->slots.size()];
+
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.point.store(point, std::memory_order_relaxed);
+    slot.thread.store(threadHistograms().id, std::memory_order_relaxed);
+    slot.startNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start - traceEpoch).count(),
+                       std::memory_order_relaxed);
+    slot.durationNs.store(nanoseconds, std::memory_order_relaxed);
+    slot.sequence.store(sequence, std::memory_order_release);
+}
+
+QVector<ProfileStat> Profiler::snapshot()
+{
+    auto& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+
+    QVector<ProfileStat> stats;
+    for (int point = 0; point < reg.names.size(); point++) {
+        ProfileStat stat;
+        stat.name = reg.names[point];
+
+        std::array<quint64, BucketCount> buckets{};
+        std::int64_t totalNs = 0, maxNs = 0;
+        for (auto& thread: reg.threads) {
+            auto& histogram = thread->points[point];
+            stat.count += histogram.count.load(std::memory_order_relaxed);
+            totalNs += histogram.totalNs.load(std::memory_order_relaxed);
+            maxNs = qMax(maxNs, histogram.maxNs.load(std::memory_order_relaxed));
+            for (int b = 0; b < BucketCount; b++)
+                buckets[b] += histogram.buckets[b].load(std::memory_order_relaxed);
+        }
+        if (!stat.count)
+            continue;
+
+        stat.totalMs = totalNs / 1e6;
+        stat.maxMs = maxNs / 1e6;
+
+        // Percentiles are reported as the upper bound of their bucket, within 19% of the true value
+        auto percentile = [&](double fraction) {
+            quint64 rank = quint64(std::ceil(fraction * stat.count)), seen = 0;
+            for (int b = 0; b < BucketCount; b++) {
+                seen += buckets[b];
+                if (seen >= rank)
+                    return qMin(bucketUpperMs(b), stat.maxMs);
+            }
+            return stat.maxMs;
+        };
+        stat.p50Ms = percentile(0.50);
+        stat.p99Ms = percentile(0.99);
+        stats.append(stat);
+    }
+    return stats;
+}
+
+QJsonObject Profiler::toJson()
+{
+    QJsonArray scopes;
+    for (auto& stat: snapshot()) {
+        scopes.append(QJsonObject{
+            {"name", stat.name},
+            {"count", double(stat.count)},
+            {"total_ms", stat.totalMs},
+            {"p50_ms", stat.p50Ms},
+            {"p99_ms", stat.p99Ms},
+            {"max_ms", stat.maxMs},
+        });
+    }
+
+    return QJsonObject{
+        {"timestamp", QDateTime::currentDateTime().toString(Qt::ISODateWithMs)},
+        {"enabled", isEnabled()},
+        {"scopes", scopes},
+    };
+}
+
+bool Profiler::exportJson(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(QJsonDocument(toJson()).toJson()) != -1;
+}
+
+void Profiler::reset()
+{
+    auto& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+
+    // Racing with a recording thread can lose a sample, which is acceptable for a reset
+    for (auto& thread: reg.threads)
+        for (auto& histogram: thread->points) {
+            histogram.count.store(0, std::memory_order_relaxed);
+            histogram.totalNs.store(0, std::memory_order_relaxed);
+            histogram.maxNs.store(0, std::memory_order_relaxed);
+            for (auto& bucket: histogram.buckets)
+                bucket.store(0, std::memory_order_relaxed);
+        }
+}
+
+QJsonObject Profiler::traceJson()
+{
+    auto& reg = registry();
+    QJsonArray events;
+
+    QVector<QString> names, threadNames;
+    {
+        QMutexLocker locker(&reg.mutex);
+        names = reg.names;
+        threadNames = reg.threadNames;
+    }
+
+    for (int i = 0; i < threadNames.size(); i++) {
+        events.append(QJsonObject{
+            {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", i + 1},
+            {"args", QJsonObject{{"name", threadNames[i]}}},
+        });
+    }
+
+    auto buffer = reg.trace.load(std::memory_order_acquire);
+    if (buffer) {
+        quint64 last = buffer->next.load(std::memory_order_acquire);
+        quint64 capacity = buffer->slots.size();
+        quint64 first = last > capacity ? last - capacity : 0;
+
+        for (quint64 sequence = first + 1; sequence <= last; sequence++) {
+            auto& slot = buffer->slots[(sequence - 1) % capacity];
+            if (slot.sequence.load(std::memory_order_acquire) != sequence)
+                continue;
+            int point = slot.point.load(std::memory_order_relaxed);
+            int thread = slot.thread.load(std::memory_order_relaxed);
+            auto startNs = slot.startNs.load(std::memory_order_relaxed);
+            auto durationNs = slot.durationNs.load(std::memory_order_relaxed);
+            // Skip slots overwritten while they were being read
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence || point >= names.size())
+                continue;
+
+            events.append(QJsonObject{
+                {"name", names[point]}, {"cat", "vagyojaka"}, {"ph", "X"},
+                {"ts", startNs / 1e3}, {"dur", durationNs / 1e3},
+                {"pid", 1}, {"tid", thread},
+            });
+        }
+    }
+
+    return QJsonObject{
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"},
+    };
+}
+
+bool Profiler::exportTrace(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(QJsonDocument(traceJson()).toJson(QJsonDocument::Compact)) != -1;
+}
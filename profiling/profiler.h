@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+struct ProfileStat
+{
+    QString name;
+    quint64 count{0};
+    double totalMs{0};
+    double p50Ms{0};
+    double p99Ms{0};
+    double maxMs{0};
+};
+
+/**
+ * @class Profiler
+ * @brief Process-wide latency histograms and trace events for instrumented scopes.
+ *
+ * Every thread records into its own histograms without locks; snapshot()
+ * merges them. With tracing on, every scope also lands in a preallocated ring
+ * buffer that exportTrace() writes as Chrome/Perfetto trace JSON. While both
+ * are off an instrumented scope costs a single relaxed atomic load.
+ */
+class Profiler
+{
+public:
+    static constexpr int MaxPoints = 64;
+    static constexpr int BucketCount = 160; ///< Four buckets per power of two of nanoseconds.
+    static constexpr int DefaultTraceCapacity = 1 << 17;
+
+    enum Mode { Statistics = 1, Tracing = 2 };
+
+    static int modes() { return s_modes.load(std::memory_order_relaxed); }
+    static bool isEnabled() { return modes() & Statistics; }
+    static void setEnabled(bool enabled);
+    static bool isTracing() { return modes() & Tracing; }
+    /// Starts or stops tracing; the ring buffer is allocated on first use and kept.
+    static void setTracing(bool enabled, int capacity = DefaultTraceCapacity);
+
+    /// Registers a named scope once and returns its id, -1 if all points are taken.
+    static int registerPoint(const char* name);
+    static void record(int point, std::int64_t nanoseconds);
+    static void recordTrace(int point, std::chrono::steady_clock::time_point start, std::int64_t nanoseconds);
+
+    static QVector<ProfileStat> snapshot();
+    static QJsonObject toJson();
+    static bool exportJson(const QString& fileName);
+    static void reset();
+
+    /// The most recent trace events, oldest first, in the Chrome trace event format.
+    static QJsonObject traceJson();
+    static bool exportTrace(const QString& fileName);
+
+private:
+    static void setMode(Mode mode, bool enabled);
+
+    static std::atomic<int> s_modes;
+};
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(int point)
+        : m_point(point), m_modes(point >= 0 ? Profiler::modes() : 0)
+    {
+        if (m_modes)
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer()
+    {
+        if (!m_modes)
+            return;
+
+        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - m_start).count();
+        if (m_modes & Profiler::Statistics)
+            Profiler::record(m_point, nanoseconds);
+        if (m_modes & Profiler::Tracing)
+            Profiler::recordTrace(m_point, m_start, nanoseconds);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    int m_point;
+    int m_modes;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+/// Times the enclosing scope under the given name.
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profilePoint_, __LINE__) = Profiler::registerPoint(name); \
+    ScopedTimer PROFILE_CONCAT(profileTimer_, __LINE__)(PROFILE_CONCAT(profilePoint_, __LINE__))
@@ -0,0 +1,121 @@
+#include "profilerpanel.h"
+#include "profiler.h"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+#include <cmath>
+
+ProfilerPanel::ProfilerPanel(QWidget* parent)
+    : QWidget(parent),
+    m_enabled(new QCheckBox("Record", this)), m_tracing(new QCheckBox("Trace", this)), m_scopes(new QTreeWidget(this)), m_status(new QLabel(this))
+{
+    m_enabled->setChecked(Profiler::isEnabled());
+    m_tracing->setChecked(Profiler::isTracing());
+    m_tracing->setToolTip("Keep begin and end events of recent scopes for a Chrome/Perfetto trace");
+
+    auto resetButton = new QPushButton("Reset", this);
+    auto exportButton = new QPushButton("Export JSON...", this);
+    auto exportTraceButton = new QPushButton("Export Trace...", this);
+
+    m_scopes->setColumnCount(6);
+    m_scopes->setHeaderLabels({"Scope", "Calls", "p50 ms", "p99 ms", "Max ms", "Total ms"});
+    m_scopes->setRootIsDecorated(false);
+    m_scopes->setUniformRowHeights(true);
+    m_scopes->setSortingEnabled(true);
+    m_scopes->sortByColumn(5, Qt::DescendingOrder);
+    m_scopes->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    auto controls = new QHBoxLayout;
+    controls->addWidget(m_enabled);
+    controls->addWidget(m_tracing);
+    controls->addStretch();
+    controls->addWidget(resetButton);
+    controls->addWidget(exportButton);
+    controls->addWidget(exportTraceButton);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(controls);
+    layout->addWidget(m_scopes);
+    layout->addWidget(m_status);
+
+    m_refreshTimer.setInterval(1000);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &ProfilerPanel::refresh);
+
+    connect(m_enabled, &QCheckBox::toggled, this, [this](bool checked) {
+        Profiler::setEnabled(checked);
+        refresh();
+    });
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        Profiler::reset();
+        refresh();
+    });
+    connect(m_tracing, &QCheckBox::toggled, this, [](bool checked) { Profiler::setTracing(checked); });
+    connect(exportButton, &QPushButton::clicked, this, &ProfilerPanel::exportSnapshot);
+    connect(exportTraceButton, &QPushButton::clicked, this, &ProfilerPanel::exportTrace);
+}
+
+void ProfilerPanel::refresh()
+{
+    m_enabled->setChecked(Profiler::isEnabled());
+    m_tracing->setChecked(Profiler::isTracing());
+
+    auto stats = Profiler::snapshot();
+    m_scopes->setSortingEnabled(false);
+    m_scopes->clear();
+
+    // Numbers are stored as data rather than text, so the columns sort numerically
+    auto rounded = [](double value) { return std::round(value * 1000) / 1000; };
+    for (auto& stat: std::as_const(stats)) {
+        auto item = new QTreeWidgetItem(m_scopes);
+        item->setText(0, stat.name);
+        item->setData(1, Qt::DisplayRole, stat.count);
+        item->setData(2, Qt::DisplayRole, rounded(stat.p50Ms));
+        item->setData(3, Qt::DisplayRole, rounded(stat.p99Ms));
+        item->setData(4, Qt::DisplayRole, rounded(stat.maxMs));
+        item->setData(5, Qt::DisplayRole, rounded(stat.totalMs));
+    }
+
+    m_scopes->setSortingEnabled(true);
+    m_status->setText(Profiler::isEnabled() ? QString("%1 scopes").arg(stats.size()) : "Recording is off");
+}
+
+void ProfilerPanel::exportSnapshot()
+{
+    auto fileName = QFileDialog::getSaveFileName(this, "Export Performance Snapshot", "performance.json", "JSON Files (*.json)");
+    if (fileName.isEmpty())
+        return;
+
+    if (Profiler::exportJson(fileName))
+        emit message("Performance snapshot saved to " + fileName);
+    else
+        emit message("Couldn't write " + fileName);
+}
+
+void ProfilerPanel::exportTrace()
+{
+    auto fileName = QFileDialog::getSaveFileName(this, "Export Trace", "trace.json", "JSON Files (*.json)");
+    if (fileName.isEmpty())
+        return;
+
+    if (Profiler::exportTrace(fileName))
+        emit message("Trace saved to " + fileName + ", open it in chrome://tracing or ui.perfetto.dev");
+    else
+        emit message("Couldn't write " + fileName);
+}
+
+void ProfilerPanel::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    m_refreshTimer.start();
+}
+
+void ProfilerPanel::hideEvent(QHideEvent* event)
+{
+    m_refreshTimer.stop();
+    QWidget::hideEvent(event);
+}
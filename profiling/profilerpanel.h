@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QCheckBox>
+#include <QLabel>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QWidget>
+
+/**
+ * @class ProfilerPanel
+ * @brief Lists the latency of the instrumented scopes and exports snapshots.
+ *
+ * The list is refreshed once a second while the panel is visible.
+ */
+class ProfilerPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ProfilerPanel(QWidget* parent = nullptr);
+
+public slots:
+    void refresh();
+    void exportSnapshot();
+    void exportTrace();
+
+signals:
+    void message(const QString& text, int timeout = 5000);
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    QCheckBox* m_enabled;
+    QCheckBox* m_tracing;
+    QTreeWidget* m_scopes;
+    QLabel* m_status;
+    QTimer m_refreshTimer;
+};
@@ -1,8 +1,13 @@
 #include "tool.h"
+#include "profiling/profiler.h"
 #include "./ui_tool.h"
 #include "about.h"
 #include "audioplayer/audioplayerwidget.h"
+#include "editor/utilities/corpusstatisticsdialog.h"
 #include "editor/utilities/keyboardshortcutguide.h"
+#include "editor/utilities/searchpanel.h"
+#include "editor/utilities/transcriptexporter.h"
+#include "profiling/profilerpanel.h"
 #include "tts/ttsrow.h"
 #include <QProgressBar>
 
@@ -14,6 +19,8 @@
 
 #include <QMediaPlayer>
 #include <QActionGroup>
+#include <QDockWidget>
+#include <QMenu>
 
 #include <git/git.h>
 #include "qmediadevices.h"
@@ -174,6 +181,16 @@ Tool::Tool(QWidget *parent)
     ui->m_editor->setWordEditor(ui->m_wordEditor);
     connect(ui->Save_as_PDF,&QAction::triggered,ui->m_editor,&Editor::saveAsPDF);
     connect(ui->actionSave_as_Text,&QAction::triggered,ui->m_editor,&Editor::saveAsTXT);
+
+    auto exportMenu = new QMenu("Export As", ui->menuFile);
+    for (auto& format: TranscriptExporter::formats()) {
+        // Text has its own entry and XML is what Save writes
+        if (format == "txt" || format == "xml")
+            continue;
+        auto exportAction = exportMenu->addAction(TranscriptExporter::create(format)->description() + "...");
+        connect(exportAction, &QAction::triggered, ui->m_editor, [this, format]() { ui->m_editor->exportTranscript(format); });
+    }
+    ui->menuFile->addMenu(exportMenu);
     connect(ui->Real_Time_Data_Saver,&QAction::triggered,ui->m_editor,&Editor::realTimeDataSavingToggle);
     connect(ui->Add_Custom_Dictonary, &QAction::triggered, ui->m_editor, &Editor::addCustomDictonary);
 
@@ -261,6 +278,75 @@ Tool::Tool(QWidget *parent)
 
     connect(group, &QActionGroup::triggered, this, &Tool::transliterationSelected);
 
+    auto virtualizedViewAction = new QAction("Virtualized View", ui->menuEditor);
+    virtualizedViewAction->setCheckable(true);
+    virtualizedViewAction->setChecked(settings->value("virtualizedView").toString() == "true");
+    ui->menuEditor->addAction(virtualizedViewAction);
+    connect(virtualizedViewAction, &QAction::toggled, ui->m_editor, &Editor::setVirtualizedView);
+
+    auto corpusStatisticsAction = new QAction("Corpus Statistics...", ui->menuEditor);
+    ui->menuEditor->addAction(corpusStatisticsAction);
+    connect(corpusStatisticsAction, &QAction::triggered, this, [this]() {
+        auto dialog = new CorpusStatisticsDialog(this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        connect(dialog, &CorpusStatisticsDialog::customDictionaryRequested, ui->m_editor, &Editor::useCustomDictonary);
+        dialog->show();
+    });
+
+    ui->menuWaveform->addSeparator();
+    auto spectrogramAction = new QAction("Show Spectrogram", ui->menuWaveform);
+    spectrogramAction->setCheckable(true);
+    ui->menuWaveform->addAction(spectrogramAction);
+    connect(spectrogramAction, &QAction::toggled, this, [this](bool checked) {
+        settings->setValue("showSpectrogram", checked ? "true" : "false");
+        ui->widget->setSpectrogramVisible(checked);
+    });
+
+    auto frameSizeMenu = new QMenu("Spectrogram Frame Size", ui->menuWaveform);
+    auto frameSizeGroup = new QActionGroup(frameSizeMenu);
+    const int savedFrameSize = settings->value("spectrogramFrameSize", 1024).toInt();
+    for (int frameSize: {256, 512, 1024, 2048}) {
+        auto action = frameSizeMenu->addAction(QString::number(frameSize) + " samples");
+        action->setCheckable(true);
+        action->setChecked(frameSize == savedFrameSize);
+        action->setData(frameSize);
+        action->setActionGroup(frameSizeGroup);
+    }
+    ui->menuWaveform->addMenu(frameSizeMenu);
+    connect(frameSizeGroup, &QActionGroup::triggered, this, [this](QAction* action) {
+        settings->setValue("spectrogramFrameSize", action->data().toInt());
+        ui->widget->setSpectrogramFrameSize(action->data().toInt());
+    });
+    ui->widget->setSpectrogramFrameSize(savedFrameSize);
+    spectrogramAction->setChecked(settings->value("showSpectrogram").toString() == "true");
+
+    auto searchPanel = new SearchPanel(this);
+    auto searchDock = new QDockWidget("Search Transcript", this);
+    searchDock->setWidget(searchPanel);
+    searchDock->setHidden(true);
+    addDockWidget(Qt::RightDockWidgetArea, searchDock);
+
+    auto searchAction = new QAction("Search Transcript", ui->menuEdit);
+    searchAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F));
+    ui->menuEdit->addAction(searchAction);
+
+    connect(searchAction, &QAction::triggered, this, [searchDock, searchPanel]() {
+        searchDock->show();
+        searchPanel->focusQuery();
+    });
+    connect(searchPanel, &SearchPanel::queryChanged, this, [this, searchPanel](const WordQuery& query) {
+        searchPanel->showResults(ui->m_editor->searchWords(query), ui->m_editor->m_blocks);
+    });
+    connect(searchPanel, &SearchPanel::resultActivated, ui->m_editor, &Editor::jumpToWord);
+
+    auto profilerPanel = new ProfilerPanel(this);
+    auto profilerDock = new QDockWidget("Performance", this);
+    profilerDock->setWidget(profilerPanel);
+    profilerDock->setHidden(true);
+    addDockWidget(Qt::BottomDockWidgetArea, profilerDock);
+    ui->menuView->addAction(profilerDock->toggleViewAction());
+    connect(profilerPanel, &ProfilerPanel::message, this->statusBar(), &QStatusBar::showMessage);
+
 
     // Connect keyboard shortcuts guide to help action
     connect(ui->help_keyboardShortcuts, &QAction::triggered, this, &Tool::createKeyboardShortcutGuide);
@@ -330,6 +416,10 @@ void Tool::keyPressEvent(QKeyEvent *event)
         ui->m_editor->blockWiseJump("up");
     else if (event->key() == Qt::Key_Down && event->modifiers() == Qt::AltModifier)
         ui->m_editor->blockWiseJump("down");
+    else if (event->key() == Qt::Key_Left && event->modifiers() == (Qt::ControlModifier | Qt::AltModifier))
+        ui->m_editor->nudgeTime(-1);
+    else if (event->key() == Qt::Key_Right && event->modifiers() == (Qt::ControlModifier | Qt::AltModifier))
+        ui->m_editor->nudgeTime(1);
     else if (event->key() == Qt::Key_I && event->modifiers() == Qt::ControlModifier) {
         if (ui->m_editor->hasFocus())
             ui->m_editor->insertTimeStamp(player->elapsedTime());
@@ -588,7 +678,11 @@ void Tool::on_btn_translate_clicked()
 
     // qInfo()<<translatorStr.c_str(); // Disabled debug
 
-    int result2 = system(translatorStr.c_str());
+    int result2;
+    {
+        PROFILE_SCOPE("script: Translate.py");
+        result2 = system(translatorStr.c_str());
+    }
     // qInfo()<<result2; // Disabled debug
 
     // qInfo()<<"Save Pressed"; // Disabled debug
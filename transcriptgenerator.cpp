@@ -1,4 +1,5 @@
 #include "transcriptgenerator.h"
+#include "profiling/profiler.h"
 #include <QFileDialog>
 #include<QStandardPaths>
 #include<QDir>
@@ -70,7 +71,11 @@ void TranscriptGenerator::Upload_and_generate_Transcript()
         +" "
         +filepaths.replace(" ", "\\ ").toStdString()
         +"/transcript.xml";
-    int result = system(client.c_str());
+    int result;
+    {
+        PROFILE_SCOPE("script: client.py");
+        result = system(client.c_str());
+    }
     qInfo()<<result;
 
     bool fileExists = QFileInfo::exists(filepaths2+"/transcript.xml") && QFileInfo(filepaths2+"/transcript.xml").isFile();